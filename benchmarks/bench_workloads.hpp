@@ -0,0 +1,69 @@
+#ifndef B_PLUS_TREE_BENCH_WORKLOADS_HPP
+#define B_PLUS_TREE_BENCH_WORKLOADS_HPP
+
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+
+// Request distribution of YCSB: item ranks follow a Zipfian distribution, and ranks are scattered over the keys
+// so that the popular keys do not share pages.
+class ZipfianGenerator {
+    std::uint64_t items;
+    double theta;
+    double zeta_n;
+    double alpha;
+    double eta;
+
+public:
+
+    explicit ZipfianGenerator(std::uint64_t items, double theta = 0.99) : items(items), theta(theta) {
+        zeta_n = zeta(items);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - std::pow(2.0 / static_cast<double>(items), 1.0 - theta)) / (1.0 - zeta(2) / zeta_n);
+    }
+
+    auto zeta(std::uint64_t n) const -> double {
+        double sum = 0;
+        for (std::uint64_t i = 1; i <= n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        }
+        return sum;
+    }
+
+    template<typename Engine>
+    auto operator () (Engine &engine) const -> std::uint64_t {
+        double const u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+        double const uz = u * zeta_n;
+        std::uint64_t rank;
+        if (uz < 1.0) {
+            rank = 0;
+        } else if (uz < 1.0 + std::pow(0.5, theta)) {
+            rank = 1;
+        } else {
+            rank = static_cast<std::uint64_t>(static_cast<double>(items) * std::pow(eta * u - eta + 1.0, alpha));
+        }
+        // FNV-1a scatters the ranks over the key space
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (int byte = 0; byte < 8; ++byte) {
+            hash = (hash ^ ((rank >> (byte * 8)) & 0xff)) * 1099511628211ULL;
+        }
+        return hash % items;
+    }
+};
+
+
+// Nearest-rank percentile `p` of the sorted `values`, zero when there are none
+inline auto nearest_rank(const std::vector<double> &values, double p) -> double {
+    if (values.empty()) {
+        return 0.0;
+    }
+    auto const rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::min(std::max<std::size_t>(rank, 1), values.size()) - 1];
+}
+
+
+#endif //B_PLUS_TREE_BENCH_WORKLOADS_HPP
@@ -0,0 +1,316 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "bplustree.hpp"
+#include "bench_workloads.hpp"
+
+
+// Reproducible workloads over trees of several record sizes and data page capacities. Every operation is timed
+// on its own, and the pages moved between the buffer pool and the file are taken from its statistics.
+//
+//  usage: bplustree_bench [records] [operations] [buffer pool frames] [workload filter]
+
+
+// Records of `Size` bytes searched by their id
+template<std::size_t Size>
+struct BenchRecord {
+    std::int32_t id;
+    char payload[Size - sizeof(std::int32_t)];
+
+    BenchRecord() : id(-1), payload() {}
+
+    explicit BenchRecord(std::int32_t id) : id(id), payload() {
+        std::snprintf(payload, sizeof(payload), "%d", id);
+    }
+};
+
+
+struct BenchConfig {
+    std::size_t records;
+    std::size_t operations;
+    std::int32_t buffer_pool_capacity;
+    std::string filter;
+    std::uint64_t seed;
+};
+
+
+// Latencies of the operations of a workload along with the pages they moved
+class Measurement {
+    std::vector<double> latencies;
+    std::chrono::steady_clock::time_point start;
+    double total_seconds = 0;
+    BufferPoolStats before {};
+
+public:
+
+    template<typename Tree>
+    auto begin(Tree &tree, std::size_t operations) -> void {
+        latencies.clear();
+        latencies.reserve(operations);
+        total_seconds = 0;
+        tree.flush();
+        before = tree.buffer_pool_stats();
+    }
+
+    template<typename Procedure>
+    auto time(Procedure &&procedure) -> void {
+        auto const operation_start = std::chrono::steady_clock::now();
+        procedure();
+        std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - operation_start;
+        latencies.push_back(elapsed.count());
+        total_seconds += elapsed.count();
+    }
+
+    // Dirty pages are only written back when evicted or flushed, so the tree is flushed before reading them
+    template<typename Tree>
+    auto report(Tree &tree, const std::string &workload, std::size_t record_size,
+                std::int32_t data_page_capacity) -> void {
+        tree.flush();
+        BufferPoolStats const after = tree.buffer_pool_stats();
+        auto const operations = static_cast<double>(std::max<std::size_t>(latencies.size(), 1));
+        auto const reads = static_cast<double>((after.misses + after.prefetches) - (before.misses + before.prefetches));
+        auto const writes = static_cast<double>(after.write_backs - before.write_backs);
+
+        std::sort(latencies.begin(), latencies.end());
+        auto const percentile = [this](double p) {
+            return nearest_rank(latencies, p) * 1e6;
+        };
+
+        std::cout << std::left << std::setw(14) << workload << std::right
+                  << std::setw(8) << record_size
+                  << std::setw(10) << data_page_capacity
+                  << std::setw(10) << latencies.size()
+                  << std::setw(13) << std::fixed << std::setprecision(0) << operations / std::max(total_seconds, 1e-9)
+                  << std::setw(10) << std::setprecision(2) << percentile(0.50)
+                  << std::setw(10) << percentile(0.90)
+                  << std::setw(10) << percentile(0.99)
+                  << std::setw(10) << percentile(0.999)
+                  << std::setw(10) << std::setprecision(3) << reads / operations
+                  << std::setw(10) << writes / operations << "\n";
+    }
+};
+
+
+template<std::size_t Size>
+class WorkloadRunner {
+    using Record = BenchRecord<Size>;
+    using Tree = BPlusTree<std::int32_t, Record, std::greater<std::int32_t>, key_of<&Record::id>>;
+
+    const BenchConfig &config;
+    std::int32_t data_page_capacity;
+    std::string directory;
+    std::mt19937_64 engine;
+    Measurement measurement;
+
+    // ids currently stored in the tree, and the next id never used
+    std::vector<std::int32_t> live;
+    std::int32_t next_id = 0;
+
+    auto selected(const std::string &workload) const -> bool {
+        return config.filter.empty() || workload.find(config.filter) != std::string::npos;
+    }
+
+    auto make_tree() -> std::unique_ptr<Tree> {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        Property const property(directory, "metadata", "btree", get_expected_index_page_capacity<std::int32_t>(),
+                                data_page_capacity, true, config.buffer_pool_capacity, positionalStorage);
+        return std::make_unique<Tree>(property, key_of<&Record::id>{});
+    }
+
+    auto report(Tree &tree, const std::string &workload) -> void {
+        measurement.report(tree, workload, Size, data_page_capacity);
+    }
+
+    auto insert_workload(const std::string &workload, bool sequential) -> void {
+        auto tree = make_tree();
+        std::vector<std::int32_t> ids(config.records);
+        std::iota(ids.begin(), ids.end(), 0);
+        if (!sequential) {
+            std::shuffle(ids.begin(), ids.end(), engine);
+        }
+
+        measurement.begin(*tree, ids.size());
+        for (std::int32_t id: ids) {
+            Record record(id);
+            measurement.time([&] { tree->insert(record); });
+        }
+        report(*tree, workload);
+    }
+
+    auto point_lookups(Tree &tree) -> void {
+        std::uniform_int_distribution<std::size_t> pick(0, live.size() - 1);
+        measurement.begin(tree, config.operations);
+        for (std::size_t i = 0; i < config.operations; ++i) {
+            std::int32_t const id = live[pick(engine)];
+            measurement.time([&] { tree.search(id); });
+        }
+        report(tree, "point_lookup");
+    }
+
+    auto range_scans(Tree &tree, const std::string &workload, std::size_t length) -> void {
+        std::uniform_int_distribution<std::int32_t> pick(0, next_id - 1);
+        std::size_t const operations = std::max<std::size_t>(config.operations / length, 1);
+        measurement.begin(tree, operations);
+        for (std::size_t i = 0; i < operations; ++i) {
+            std::int32_t const lower_bound = pick(engine);
+            measurement.time([&] {
+                for (auto &record: tree.scan_above(lower_bound, length)) {
+                    (void) record;
+                }
+            });
+        }
+        report(tree, workload);
+    }
+
+    // YCSB-like mix over Zipfian keys. Updates replace the record, scans read up to 100 records and inserts
+    // add new ids.
+    auto mixed(Tree &tree, const std::string &workload, double read_ratio, bool scans) -> void {
+        ZipfianGenerator const zipfian(live.size());
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        std::uniform_int_distribution<std::size_t> scan_length(1, 100);
+        measurement.begin(tree, config.operations);
+        for (std::size_t i = 0; i < config.operations; ++i) {
+            std::int32_t const id = live[zipfian(engine) % live.size()];
+            if (coin(engine) < read_ratio) {
+                if (scans) {
+                    std::size_t const length = scan_length(engine);
+                    measurement.time([&] {
+                        for (auto &record: tree.scan_above(id, length)) {
+                            (void) record;
+                        }
+                    });
+                } else {
+                    measurement.time([&] { tree.search(id); });
+                }
+            } else if (scans) {
+                Record record(next_id++);
+                live.push_back(record.id);
+                measurement.time([&] { tree.insert(record); });
+            } else {
+                Record record(id);
+                measurement.time([&] {
+                    tree.remove(id);
+                    tree.insert(record);
+                });
+            }
+        }
+        report(tree, workload);
+    }
+
+    // Random deletes, each followed by the insertion of a new id, so the tree keeps its size
+    auto delete_churn(Tree &tree) -> void {
+        measurement.begin(tree, config.operations);
+        for (std::size_t i = 0; i < config.operations; ++i) {
+            std::size_t const victim = std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(engine);
+            std::int32_t const id = live[victim];
+            live[victim] = next_id;
+            Record record(next_id++);
+            measurement.time([&] {
+                tree.remove(id);
+                tree.insert(record);
+            });
+        }
+        report(tree, "delete_churn");
+    }
+
+public:
+
+    WorkloadRunner(const BenchConfig &config, std::int32_t data_page_capacity)
+            : config(config), data_page_capacity(data_page_capacity),
+              directory("./bench/r" + std::to_string(Size) + "_c" + std::to_string(data_page_capacity) + "/"),
+              engine(config.seed) {}
+
+    auto run() -> void {
+        if (selected("seq_insert")) {
+            insert_workload("seq_insert", true);
+        }
+        if (selected("random_insert")) {
+            insert_workload("random_insert", false);
+        }
+
+        // the remaining workloads share a tree bulk loaded with every other id, so that inserts land in between
+        std::vector<Record> records;
+        for (std::size_t i = 0; i < config.records; ++i) {
+            records.emplace_back(static_cast<std::int32_t>(2 * i));
+        }
+        live.clear();
+        for (const Record &record: records) {
+            live.push_back(record.id);
+        }
+        next_id = static_cast<std::int32_t>(2 * config.records);
+
+        auto tree = make_tree();
+        tree->bulk_load(records.begin(), records.end());
+
+        if (selected("point_lookup")) {
+            point_lookups(*tree);
+        }
+        if (selected("short_scan")) {
+            range_scans(*tree, "short_scan", 10);
+        }
+        if (selected("long_scan")) {
+            range_scans(*tree, "long_scan", 1000);
+        }
+        if (selected("ycsb_b")) {
+            mixed(*tree, "ycsb_b", 0.95, false);
+        }
+        if (selected("ycsb_a")) {
+            mixed(*tree, "ycsb_a", 0.50, false);
+        }
+        if (selected("ycsb_e")) {
+            mixed(*tree, "ycsb_e", 0.95, true);
+        }
+        if (selected("delete_churn")) {
+            delete_churn(*tree);
+        }
+
+        tree.reset();
+        std::filesystem::remove_all(directory);
+    }
+};
+
+
+template<std::size_t Size>
+auto run_record_size(const BenchConfig &config) -> void {
+    // full pages and pages of a quarter of their capacity, which makes the trees deeper
+    std::int32_t const full_capacity = get_expected_data_page_capacity<BenchRecord<Size>>();
+    for (std::int32_t const capacity: { full_capacity, std::max(full_capacity / 4, 4) }) {
+        WorkloadRunner<Size>(config, capacity).run();
+    }
+}
+
+
+auto main(int argc, char* argv[]) -> int {
+    BenchConfig config {
+        (argc > 1) ? static_cast<std::size_t>(std::atoll(argv[1])) : 100000,
+        (argc > 2) ? static_cast<std::size_t>(std::atoll(argv[2])) : 50000,
+        (argc > 3) ? std::atoi(argv[3]) : DEFAULT_BUFFER_POOL_CAPACITY,
+        (argc > 4) ? argv[4] : "",
+        42
+    };
+
+    std::cout << config.records << " records, " << config.operations << " operations, "
+              << config.buffer_pool_capacity << " buffer pool frames, latencies in us\n";
+    std::cout << std::left << std::setw(14) << "workload" << std::right
+              << std::setw(8) << "record" << std::setw(10) << "capacity" << std::setw(10) << "ops"
+              << std::setw(13) << "ops/s" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+              << std::setw(10) << "reads/op" << std::setw(10) << "writes/op" << "\n";
+
+    run_record_size<16>(config);
+    run_record_size<64>(config);
+    run_record_size<256>(config);
+
+    return EXIT_SUCCESS;
+}
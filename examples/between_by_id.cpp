@@ -37,20 +37,23 @@ auto main(int argc, char* argv[]) -> int {
             unique_key
     );
 
-    const std::function<std::int32_t(Record&)> index_by_id = [](Record& record) -> std::int32_t {
-        return record.id;
-    };
-
-    BPlusTree<std::int32_t, Record> btree(props, index_by_id);
+    BPlusTree btree(props, key_of<&Record::id>{});
     const Clock clock;
 
     std::vector<Record> recovered;
-    clock([&]() {
+    const double elapsed_ms = clock([&]() {
         recovered = btree.between(lower_bound, upper_bound);
         }, std::cout);
 
     std::cout << recovered.size() << " rows recovered" << "\n";
 
+    // scan throughput, the leaves read ahead of the scan are reported by the buffer pool
+    const double elapsed_s = std::max(elapsed_ms, 1e-3) / 1000;
+    const BufferPoolStats stats = btree.buffer_pool_stats();
+    std::cout << "[ Scan throughput: " << static_cast<double>(recovered.size()) / elapsed_s << " rows/s, "
+              << static_cast<double>(recovered.size() * sizeof(Record)) / elapsed_s / (1 << 20) << " MiB/s, "
+              << stats.misses << " page reads, " << stats.prefetches << " prefetched ] \n";
+
     for (const Record& record: recovered) {
         std::cout << record << "\n";
     }
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <algorithm>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+#include "time_utils.hpp"
+
+
+auto main(int argc, char* argv[]) -> int {
+    if (argc < 2) {
+        return EXIT_FAILURE;
+    }
+
+    const std::string& dataset_file_name = argv[1];
+    const double fill_factor = (argc < 3) ? DEFAULT_FILL_FACTOR : atof(argv[2]);
+    const std::string& directory_path = "./index/index_by_id/";
+    const std::string& metadata_file_name = "metadata";
+    const std::string& index_file_name = "btree";
+
+    const int index_page_capacity = get_expected_index_page_capacity<std::int32_t>();
+    const int data_page_capacity = get_expected_data_page_capacity<Record>();
+
+    const bool unique_key = true;
+
+    const Property props(
+            directory_path,
+            metadata_file_name,
+            index_file_name,
+            index_page_capacity,
+            data_page_capacity,
+            unique_key
+    );
+
+    BPlusTree btree(props, key_of<&Record::id>{});
+
+    std::fstream file(dataset_file_name, std::ios::in);
+    std::int32_t record_age {};
+    std::int32_t record_id {};
+    std::string record_name;
+
+    std::vector<Record> records;
+    while (file >> record_id >> record_name >> record_age) {
+        records.emplace_back(record_id, record_name, record_age);
+    }
+    file.close();
+
+    // the dump is not required to be sorted, bulk loading is
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.id < b.id;
+    });
+
+    const Clock clock;
+    clock([&]() {
+        btree.bulk_load(records.begin(), records.end(), fill_factor);
+    }, std::cout);
+
+    std::cout << records.size() << " rows loaded" << "\n";
+    return EXIT_SUCCESS;
+}
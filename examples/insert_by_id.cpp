@@ -33,25 +33,24 @@ auto main(int argc, char* argv[]) -> int {
             unique_key
     );
 
-    const std::function<std::int32_t(Record&)> index_by_id = [](Record& record) -> std::int32_t {
-        return record.id;
-    };
-
-    BPlusTree<std::int32_t, Record> btree(props, index_by_id);
+    BPlusTree btree(props, key_of<&Record::id>{});
 
     std::fstream file(dataset_file_name, std::ios::in);
     std::int32_t record_age {};
     std::int32_t record_id {};
     std::string record_name;
 
+    std::vector<Record> records;
+    while (file >> record_id >> record_name >> record_age) {
+        records.emplace_back(record_id, record_name, record_age);
+    }
+    file.close();
+
     const Clock clock;
     clock([&]() {
-        while (file >> record_id >> record_name >> record_age) {
-            Record record(record_id, record_name, record_age);
-            btree.insert(record);
-        }
+        btree.insert_many(records.begin(), records.end());
     }, std::cout);
 
-    file.close();
+    std::cout << records.size() << " rows inserted" << "\n";
     return EXIT_SUCCESS;
 }
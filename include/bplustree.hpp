@@ -9,9 +9,41 @@
 #include <vector>
 #include <functional>
 #include <queue>
+#include <array>
+#include <optional>
+#include <filesystem>
+#include <shared_mutex>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <numeric>
+#include <type_traits>
+#include <random>
+#include <iostream>
 
 #include "data_page.hpp"
 #include "index_page.hpp"
+#include "buffer_pool.hpp"
+#include "bulk_loader.hpp"
+#include "cursor.hpp"
+#include "write_ahead_log.hpp"
+#include "pinned_index.hpp"
+#include "key_extractor.hpp"
+
+
+// Suffix of the index and metadata files of the tree built by compact()
+const std::string COMPACT_FILE_EXTENSION = ".compact";
+
+// Number of latches shared by the data pages, pages are mapped to them by their position
+constexpr std::size_t PAGE_LATCH_STRIPES = 64;
+
+// Type in which sum_between accumulates values of type T, integers are widened so that sums of many small
+// values do not overflow
+template<typename T>
+using aggregate_sum_t = std::conditional_t<
+        std::is_integral_v<T> && !std::is_same_v<T, bool>,
+        std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>,
+        std::conditional_t<std::is_floating_point_v<T>, double, T>>;
 
 
 template <
@@ -20,46 +52,294 @@ template <
     typename Compare = std::greater<FieldType>,
     typename FieldMapping = std::function<FieldType(RecordType&)>
 > class BPlusTree {
+    // The tree may be used from several threads. Index pages and the metadata are only modified while
+    // `tree_latch` is held in exclusive mode, so they can be read freely under the shared mode. Writers first
+    // descend under the shared mode and, when the change fits in a single leaf (no split, no merge, no separator
+    // to update), apply it under the exclusive latch of that leaf. Otherwise they retry under the exclusive mode.
+    // Readers hold the shared latch of each leaf while loading it. Trees keeping subtree counts update the index
+    // pages on every change, so their writers always take the exclusive mode.
 
     friend struct Page<TYPES()>;
     friend struct DataPage<TYPES()>;
     friend struct IndexPage<TYPES()>;
+    friend struct BulkLoader<TYPES()>;
+    friend class Cursor<TYPES()>;
+    friend class PinnedIndex<TYPES()>;
+    friend class TreeAnalyzer<TYPES()>;
+
+    static_assert(KeyExtractor<FieldMapping, RecordType, FieldType>,
+                  "the search field must be computable from a record");
 
 private:
 
-    std::fstream b_plus_index_file;
     std::fstream metadata_file;
+    std::unique_ptr<Storage> storage;
 
     Property properties;
+    BufferPool buffer_pool;
+    TreeStatistics statistics;
     Compare gt;
     FieldMapping get_search_field;
 
+    // Metadata fields modified by the tree operations, as they were last written to the metadata file
+    std::array<std::int64_t, 4> persisted_state;
+
+    // Incremented on every page write, open cursors compare it to notice that the tree changed under them
+    std::atomic<std::uint64_t> version = 0;
+
+    // Redo log of the operations, only kept by durable trees
+    std::unique_ptr<WriteAheadLog> log;
+
+    // Resident index levels, only used when the tree is configured to pin them
+    PinnedIndex<TYPES()> pinned_index;
+
+    std::shared_mutex tree_latch;
+    std::array<std::shared_mutex, PAGE_LATCH_STRIPES> page_latches;
+
+    // Periodic dump of the statistics, only running once requested
+    StatsReporter stats_reporter;
+
+    auto page_latch(std::streampos pos) -> std::shared_mutex&;
+
+    // Search field of a record, FieldMapping may be any callable or a pointer to a data member
+    auto extract_key(RecordType &record) -> FieldType;
+
+    auto uses_pinned_index() const -> bool;
+
+    // Applies the change to the leaf holding `key` when it does not affect any other page, under the shared
+    // tree latch. Returns whether it did. The page is appended to the log of `operation` before the leaf latch is
+    // released, so concurrent writers of a leaf log its images in the order they wrote them.
+    auto insert_in_leaf(RecordType &record, LoggedOperation &operation) -> bool;
+
+    auto remove_from_leaf(const FieldType &key, LoggedOperation &operation) -> bool;
+
     auto create_index() -> void;
 
-    auto locate_data_page(const FieldType &key) -> std::streampos;
+    auto metadata_state() const -> std::array<std::int64_t, 4>;
+
+    // Puts back metadata fields taken by metadata_state(), e.g. after an operation that failed halfway
+    auto restore_metadata(const LoggedMetadata &state) -> void;
+
+    auto save_metadata(bool force = false) -> void;
+
+    // Replaces the file at `path` with the metadata at once, so it is never read torn
+    auto replace_metadata(const std::string &path) -> void;
+
+    // Completes a compaction interrupted once the metadata of the new tree was in place, or drops its files
+    auto finish_compaction() -> void;
+
+    // Opens the index file with the configured backend
+    auto open_storage() -> std::unique_ptr<Storage>;
+
+    // Makes the index and metadata files durable, then empties the log. Requires the exclusive tree latch.
+    auto checkpoint() -> void;
+
+    auto checkpoint_if_needed() -> void;
+
+    // Pages a single insert or remove may write: a split or merge on every level, a new root and the pages
+    // taken from or given back to the free lists. Logged operations keep them pinned until they commit.
+    auto change_pages() -> std::size_t;
+
+    // Records whose search field equals `key`, under the tree latch already held by the caller
+    auto count_key(const FieldType &key) -> std::size_t;
+
+    // Data page where the records with `key` start, or where they end when `last` is set
+    auto locate_data_page(const FieldType &key, bool last = false) -> std::streampos;
+
+    // Data page where `key` is inserted, along with the greatest key routed to it if it is not the last one
+    auto locate_leaf_range(const FieldType &key) -> std::pair<std::streampos, std::optional<FieldType>>;
+
+    auto first_data_page() -> std::streampos;
+
+    // Reads the pages at `positions` together so that their I/O overlaps, `page` tells their type
+    auto fetch_pages(const std::vector<std::int64_t> &positions, Page<TYPES()> &page) -> void;
+
+    // Resolves the sorted probes `order[first, last)` in the subtree of the index page at `seek_page`
+    auto search_subtree(std::streampos seek_page,
+                        const std::vector<FieldType> &keys,
+                        const std::vector<std::size_t> &order,
+                        std::size_t first,
+                        std::size_t last,
+                        std::vector<std::vector<RecordType>> &located_records) -> void;
+
+    auto search_leaf(std::streampos seek_page,
+                     const std::vector<FieldType> &keys,
+                     const std::vector<std::size_t> &order,
+                     std::size_t first,
+                     std::size_t last,
+                     std::vector<std::vector<RecordType>> &located_records) -> void;
+
+    auto last_data_page() -> std::streampos;
+
+    // Structural counterparts of insert_in_leaf and remove_from_leaf, under the exclusive tree latch
+    auto insert_from_root(RecordType &record) -> void;
+
+    auto remove_from_root(const FieldType &key) -> void;
 
     auto insert(std::streampos seek_page, PageType type, RecordType &record) -> InsertResult;
 
     auto remove(std::streampos seek_page, PageType type, const FieldType &key) -> RemoveResult<FieldType>;
 
+    // Hands `visit` each leaf along with the positions of its records with keys in [lower_bound, upper_bound]
+    template<typename Visitor>
+    auto for_each_run(const FieldType &lower_bound, const FieldType &upper_bound, Visitor &&visit) -> void;
+
+    template<typename Projection>
+    using projected_t = std::remove_cvref_t<std::invoke_result_t<Projection&, RecordType&>>;
+
+    auto require_counts() const -> void;
+
+    // Adds `delta` to the counts on the path to the leaf where `key` is inserted, after changing that leaf in place
+    auto adjust_counts(const FieldType &key, std::int64_t delta) -> void;
+
+    auto record_count() -> std::size_t;
+
+    // Records with keys less than `key`, or not greater than it when `inclusive` is set
+    auto count_before(const FieldType &key, bool inclusive) -> std::size_t;
+
+    // Data page holding the record at `rank`, which must exist. `rank` is made relative to the page.
+    auto locate_rank(std::int64_t &rank) -> std::streampos;
+
+    // Records at `count` ranks drawn uniformly from [first, last), in key order
+    template<typename Generator>
+    auto sample_ranks(std::size_t first, std::size_t last, std::size_t count,
+                      Generator &generator) -> std::vector<RecordType>;
+
 public:
 
     explicit BPlusTree(Property property, FieldMapping search_field, Compare greater = Compare());
 
+    ~BPlusTree();
+
+    // Writes back every dirty page and the metadata file. Durable trees also sync them and empty their log.
+    auto flush() -> void;
+
     auto insert(RecordType &record) -> void;
 
     auto remove(const FieldType &key) -> void;
 
+    // Batched counterparts of insert and remove. The batch is sorted by the search field, then the records of
+    // each leaf are applied to it in memory and the leaf is written once. Only the records reaching a full leaf,
+    // or leaving one below its minimum, go through the regular insert and remove. Durable trees log long batches
+    // as several operations, so a crash may keep only part of a batch.
+    // Every record is checked before the tree is changed: an entry too large for a page throws EntryTooLarge and
+    // inserts none of the batch.
+    template<typename Iterator>
+    auto insert_many(Iterator first, Iterator last) -> void;
+
+    // Removes every key of the batch or none of them: when a key is missing, or repeated more times than the tree
+    // holds it, KeyNotFound is thrown before the tree is changed. Each occurrence of a key removes one record.
+    template<typename Iterator>
+    auto remove_many(Iterator first, Iterator last) -> void;
+
+    // Builds the tree bottom-up from records sorted by the search field. Pages are filled up to `fill_factor`
+    // of their capacity and written in key order, into released pages first. The tree must be empty.
+    template<typename Iterator>
+    auto bulk_load(Iterator first, Iterator last, double fill_factor = DEFAULT_FILL_FACTOR) -> void;
+
+    // Rewrites the whole tree densely in key order into a new file, dropping every released page
+    auto compact(double fill_factor = DEFAULT_FILL_FACTOR) -> void;
+
     auto search(const FieldType &key) -> std::vector<RecordType>;
 
+    // Batched counterpart of search, the records of `keys[i]` are returned at position i. The probes are sorted
+    // and the tree is descended once, splitting them among the children of each index page, so every page on
+    // the way is read once for the whole batch.
+    auto search_many(const std::vector<FieldType> &keys) -> std::vector<std::vector<RecordType>>;
+
     auto above(const FieldType &lower_bound) -> std::vector<RecordType>;
 
     auto below(const FieldType &upper_bound) -> std::vector<RecordType>;
 
     auto between(const FieldType &lower_bound, const FieldType &upper_bound) -> std::vector<RecordType>;
+
+    // Lazy counterparts of the range searches, they load a single data page at a time and stop after `limit`
+    // records. The whole tree is scanned when no bound is given.
+    auto scan_above(const FieldType &lower_bound, std::size_t limit = NO_LIMIT) -> Cursor<TYPES()>;
+
+    auto scan_below(const FieldType &upper_bound, std::size_t limit = NO_LIMIT) -> Cursor<TYPES()>;
+
+    auto scan_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                      std::size_t limit = NO_LIMIT) -> Cursor<TYPES()>;
+
+    auto scan(ScanDirection direction = forwardScan, std::size_t limit = NO_LIMIT) -> Cursor<TYPES()>;
+
+    // Aggregates over the records with keys in [lower_bound, upper_bound]. They are computed on each loaded leaf,
+    // a whole run of records at a time, and never copy the records out of it. Trees keeping subtree counts count
+    // the records with two descents instead.
+    auto count_between(const FieldType &lower_bound, const FieldType &upper_bound) -> std::size_t;
+
+    // Sum of `projection` over the records, it may be any callable or a pointer to a data member
+    template<typename Projection>
+    auto sum_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                     Projection projection) -> aggregate_sum_t<projected_t<Projection>>;
+
+    // Records with the least and the greatest key of the range, only the leaves at its ends are read
+    auto min_between(const FieldType &lower_bound, const FieldType &upper_bound) -> std::optional<RecordType>;
+
+    auto max_between(const FieldType &lower_bound, const FieldType &upper_bound) -> std::optional<RecordType>;
+
+    // Least and greatest values of `projection` over the records
+    template<typename Projection>
+    auto min_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                     Projection projection) -> std::optional<projected_t<Projection>>;
+
+    template<typename Projection>
+    auto max_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                     Projection projection) -> std::optional<projected_t<Projection>>;
+
+    // Order statistics, answered by a single descent through the subtree counts. They require a tree keeping
+    // them, see Property::SUBTREE_COUNTS, and throw UncountedTree otherwise.
+    auto size() -> std::size_t;
+
+    // Records with keys less than `key`, i.e. the position in key order of the first record with `key`
+    auto rank(const FieldType &key) -> std::size_t;
+
+    // Record at position `rank` in key order, if there are that many records
+    auto select(std::size_t rank) -> std::optional<RecordType>;
+
+    // Lazy scan from the record at position `offset` in key order, e.g. a page of results without reading the
+    // records before it
+    auto scan_from(std::size_t offset, std::size_t limit = NO_LIMIT) -> Cursor<TYPES()>;
+
+    // `count` records drawn uniformly at random with replacement, returned in key order
+    template<typename Generator>
+    auto sample(std::size_t count, Generator &generator) -> std::vector<RecordType>;
+
+    template<typename Generator>
+    auto sample_between(const FieldType &lower_bound, const FieldType &upper_bound, std::size_t count,
+                        Generator &generator) -> std::vector<RecordType>;
+
+    auto buffer_pool_stats() const -> BufferPoolStats;
+
+    // Counters and latencies recorded since the tree was opened, along with its height and the size of its file.
+    // Surveying the pages also measures how full they are, which reads the whole tree.
+    auto stats(bool survey_pages = false) -> TreeStats;
+
+    // Writes the statistics to `out` every `period`, until stopped or the tree is destroyed
+    auto dump_stats(std::chrono::milliseconds period, std::ostream &out = std::clog) -> void;
+
+    auto stop_stats_dump() -> void;
 };
 
 
+// The key and record types are deduced from extractors taking a single record, e.g. &Record::id or
+// key_of<&Record::id>{}
+template<typename Extractor>
+BPlusTree(Property, Extractor) -> BPlusTree<
+        typename extractor_traits<Extractor>::field_type,
+        typename extractor_traits<Extractor>::record_type,
+        std::greater<typename extractor_traits<Extractor>::field_type>,
+        Extractor>;
+
+template<typename Extractor, typename Compare>
+BPlusTree(Property, Extractor, Compare) -> BPlusTree<
+        typename extractor_traits<Extractor>::field_type,
+        typename extractor_traits<Extractor>::record_type,
+        Compare,
+        Extractor>;
+
+
 #include "bplustree.tpp"
 
 #endif //B_PLUS_TREE_BPLUSTREE_HPP
@@ -0,0 +1,140 @@
+#ifndef B_PLUS_TREE_BUFFER_POOL_HPP
+#define B_PLUS_TREE_BUFFER_POOL_HPP
+
+
+#include <new>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "storage.hpp"
+
+
+constexpr std::int32_t DEFAULT_BUFFER_POOL_CAPACITY = 256;
+
+// Frames start at a block boundary, as required for direct I/O
+constexpr std::size_t FRAME_ALIGNMENT = 4096;
+
+// Dirty frames written back along with an evicted one, pages modified together (e.g. by a split) usually
+// leave the pool in the same batch
+constexpr std::size_t WRITE_BACK_BATCH = 16;
+
+
+template<typename T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameAllocator() = default;
+
+    template<typename U>
+    explicit FrameAllocator(const FrameAllocator<U> &) {}
+
+    auto allocate(std::size_t n) -> T* {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(FRAME_ALIGNMENT)));
+    }
+
+    auto deallocate(T *pointer, std::size_t) -> void {
+        ::operator delete(pointer, std::align_val_t(FRAME_ALIGNMENT));
+    }
+
+    friend auto operator == (const FrameAllocator &, const FrameAllocator &) -> bool {
+        return true;
+    }
+};
+
+
+struct BufferPoolStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+    std::uint64_t write_backs;
+    std::uint64_t prefetches;
+};
+
+
+// Fixed-size cache of file pages keyed by their offset. Frames are replaced following the CLOCK (second chance)
+// policy and dirty frames are written back to the file only when evicted or flushed, in batches handed to the
+// storage at once. The pool may be shared by several threads: its bookkeeping is guarded by a single latch, which
+// is released while a missing page is read so that other threads keep hitting the pool meanwhile. Callers are
+// responsible for not modifying a frame while another thread reads it.
+class BufferPool {
+
+    struct Frame {
+        std::int64_t pos;
+        std::vector<char, FrameAllocator<char>> data;
+        std::int32_t pin_count;
+        bool dirty;
+        bool referenced;
+        bool loading;
+    };
+
+    Storage *storage;
+    std::vector<Frame> frames;
+    std::unordered_map<std::int64_t, std::size_t> page_table;
+    std::size_t capacity;
+    std::size_t clock_hand;
+    std::int64_t end_of_file;
+    BufferPoolStats statistics;
+
+    mutable std::mutex latch;
+    std::condition_variable loaded;
+
+    // Claims a frame for the page at `pos`, the frame is returned pinned. Requires the latch.
+    auto claim(std::int64_t pos, std::size_t size, bool loading) -> Frame&;
+
+    // Marks the frame as loaded, waking up the threads waiting for it. Requires the latch.
+    auto finish_loading(Frame &frame) -> void;
+
+    auto victim() -> std::size_t;
+
+    auto fetch(Frame &frame) -> void;
+
+    auto write_back(Frame &frame) -> void;
+
+    // Writes the frames back in file order with a single storage batch
+    auto write_back(std::vector<Frame*> &dirty_frames) -> void;
+
+    // Writes back the dirty unpinned frames that follow `first` in the clock, `first` included
+    auto write_behind(std::size_t first) -> void;
+
+    // Writes every dirty frame back. Requires the latch.
+    auto write_back_dirty() -> void;
+
+    auto file_end() -> std::int64_t;
+
+public:
+
+    explicit BufferPool(std::size_t capacity = DEFAULT_BUFFER_POOL_CAPACITY);
+
+    // Binds the pool to the storage it caches, the frames of the previous one are written back and dropped
+    auto attach(Storage *new_storage) -> void;
+
+    // Returns the frame holding the `size` bytes stored at `pos`, reading them from the file only when
+    // `load` is set. The frame stays resident until it is unpinned. Throws FrameInUse if the page is pinned
+    // with a different size.
+    auto pin(std::int64_t pos, std::size_t size, bool load = true) -> char*;
+
+    auto unpin(std::int64_t pos, bool dirty) -> void;
+
+    // Asks the storage to read ahead the page at `pos`, unless it is already resident in the pool
+    auto prefetch(std::int64_t pos, std::size_t size) -> void;
+
+    // Brings the pages stored at `positions` into the pool with a single storage batch, without pinning them.
+    // A batch takes at most half of the frames.
+    auto fetch_batch(const std::vector<std::int64_t> &positions, std::size_t size) -> void;
+
+    // Reserves `size` bytes at the end of the file for a new page
+    auto allocate(std::size_t size) -> std::int64_t;
+
+    auto flush() -> void;
+
+    // Writes the dirty frames back, then drops every frame. No frame may be pinned.
+    auto clear() -> void;
+
+    [[nodiscard]] auto stats() const -> BufferPoolStats;
+};
+
+
+#endif //B_PLUS_TREE_BUFFER_POOL_HPP
@@ -0,0 +1,72 @@
+#ifndef B_PLUS_TREE_BULK_LOADER_HPP
+#define B_PLUS_TREE_BULK_LOADER_HPP
+
+
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "data_page.hpp"
+#include "index_page.hpp"
+
+
+constexpr double DEFAULT_FILL_FACTOR = 1.0;
+
+
+// Builds a tree bottom-up from records received in key order. Leaves are filled up to the fill factor and
+// written one after the other, taking released pages before growing the file, then the index levels are built
+// from the greatest key of each child.
+template<TYPES(typename)>
+struct BulkLoader {
+
+    BPlusTree<TYPES()> *tree;
+    std::size_t leaf_target;
+    std::size_t children_target;
+
+    // Fill targets in bytes of the slotted and compressed layouts
+    std::int32_t leaf_bytes_target;
+    std::int32_t index_bytes_target;
+
+    // Offsets and greatest keys of the pages of the level being built
+    std::vector<std::pair<std::int64_t, FieldType>> level;
+    // Records under each page of `level`, stored by the parents when the tree keeps subtree counts
+    std::vector<std::int64_t> level_counts;
+
+    // A complete leaf is only written once its successor is known, so that the last two leaves can be
+    // rebalanced when the input runs out.
+    DataPage<TYPES()> previous;
+    DataPage<TYPES()> current;
+    std::int64_t previous_seek;
+    // Bytes taken by the records of `current`, kept as they are pushed
+    std::int32_t current_bytes;
+    std::optional<FieldType> last_key;
+
+    explicit BulkLoader(BPlusTree<TYPES()> *tree, double fill_factor = DEFAULT_FILL_FACTOR);
+
+    auto push(RecordType &record) -> void;
+
+    // Writes the pending leaves and the index levels, then points the tree to the new root
+    auto finish() -> void;
+
+    // The separator after the leaf is truncated against `next_key`, the first key of the following leaf
+    auto write_leaf(DataPage<TYPES()> &leaf, std::int64_t seek_leaf, const FieldType *next_key) -> void;
+
+    // Whether the leaf being filled reached its target, so that `record` starts the next one
+    auto leaf_complete(const RecordType &record) -> bool;
+
+    auto build_index_levels() -> void;
+
+    // Splits `items` entries in groups of about `target` entries, none of them smaller than `minimum`
+    static auto distribute(std::size_t items, std::size_t target, std::size_t minimum) -> std::vector<std::size_t>;
+
+    // Splits the pages of `level` in groups of children whose index page reaches the fill target in bytes
+    auto group_by_size() -> std::vector<std::size_t>;
+
+    static auto fill_target(std::int32_t max_capacity, std::int32_t min_capacity, double fill_factor) -> std::size_t;
+};
+
+
+#include "bulk_loader.tpp"
+
+#endif //B_PLUS_TREE_BULK_LOADER_HPP
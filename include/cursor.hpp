@@ -0,0 +1,140 @@
+#ifndef B_PLUS_TREE_CURSOR_HPP
+#define B_PLUS_TREE_CURSOR_HPP
+
+
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include <optional>
+#include <shared_mutex>
+
+#include "data_page.hpp"
+#include "index_page.hpp"
+
+
+// Direction in which a cursor walks the leaf chain
+enum ScanDirection {
+    forwardScan  = 0,  // ascending keys, through next_leaf
+    backwardScan = 1   // descending keys, through prev_leaf
+};
+
+
+constexpr std::size_t NO_LIMIT = std::numeric_limits<std::size_t>::max();
+
+// Leaves a cursor has to step through before it starts reading ahead, so that short scans never pay for it
+constexpr std::int32_t READ_AHEAD_TRIGGER = 2;
+
+// Leaves requested ahead of the one being scanned
+constexpr std::size_t READ_AHEAD_PAGES = 8;
+
+
+// Lazy range scan over the leaf chain. Only the current data page is kept in memory and the next one is loaded
+// when the records of the current page run out. A cursor must not outlive its tree.
+//
+// The tree may be modified while a cursor is open, by the thread owning it as well. Latches are only held while
+// the cursor steps: the tree latch in shared mode, plus the latch of a leaf while it is loaded. When the tree
+// changed since the last step, the next one locates the scan again after the last record returned, so the records
+// inserted ahead of the cursor are visited and the removed ones are not. Records with the same key are told apart
+// by how many of them were already returned.
+//
+// Once the scan proves to be sequential, the positions of the following leaves are taken from their parent
+// index page and up to READ_AHEAD_PAGES of them are prefetched, so that they are already being read while the
+// current one is consumed.
+template<TYPES(typename)>
+class Cursor {
+
+    BPlusTree<TYPES()> *tree;
+    DataPage<TYPES()> page;
+    std::int64_t seek_page;
+    std::int32_t position;
+    ScanDirection direction;
+    std::optional<FieldType> lower_bound;
+    std::optional<FieldType> upper_bound;
+    std::size_t remaining;
+
+    // Leaves after the current one in scan order, as listed by their parent
+    std::vector<std::int64_t> upcoming;
+    std::size_t next_upcoming;
+    std::size_t prefetched;
+    std::int32_t sequential_steps;
+
+    // Version of the tree when the cursor last checked it, under the shared tree latch
+    std::uint64_t version;
+
+    // Key of the last record returned, and how many records with that key were returned
+    std::optional<FieldType> last_key;
+    std::size_t last_key_count;
+
+    // Loads the leaf at `seek` under its shared latch
+    auto load(std::int64_t seek) -> void;
+
+    // Moves to the next page holding records when the current one is exhausted
+    auto advance_page() -> void;
+
+    // Locates the scan again from the last key returned, skipping the records with that key already returned
+    auto reseek() -> void;
+
+    // Moves to the next record, if any, then checks the scan bounds
+    auto settle() -> void;
+
+    // Called whenever the scan moves to a new leaf, it keeps the read-ahead window full
+    auto read_ahead() -> void;
+
+    // Fills `upcoming` with the siblings of the current leaf that may hold records within the scan bounds
+    auto collect_upcoming() -> void;
+
+public:
+
+    struct iterator {
+        using value_type = RecordType;
+        using difference_type = std::ptrdiff_t;
+
+        Cursor *cursor = nullptr;
+
+        auto operator * () const -> RecordType&;
+
+        auto operator ++ () -> iterator&;
+
+        auto operator ++ (int) -> void;
+
+        friend auto operator == (const iterator &iter, std::default_sentinel_t) -> bool {
+            return !iter.cursor->valid();
+        }
+    };
+
+    explicit Cursor(BPlusTree<TYPES()> *tree,
+                    ScanDirection direction,
+                    std::optional<FieldType> lower_bound,
+                    std::optional<FieldType> upper_bound,
+                    std::size_t limit = NO_LIMIT);
+
+    // Forward scan over the whole tree starting at the record at position `offset`, the tree must keep subtree
+    // counts
+    explicit Cursor(BPlusTree<TYPES()> *tree, std::size_t offset, std::size_t limit = NO_LIMIT);
+
+    [[nodiscard]] auto valid() const -> bool;
+
+    auto record() -> RecordType&;
+
+    auto next() -> void;
+
+    // Positions [first, last) of the records the scan visits in the current leaf before moving to another one,
+    // in page order. Aggregates consume them a whole run at a time.
+    auto leaf_run() -> std::pair<std::int32_t, std::int32_t>;
+
+    auto leaf() -> DataPage<TYPES()>&;
+
+    // Moves past `count` records of the current run
+    auto advance(std::int32_t count) -> void;
+
+    auto begin() -> iterator;
+
+    auto end() -> std::default_sentinel_t;
+};
+
+
+#include "cursor.tpp"
+
+#endif //B_PLUS_TREE_CURSOR_HPP
@@ -12,27 +12,48 @@
 #include <sstream>
 #include <cstring>
 #include <utility>
+#include <algorithm>
 
 #include "page.hpp"
+#include "leaf_codec.hpp"
+#include "key_search.hpp"
 #include "buffer_size.hpp"
 #include "error_handler.hpp"
 
 
+// Records of fixed-size types are stored as a dense array. Other types use a slotted layout: a directory of slots
+// follows the header and the records are packed from the end of the page, which is then full once its bytes run
+// out rather than once it holds MAX_DATA_PAGE_CAPACITY records. Trees with COMPRESSED_LEAVES store the records
+// of fixed-size types delta-encoded instead, and their pages are also bounded by bytes.
 template<TYPES(typename)>
 struct DataPage : public Page<TYPES()> {
 
+    static constexpr bool fixed_layout = Serializer<RecordType>::fixed_size;
+
+private:
+
+    // Bytes taken by `record` encoded against `previous`, null for the first record of the page
+    static auto delta_size(const RecordType &record, const RecordType *previous) -> std::int32_t;
+
+public:
+
     std::int32_t num_records;
     std::int64_t next_leaf;
     std::int64_t prev_leaf;
     std::vector<RecordType> records;
+    // Search fields of the records, kept next to them so that the in-page searches only touch key bytes. They
+    // are not stored in the file, reading a page extracts them.
+    std::vector<FieldType> keys;
 
     explicit DataPage(BPlusTree<TYPES()> *tree);
 
     ~DataPage() override;
 
-    auto write() -> void override;
+    auto type() -> PageType override;
 
-    auto read() -> void override;
+    auto write(char *buffer) -> void override;
+
+    auto read(const char *buffer) -> void override;
 
     auto bytes_len() -> std::int32_t override;
 
@@ -40,6 +61,52 @@ struct DataPage : public Page<TYPES()> {
 
     auto max_capacity() -> std::size_t override;
 
+    auto header_size() -> std::int32_t override;
+
+    auto overflows() -> bool override;
+
+    auto underflows() -> bool override;
+
+    auto occupancy() -> double override;
+
+    auto compressed() -> bool;
+
+    // Whether the capacity of the page is given by its bytes rather than by its number of records
+    auto byte_bounded() -> bool;
+
+    // Bytes taken by the records of a slotted or compressed page, along with their slots
+    auto payload_size() -> std::int32_t;
+
+    static auto entry_size(const RecordType &record) -> std::int32_t;
+
+    // Bytes taken by the record at `record_pos` as stored in the page
+    auto stored_size(std::int32_t record_pos) -> std::int32_t;
+
+    // Bytes the page grows by when `record` is inserted at `record_pos`
+    auto insert_size(std::int32_t record_pos, const RecordType &record) -> std::int32_t;
+
+    // Bytes the page shrinks by when the record at `record_pos` is removed, negative if it grows instead
+    auto remove_size(std::int32_t record_pos) -> std::int32_t;
+
+    // Bytes taken by this page once merged with `right_sibling`
+    auto merged_size(DataPage<TYPES()> &right_sibling) -> std::int32_t;
+
+    // Throws EntryTooLarge for a record, or a key, that would leave no room for the others in a slotted page
+    auto check_size(RecordType &record) -> void;
+
+    // Whether `record` can be added without splitting the page
+    auto fits(const RecordType &record) -> bool;
+
+    // Whether the page keeps its minimum occupancy without the record at `record_pos`
+    auto can_spare(std::int32_t record_pos, bool is_root = false) -> bool;
+
+    // Position where the page is split, so that both halves take about the same space
+    auto split_position() -> std::int32_t;
+
+    auto allocate() -> std::streampos override;
+
+    auto release(std::streampos pos) -> void override;
+
     auto split(std::int32_t split_pos) -> SplitResult<TYPES()> override;
 
     auto balance_page_insert(
@@ -66,6 +133,12 @@ struct DataPage : public Page<TYPES()> {
 
     auto max_record() -> RecordType;
 
+    // Position of the first record whose key is not lower than `key`
+    auto lower_bound(const FieldType &key) -> std::int32_t;
+
+    // Position of the first record whose key is greater than `key`
+    auto upper_bound(const FieldType &key) -> std::int32_t;
+
     auto sorted_insert(RecordType &record) -> void;
 
     auto remove(FieldType key) -> std::shared_ptr<FieldType>;
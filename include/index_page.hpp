@@ -8,31 +8,55 @@
 
 #include <cmath>
 #include <vector>
+#include <numeric>
 #include <fstream>
 #include <sstream>
 #include <cstring>
+#include <tuple>
 #include <utility>
 
 #include "page.hpp"
+#include "key_search.hpp"
 #include "buffer_size.hpp"
 #include "error_handler.hpp"
 
 
+// Keys of fixed-size types are stored as a dense array. Other types use a slotted layout, see DataPage.
+// Lexicographic keys are front-coded in the slotted layout: each one only stores the bytes it does not share with
+// the previous key, and the first key of the page is stored whole.
+// Trees keeping subtree counts also store, after the children, the number of records under each one of them.
 template<TYPES(typename)>
 struct IndexPage : public Page<TYPES()> {
 
+    static constexpr bool fixed_layout = Serializer<FieldType>::fixed_size;
+
+    static constexpr bool front_coded = is_lexicographic<FieldType, Compare>;
+
     std::int32_t num_keys;
     std::vector<FieldType> keys;
     std::vector<std::int64_t> children;
+    // Records under each child, only meaningful when the tree keeps subtree counts
+    std::vector<std::int64_t> counts;
     bool points_to_leaf;
 
     explicit IndexPage(BPlusTree<TYPES()> *tree, bool points_to_leaf = true);
 
     ~IndexPage();
 
-    auto write() -> void override;
+    auto type() -> PageType override;
+
+    // Whether the tree keeps subtree counts, so that `counts` is stored with the page
+    auto counted() -> bool;
+
+    // Records under the page
+    auto subtree_size() -> std::int64_t;
+
+    // Also refreshes the resident copy of the page, if the tree keeps one
+    auto save(std::streampos pos) -> void;
+
+    auto write(char *buffer) -> void override;
 
-    auto read() -> void override;
+    auto read(const char *buffer) -> void override;
 
     auto bytes_len() -> std::int32_t override;
 
@@ -40,6 +64,36 @@ struct IndexPage : public Page<TYPES()> {
 
     auto max_capacity() -> std::size_t override;
 
+    auto header_size() -> std::int32_t override;
+
+    auto overflows() -> bool override;
+
+    auto underflows() -> bool override;
+
+    auto occupancy() -> double override;
+
+    // Bytes taken by the children, the keys and their slots in a slotted page
+    auto payload_size() -> std::int32_t;
+
+    // Bytes taken by a child reference, along with its count when the tree keeps them
+    static auto child_size(bool counted) -> std::int32_t;
+
+    // Bytes added by a separator along with the child that follows it, at most, since front coding may shorten it
+    static auto entry_size(const FieldType &key, bool counted) -> std::int32_t;
+
+    // Bytes taken by the key at `key_pos` and the child that follows it, as stored in the page
+    auto stored_size(std::int32_t key_pos) -> std::int32_t;
+
+    // Whether the page keeps its minimum occupancy without the key at `key_pos`
+    auto can_spare(std::int32_t key_pos) -> bool;
+
+    // Position of the key moved up to the parent on a split, so that both halves take about the same space
+    auto split_position() -> std::int32_t;
+
+    auto allocate() -> std::streampos override;
+
+    auto release(std::streampos pos) -> void override;
+
     auto split(std::int32_t split_pos) -> SplitResult<TYPES()> override;
 
     auto balance_page_insert(
@@ -56,20 +110,38 @@ struct IndexPage : public Page<TYPES()> {
 
     auto balance_root_remove() -> void override;
 
-    auto push_front(FieldType &key, std::streampos child) -> void;
+    auto push_front(FieldType &key, std::streampos child, std::int64_t count = 0) -> void;
 
-    auto push_back(FieldType &key, std::streampos child) -> void;
+    auto push_back(FieldType &key, std::streampos child, std::int64_t count = 0) -> void;
 
-    auto pop_front() -> std::pair<FieldType, std::streampos>;
+    // The key, the child and the records under it
+    auto pop_front() -> std::tuple<FieldType, std::streampos, std::int64_t>;
 
-    auto pop_back() -> std::pair<FieldType, std::streampos>;
+    auto pop_back() -> std::tuple<FieldType, std::streampos, std::int64_t>;
 
+    // Position of the first child whose subtree may contain `key`
+    auto child_position(const FieldType &key) -> std::int32_t;
+
+    // Position of the last child whose subtree may contain `key`, they differ when duplicated keys span pages
+    auto last_child_position(const FieldType &key) -> std::int32_t;
+
+    // The child at `child_pos` already counts the records moved to the new page, `new_page_count` of them
     auto reallocate_references_after_split(std::int32_t child_pos,
                                            FieldType &new_key,
-                                           std::streampos new_page_seek) -> void;
+                                           std::streampos new_page_seek,
+                                           std::int64_t new_page_count) -> void;
 
     auto reallocate_references_after_merge(std::int32_t merged_child_pos) -> void;
 
+    // Moves `count` records from the child at `from` to its sibling at `to`, after a borrow between them
+    auto transfer_count(std::int32_t from, std::int32_t to, std::int64_t count) -> void;
+
+    // Child holding the record at `rank` among the records under the page, `rank` is made relative to it
+    auto child_at_rank(std::int64_t &rank) -> std::int32_t;
+
+    // Records under the children before `child_pos`
+    auto records_before(std::int32_t child_pos) -> std::int64_t;
+
     auto merge(IndexPage<TYPES()> &right_sibling, FieldType &new_key) -> void;
 };
 
@@ -0,0 +1,57 @@
+#ifndef B_PLUS_TREE_KEY_EXTRACTOR_HPP
+#define B_PLUS_TREE_KEY_EXTRACTOR_HPP
+
+
+#include <concepts>
+#include <functional>
+#include <type_traits>
+
+
+// Anything the tree can take the search field of a record from: function objects, plain functions and pointers
+// to data members. Extractors whose type names the key (lambdas, key_of) are inlined in the page searches,
+// while std::function goes through an indirect call per record.
+template<typename Extractor, typename RecordType, typename FieldType>
+concept KeyExtractor = std::invocable<Extractor&, RecordType&> &&
+                       std::convertible_to<std::invoke_result_t<Extractor&, RecordType&>, FieldType>;
+
+
+// Stateless extractor reading a data member, e.g. key_of<&Record::id>
+template<auto Member>
+struct key_of {
+    template<typename RecordType>
+    constexpr auto operator()(RecordType &record) const -> decltype(auto) {
+        return std::invoke(Member, record);
+    }
+};
+
+
+// Record and field types of an extractor taking a single record, used to deduce the tree parameters
+template<typename Extractor>
+struct extractor_traits : extractor_traits<decltype(&Extractor::operator())> {};
+
+template<typename Class, typename Field, typename Record>
+struct extractor_traits<Field (Class::*)(Record) const> {
+    using record_type = std::remove_cvref_t<Record>;
+    using field_type = std::remove_cvref_t<Field>;
+};
+
+template<typename Class, typename Field, typename Record>
+struct extractor_traits<Field (Class::*)(Record)> : extractor_traits<Field (Class::*)(Record) const> {};
+
+template<typename Field, typename Record>
+struct extractor_traits<Field (*)(Record)> {
+    using record_type = std::remove_cvref_t<Record>;
+    using field_type = std::remove_cvref_t<Field>;
+};
+
+template<typename Field, typename Record> requires (!std::is_function_v<Field>)
+struct extractor_traits<Field Record::*> {
+    using record_type = Record;
+    using field_type = std::remove_cv_t<Field>;
+};
+
+template<auto Member>
+struct extractor_traits<key_of<Member>> : extractor_traits<decltype(Member)> {};
+
+
+#endif //B_PLUS_TREE_KEY_EXTRACTOR_HPP
@@ -0,0 +1,109 @@
+#ifndef B_PLUS_TREE_KEY_SEARCH_HPP
+#define B_PLUS_TREE_KEY_SEARCH_HPP
+
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#if !defined(B_PLUS_TREE_SCALAR_SEARCH) && (defined(__AVX2__) || defined(__SSE4_2__))
+#include <immintrin.h>
+#define B_PLUS_TREE_SIMD_SEARCH
+#endif
+
+
+// Number of keys left to the vectorized scan once the binary search has narrowed the range
+constexpr std::size_t SIMD_SEARCH_WINDOW = 32;
+
+
+// Branchless binary searches shared by every strategy, see KeySearch for the meaning of each bound
+template<typename FieldType, typename ElementType, typename Compare, typename Projection>
+auto branchless_lower_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection) -> std::size_t;
+
+template<typename FieldType, typename ElementType, typename Compare, typename Projection>
+auto branchless_upper_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection) -> std::size_t;
+
+
+// In-page search strategy. Positions follow the tree ordering given by `gt`, the greater-than comparator:
+//  - lower_bound: first element `e` for which gt(key, e) does not hold
+//  - upper_bound: first element `e` for which gt(e, key) holds
+// The strategy may be specialized for custom key types, the default one is a branchless binary search.
+template<typename FieldType, typename Compare, typename = void>
+struct KeySearch {
+
+    template<typename ElementType, typename Projection = std::identity>
+    static auto lower_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection = {}) -> std::size_t;
+
+    template<typename ElementType, typename Projection = std::identity>
+    static auto upper_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection = {}) -> std::size_t;
+};
+
+
+// Whether the keys can be compared with vector instructions: signed integers and floating point numbers
+// ordered through std::greater or std::less
+template<typename FieldType, typename Compare>
+constexpr bool is_simd_searchable = (
+#if defined(B_PLUS_TREE_SIMD_SEARCH)
+        (std::is_same_v<FieldType, std::int32_t> || std::is_same_v<FieldType, std::int64_t> ||
+         std::is_same_v<FieldType, float> || std::is_same_v<FieldType, double>) &&
+        (std::is_same_v<Compare, std::greater<FieldType>> || std::is_same_v<Compare, std::less<FieldType>>)
+#else
+        false
+#endif
+);
+
+
+// Vectorized lower bound over a plain array of keys, it falls back to the scalar strategy for projections
+template<typename FieldType, typename Compare>
+struct KeySearch<FieldType, Compare, std::enable_if_t<is_simd_searchable<FieldType, Compare>>> {
+
+    template<typename ElementType, typename Projection = std::identity>
+    static auto lower_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection = {}) -> std::size_t;
+
+    template<typename ElementType, typename Projection = std::identity>
+    static auto upper_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection = {}) -> std::size_t;
+
+    // Counts the keys in [first, first + size) for which gt(key, k) holds
+    static auto count_preceding(const FieldType *first, std::size_t size, const FieldType &key) -> std::size_t;
+};
+
+
+// Whether keys are ordered byte by byte, ascending through std::greater or descending through std::less. Keys close
+// in such an ordering share their leading bytes.
+template<typename FieldType, typename Compare>
+constexpr bool is_lexicographic = std::is_same_v<FieldType, std::string> && (
+        std::is_same_v<Compare, std::greater<std::string>> || std::is_same_v<Compare, std::greater<>> ||
+        std::is_same_v<Compare, std::less<std::string>> || std::is_same_v<Compare, std::less<>>);
+
+
+// Number of leading bytes shared by both strings
+inline auto shared_prefix_length(const std::string &a, const std::string &b) -> std::size_t;
+
+
+// Separator stored in the parent between two adjacent pages, given the greatest key of the left one and the least
+// of the right one. Any key `s` with left <= s < right in the tree ordering routes both pages the same way, the
+// default is the left key itself.
+template<typename FieldType, typename Compare, typename = void>
+struct SeparatorTruncation {
+    static auto between(const FieldType &left, const FieldType &right) -> FieldType;
+};
+
+
+// Lexicographic keys are cut down to the shortest such separator, which raises the fanout of the index pages
+template<typename FieldType, typename Compare>
+struct SeparatorTruncation<FieldType, Compare, std::enable_if_t<is_lexicographic<FieldType, Compare>>> {
+    static auto between(const FieldType &left, const FieldType &right) -> FieldType;
+};
+
+
+#include "key_search.tpp"
+
+#endif //B_PLUS_TREE_KEY_SEARCH_HPP
@@ -0,0 +1,29 @@
+#ifndef B_PLUS_TREE_LEAF_CODEC_HPP
+#define B_PLUS_TREE_LEAF_CODEC_HPP
+
+
+#include <cstdint>
+#include <cstddef>
+
+
+// Encoding of the records of compressed data pages. Each record is stored as its difference with the previous
+// one in the page (the first one with a record of zero bytes): the bytes of both are XORed and the result is
+// written as alternating runs of zero bytes, given by their length, and literal bytes. Both lengths of a run
+// usually fit in the nibbles of a single byte. Records sorted by key mostly differ in a few bytes (e.g. the low
+// bytes of dense integer keys), so most of them shrink to a handful of bytes. An encoding that would be longer
+// than the record itself stores it whole, so a record never takes more than DELTA_OVERHEAD bytes beyond its size.
+
+// Bytes added by the encoding to a record stored whole
+constexpr std::int32_t DELTA_OVERHEAD = 1;
+
+// Bytes taken by `record` encoded against `previous`, both of `size` bytes. Null `previous` stands for zeros.
+auto delta_size(const char *record, const char *previous, std::size_t size) -> std::int32_t;
+
+// Writes `record` encoded against `previous` into `out` and returns the bytes written
+auto encode_delta(const char *record, const char *previous, std::size_t size, char *out) -> std::int32_t;
+
+// Reads a record encoded against `previous` from `in` into `record` and returns the bytes read
+auto decode_delta(const char *in, const char *previous, std::size_t size, char *record) -> std::int32_t;
+
+
+#endif //B_PLUS_TREE_LEAF_CODEC_HPP
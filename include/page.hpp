@@ -11,6 +11,8 @@
 
 #include "property.hpp"
 #include "file_utils.hpp"
+#include "serializer.hpp"
+#include "tree_stats.hpp"
 
 
 #define TYPES(T) T FieldType, T RecordType, T Compare, T FieldMapping
@@ -24,6 +26,15 @@ class BPlusTree;
 template<TYPES(typename)>
 struct IndexPage;
 
+template<TYPES(typename)>
+struct BulkLoader;
+
+template<TYPES(typename)>
+class Cursor;
+
+template<TYPES(typename)>
+class TreeAnalyzer;
+
 
 template<TYPES(typename)>
 struct Page {
@@ -35,17 +46,50 @@ public:
 
     virtual ~Page();
 
+    virtual auto type() -> PageType = 0;
+
     auto is_full() -> bool;
 
     auto is_empty() -> bool;
 
+    // Whether the page went past its capacity and has to be split
+    virtual auto overflows() -> bool = 0;
+
+    // Whether the page went below its minimum occupancy and has to borrow from or merge with a sibling
+    virtual auto underflows() -> bool = 0;
+
+    // Byte limits of slotted pages: the largest entry they take, the occupancy past which they are split and the
+    // one below which they are rebalanced. They do not apply to the layouts of fixed-size types.
+    auto entry_limit() -> std::int32_t;
+
+    auto high_water() -> std::int32_t;
+
+    auto low_water() -> std::int32_t;
+
+    virtual auto header_size() -> std::int32_t = 0;
+
+    // Share of its capacity taken by the entries, in number or in bytes, whichever is closer to its limit
+    virtual auto occupancy() -> double = 0;
+
+    // Bytes taken by the page in the file, its layout is padded up to the page size of the tree
+    auto page_size() -> std::int32_t;
+
     auto save(std::streampos pos) -> void;
 
     auto load(std::streampos pos) -> void;
 
-    virtual auto write() -> void = 0;
+    // Hints that the page stored at `pos` is about to be loaded
+    auto prefetch(std::streampos pos) -> void;
+
+    // Takes a slot for a new page of this type from the free list, or from the end of the file if it is empty
+    virtual auto allocate() -> std::streampos = 0;
+
+    // Adds the slot of a page of this type that is no longer referenced to the free list
+    virtual auto release(std::streampos pos) -> void = 0;
+
+    virtual auto write(char *buffer) -> void = 0;
 
-    virtual auto read() -> void = 0;
+    virtual auto read(const char *buffer) -> void = 0;
 
     virtual auto bytes_len() -> std::int32_t = 0;
 
@@ -78,16 +122,20 @@ struct SplitResult {
 };
 
 
-// Gets the size of the previous page after inserting (it is used recursively)
+// Gets the size of the previous page after inserting and whether it has to be split (it is used recursively)
 struct InsertResult {
     std::size_t size;
+    bool overflow;
 };
 
 
+// A separator replaced by a longer one may also overflow the index page of a slotted layout, and a compressed data
+// page may grow when a record is removed
 template<typename FieldType>
 struct RemoveResult {
     std::size_t size;
     std::shared_ptr<FieldType> predecessor;
+    bool overflow;
 };
 
 
@@ -0,0 +1,69 @@
+#ifndef B_PLUS_TREE_PINNED_INDEX_HPP
+#define B_PLUS_TREE_PINNED_INDEX_HPP
+
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+#include "index_page.hpp"
+
+
+// Outcome of descending the index pages towards a key
+template<typename FieldType>
+struct LeafLocation {
+    std::streampos seek_page;
+    // Greatest key routed to the leaf, unless it is the last one
+    std::optional<FieldType> upper_fence;
+    // Whether a separator on the way equals the key
+    bool separator_match;
+};
+
+
+// Resident copy of every index page of the tree, laid out as a B-tree in arrays: nodes are numbered in
+// breadth-first order and each one takes a fixed stride of keys and children, so the children of a node are
+// contiguous nodes of the next level and a descent never touches the file. The copy is built by the first
+// descent and patched whenever an index page is saved with the same shape (e.g. a leaf split adding a separator).
+// Changes to the shape of the index levels (an index page allocated, released or gaining children from a
+// sibling) drop it until the next descent rebuilds it.
+// Pages are patched under the exclusive tree latch, while descents only require the shared one.
+template<TYPES(typename)>
+class PinnedIndex {
+    BPlusTree<TYPES()> *tree;
+
+    std::size_t stride;
+    std::vector<FieldType> keys;
+    std::vector<std::int64_t> children;
+    std::vector<std::int32_t> num_keys;
+    // Node holding the first child of each node, or -1 when the children are data pages
+    std::vector<std::int32_t> first_child;
+    std::unordered_map<std::int64_t, std::int32_t> nodes;
+
+    std::atomic<bool> valid;
+    std::mutex build_latch;
+
+    auto build() -> void;
+
+public:
+
+    explicit PinnedIndex(BPlusTree<TYPES()> *tree);
+
+    // Data page where the records with `key` start, or where they end when `last` is set. The tree root must be
+    // an index page.
+    auto locate(const FieldType &key, bool last = false) -> LeafLocation<FieldType>;
+
+    // Mirrors the index page just written at `pos`
+    auto update(std::streampos pos, IndexPage<TYPES()> &page) -> void;
+
+    auto invalidate() -> void;
+
+    // Bytes taken by the resident copy
+    [[nodiscard]] auto memory_usage() const -> std::size_t;
+};
+
+
+#include "pinned_index.tpp"
+
+#endif //B_PLUS_TREE_PINNED_INDEX_HPP
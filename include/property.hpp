@@ -11,6 +11,9 @@
 #include <fstream>
 #include <cstdint>
 
+#include "storage.hpp"
+#include "buffer_pool.hpp"
+
 
 // Identifiers for pages type
 enum PageType {
@@ -36,8 +39,35 @@ struct Property {
     std::int32_t SPLIT_POS_DATA_PAGE;
     std::int32_t ROOT_STATUS;
 
+    // Heads of the lists of released pages, linked through the pages themselves
+    std::int64_t FREE_DATA_PAGE_HEAD;
+    std::int64_t FREE_INDEX_PAGE_HEAD;
+
+    // Bytes taken by every page in the file, a multiple of the block size. Zero for files written before pages
+    // were padded, where each page takes exactly the bytes of its layout.
+    std::int32_t PAGE_SIZE;
+
     bool UNIQUE;
 
+    // Whether data pages of fixed-size records are stored compressed, see leaf_codec.hpp. Their records are then
+    // bounded by the bytes of the page, MAX_DATA_PAGE_CAPACITY only bounds how many of them a page may hold.
+    bool COMPRESSED_LEAVES;
+
+    // Whether index pages store the number of records under each of their children, which answers rank and
+    // positional queries in a single descent. Every insert and remove then rewrites the index pages on its path,
+    // so they always take the exclusive tree latch. Fixed when the tree is created.
+    bool SUBTREE_COUNTS;
+
+    // Runtime settings, they are not persisted in the metadata file
+    std::int32_t BUFFER_POOL_CAPACITY;
+    StorageBackend STORAGE_BACKEND;
+
+    // Whether operations are logged and synced before returning, see WriteAheadLog
+    bool DURABLE;
+
+    // Whether the index pages are kept resident, see PinnedIndex
+    bool PINNED_INDEX;
+
     std::string INDEX_FULL_PATH;
     std::string METADATA_FULL_PATH;
 
@@ -46,7 +76,13 @@ struct Property {
                       const std::string& index_file_name,
                       int32_t index_page_capacity,
                       int32_t data_page_capacity,
-                      bool unique_key);
+                      bool unique_key,
+                      int32_t buffer_pool_capacity = DEFAULT_BUFFER_POOL_CAPACITY,
+                      StorageBackend storage_backend = streamStorage,
+                      bool durable = false,
+                      bool pinned_index = false,
+                      bool compressed_leaves = false,
+                      bool subtree_counts = false);
 
     void load(std::fstream &file);
 
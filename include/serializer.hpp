@@ -0,0 +1,76 @@
+#ifndef B_PLUS_TREE_SERIALIZER_HPP
+#define B_PLUS_TREE_SERIALIZER_HPP
+
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+
+// Converts keys and records to the bytes stored in the pages. Trivially copyable types are copied as they are and
+// take a fixed size, which keeps the dense page layouts. Other types specialize the trait with `fixed_size` unset,
+// their pages are then slotted and their capacity is measured in bytes.
+template<typename T, typename = void>
+struct Serializer {
+    static_assert(std::is_trivially_copyable_v<T>, "Serializer must be specialized for this type");
+
+    static constexpr bool fixed_size = true;
+
+    static auto size(const T &) -> std::size_t {
+        return sizeof(T);
+    }
+
+    static auto write(char *buffer, const T &value) -> void {
+        std::memcpy(buffer, &value, sizeof(T));
+    }
+
+    static auto read(const char *buffer, std::size_t, T &value) -> void {
+        std::memcpy(&value, buffer, sizeof(T));
+    }
+};
+
+
+template<>
+struct Serializer<std::string> {
+    static constexpr bool fixed_size = false;
+
+    static auto size(const std::string &value) -> std::size_t {
+        return value.size();
+    }
+
+    static auto write(char *buffer, const std::string &value) -> void {
+        std::memcpy(buffer, value.data(), value.size());
+    }
+
+    static auto read(const char *buffer, std::size_t size, std::string &value) -> void {
+        value.assign(buffer, size);
+    }
+};
+
+
+// Entry of the directory of a slotted page, locating a value by its offset from the start of the page
+struct Slot {
+    std::int32_t offset;
+    std::int32_t size;
+};
+
+
+// Entry of the directory of a front-coded page: the value is stored as the bytes following the first `shared` ones
+// of the previous value
+struct PrefixSlot {
+    std::int32_t offset;
+    std::int32_t size;
+    std::int32_t shared;
+};
+
+
+// Largest entry of a slotted page, as a fraction of the page size. An index page may gain two entries during a
+// single operation before it is split, so it must always have room for them.
+constexpr std::int32_t MAX_ENTRY_FRACTION = 16;
+
+// Occupancy below which a slotted page borrows from or merges with a sibling, as a fraction of its capacity
+constexpr std::int32_t MIN_FILL_FRACTION = 4;
+
+
+#endif //B_PLUS_TREE_SERIALIZER_HPP
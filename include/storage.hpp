@@ -0,0 +1,243 @@
+#ifndef B_PLUS_TREE_STORAGE_HPP
+#define B_PLUS_TREE_STORAGE_HPP
+
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <functional>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define B_PLUS_TREE_IO_URING
+#endif
+
+
+// Identifiers for the available storage backends
+enum StorageBackend {
+    streamStorage = 0,  // std::fstream reads and writes
+    mmapStorage   = 1,  // memory-mapped file
+    uringStorage  = 2,  // batched asynchronous I/O through io_uring, stream reads and writes where unavailable
+    positionalStorage = 3  // pread and pwrite, stream reads and writes where unavailable
+};
+
+
+// A single transfer of a batch, the buffer is read into or written from
+struct IORequest {
+    std::int64_t pos;
+    char *buffer;
+    std::size_t size;
+};
+
+
+// Byte-addressable access to the file that holds the pages of the tree. Every backend may be called from
+// several threads at once.
+class Storage {
+public:
+
+    virtual ~Storage();
+
+    // Copies `size` bytes stored at `pos` into `buffer` and returns how many of them were actually stored
+    virtual auto read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t = 0;
+
+    virtual auto write(std::int64_t pos, const char *buffer, std::size_t size) -> void = 0;
+
+    // Performs every transfer of the batch, backends able to keep several of them in flight do so. Bytes read
+    // past the end of the file are zeroed.
+    virtual auto read_batch(const std::vector<IORequest> &requests) -> void;
+
+    virtual auto write_batch(const std::vector<IORequest> &requests) -> void;
+
+    // Direct access to the stored bytes, or nullptr if the backend cannot provide it. A writable view extends
+    // the file when needed. Views stay valid as long as the storage.
+    virtual auto view(std::int64_t pos, std::size_t size, bool writable) -> char*;
+
+    // Hints that the `size` bytes stored at `pos` will be read soon, so that the OS may start fetching them
+    // in the background. Backends without such a mechanism ignore it.
+    virtual auto prefetch(std::int64_t pos, std::size_t size) -> void;
+
+    virtual auto size() -> std::int64_t = 0;
+
+    virtual auto flush() -> void = 0;
+
+    // Flushes and waits until the content of the file is durable
+    virtual auto sync() -> void;
+};
+
+
+// The stream holds a single file position, so its calls are serialized
+class StreamStorage : public Storage {
+    std::fstream file;
+    std::mutex latch;
+
+    // Descriptor of the same file, only used to pass read-ahead advice to the OS and to sync the file
+    int advice_descriptor;
+
+public:
+
+    explicit StreamStorage(const std::string &file_name);
+
+    ~StreamStorage() override;
+
+    auto read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t override;
+
+    auto write(std::int64_t pos, const char *buffer, std::size_t size) -> void override;
+
+    auto prefetch(std::int64_t pos, std::size_t size) -> void override;
+
+    auto size() -> std::int64_t override;
+
+    auto flush() -> void override;
+
+    auto sync() -> void override;
+};
+
+
+#if defined(__unix__)
+
+// Reads and writes at explicit offsets, so that concurrent calls never share a file position
+class PositionalStorage : public Storage {
+    int file_descriptor;
+
+public:
+
+    explicit PositionalStorage(const std::string &file_name);
+
+    ~PositionalStorage() override;
+
+    auto read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t override;
+
+    auto write(std::int64_t pos, const char *buffer, std::size_t size) -> void override;
+
+    auto prefetch(std::int64_t pos, std::size_t size) -> void override;
+
+    auto size() -> std::int64_t override;
+
+    auto flush() -> void override;
+
+    auto sync() -> void override;
+};
+
+
+constexpr std::int64_t MMAP_GROWTH_CHUNK = 16 << 20;
+
+// Address space set aside for the mapping, it bounds the size of the file
+constexpr std::int64_t MMAP_ADDRESS_RESERVATION = std::int64_t(1) << 38;
+
+// Maps the whole file in memory. The mapping grows in chunks of MMAP_GROWTH_CHUNK bytes as pages are appended
+// and the file is cut back to its logical size when the storage is closed. Chunks are mapped inside a fixed
+// reservation of address space, so the mapping never moves and views handed to other threads stay valid.
+class MmapStorage : public Storage {
+    int file_descriptor;
+    char *base;
+    std::atomic<std::int64_t> mapped_size;
+    std::atomic<std::int64_t> logical_size;
+    std::mutex growth_latch;
+
+    auto reserve(std::int64_t min_size) -> void;
+
+public:
+
+    explicit MmapStorage(const std::string &file_name);
+
+    ~MmapStorage() override;
+
+    auto read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t override;
+
+    auto write(std::int64_t pos, const char *buffer, std::size_t size) -> void override;
+
+    auto view(std::int64_t pos, std::size_t size, bool writable) -> char* override;
+
+    auto prefetch(std::int64_t pos, std::size_t size) -> void override;
+
+    auto size() -> std::int64_t override;
+
+    auto flush() -> void override;
+
+    auto sync() -> void override;
+};
+
+#endif
+
+
+#if defined(B_PLUS_TREE_IO_URING)
+
+constexpr std::uint32_t URING_QUEUE_DEPTH = 64;
+
+// Issues reads and writes through an io_uring instance driven by raw system calls. A batch is submitted with a
+// single io_uring_enter call, which also waits for its completions. Read-ahead hints are submitted without
+// waiting and their completions are collected along the next batch.
+class UringStorage : public Storage {
+    int file_descriptor;
+    int ring_descriptor;
+
+    void *submission_ring;
+    std::size_t submission_ring_size;
+    void *completion_ring;
+    std::size_t completion_ring_size;
+    void *submission_entries;
+    std::size_t submission_entries_size;
+
+    std::uint32_t *submission_head;
+    std::uint32_t *submission_tail;
+    std::uint32_t submission_mask;
+    std::uint32_t submission_entries_count;
+    std::uint32_t *submission_array;
+
+    std::uint32_t *completion_head;
+    std::uint32_t *completion_tail;
+    std::uint32_t completion_mask;
+    void *completions;
+
+    // Hints submitted whose completion has not been collected yet
+    std::uint32_t pending_hints;
+
+    // The rings are shared by every thread, so a single batch is in flight at a time
+    std::mutex latch;
+
+    // Transfers a batch with the given operation, resubmitting the remainder of short transfers
+    auto submit(std::uint8_t opcode, const std::vector<IORequest> &requests) -> std::vector<std::size_t>;
+
+    auto enqueue(std::uint8_t opcode, std::int64_t pos, char *buffer, std::size_t size, std::uint64_t tag) -> void;
+
+    auto enter(std::uint32_t to_submit, std::uint32_t min_complete) -> void;
+
+    // Consumes the available completions, passing those that do not belong to hints to `on_completion`.
+    // Returns how many were passed.
+    auto reap(const std::function<void(std::uint64_t tag, std::int32_t result)> &on_completion) -> std::uint32_t;
+
+    auto release_rings() -> void;
+
+public:
+
+    explicit UringStorage(const std::string &file_name);
+
+    ~UringStorage() override;
+
+    auto read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t override;
+
+    auto write(std::int64_t pos, const char *buffer, std::size_t size) -> void override;
+
+    auto read_batch(const std::vector<IORequest> &requests) -> void override;
+
+    auto write_batch(const std::vector<IORequest> &requests) -> void override;
+
+    auto prefetch(std::int64_t pos, std::size_t size) -> void override;
+
+    auto size() -> std::int64_t override;
+
+    auto flush() -> void override;
+
+    auto sync() -> void override;
+};
+
+#endif
+
+
+auto make_storage(StorageBackend backend, const std::string &file_name) -> std::unique_ptr<Storage>;
+
+
+#endif //B_PLUS_TREE_STORAGE_HPP
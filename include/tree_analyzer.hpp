@@ -0,0 +1,74 @@
+#ifndef B_PLUS_TREE_TREE_ANALYZER_HPP
+#define B_PLUS_TREE_TREE_ANALYZER_HPP
+
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_set>
+
+#include "bplustree.hpp"
+#include "tree_report.hpp"
+
+
+// Pages read from the file with a single storage batch while analyzing it
+constexpr std::size_t ANALYZER_BATCH_PAGES = 256;
+
+
+// Offline verifier of the structure of a tree. The index levels are walked from the root one at a time and the
+// pages of each level are read in file order, in batches whose transfers the storage may overlap, so the leaves
+// are read in a single sequential pass however scattered they are. The tree must not be modified meanwhile.
+template<TYPES(typename)>
+class TreeAnalyzer {
+
+    // Page reached from its parent, along with the keys bounding the range routed to it
+    struct PendingPage {
+        std::int64_t pos;
+        std::optional<FieldType> lower_fence;
+        std::optional<FieldType> upper_fence;
+        // Records under the page according to its parent, when the tree keeps subtree counts
+        std::optional<std::int64_t> count;
+    };
+
+    BPlusTree<TYPES()> *tree;
+    TreeReport report;
+
+    // Pages reached so far, by slot when every page takes the same bytes
+    std::vector<bool> reached_slots;
+    std::unordered_set<std::int64_t> reached_positions;
+
+    // Marks the page of `size` bytes at `pos` as reached, or reports why it cannot be
+    auto reach(std::int64_t pos, std::int32_t size, const char *referrer) -> bool;
+
+    // Reads the pages of `level` in file order and hands each one to `visit` along with its position in `level`
+    template<typename Visitor>
+    auto read_in_file_order(const std::vector<PendingPage> &level, std::int32_t size, Visitor &&visit) -> void;
+
+    // Whether the count at the head of a page stored in `buffer` fits in the page
+    static auto valid_count(const char *buffer, std::size_t max_capacity) -> bool;
+
+    auto check_key(const FieldType &key, const PendingPage &page, std::int64_t pos) -> void;
+
+    auto check_count(const PendingPage &page, std::int64_t records) -> void;
+
+    // Checks the index pages of a level and returns the pages of the level below, setting `points_to_leaf`
+    auto analyze_index_level(const std::vector<PendingPage> &level, bool &points_to_leaf) -> std::vector<PendingPage>;
+
+    auto analyze_leaves(const std::vector<PendingPage> &leaves) -> void;
+
+    auto count_free_pages() -> void;
+
+    static auto summarize(PageType type, const std::vector<double> &fills, std::int64_t entries) -> LevelReport;
+
+public:
+
+    explicit TreeAnalyzer(BPlusTree<TYPES()> *tree);
+
+    auto analyze() -> TreeReport;
+};
+
+
+#include "tree_analyzer.tpp"
+
+#endif //B_PLUS_TREE_TREE_ANALYZER_HPP
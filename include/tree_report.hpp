@@ -0,0 +1,73 @@
+#ifndef B_PLUS_TREE_TREE_REPORT_HPP
+#define B_PLUS_TREE_TREE_REPORT_HPP
+
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+#include "property.hpp"
+
+
+// Problems described in the report, the rest of them are only counted
+constexpr std::size_t MAX_REPORTED_PROBLEMS = 32;
+
+// Compaction is advised below this mean fill of the leaves, below this share of leaves followed by the next
+// slot of the file, or above this share of the file taken by unused pages
+constexpr double COMPACTION_FILL = 0.5;
+constexpr double COMPACTION_SEQUENTIAL_LEAVES = 0.5;
+constexpr double COMPACTION_UNUSED_PAGES = 0.25;
+
+
+struct LevelReport {
+    PageType type;
+    std::int64_t pages;
+    std::int64_t entries;
+    double min_fill;
+    double mean_fill;
+    double max_fill;
+};
+
+
+struct TreeReport {
+    std::int64_t file_size = 0;
+    std::int32_t page_size = 0;
+
+    // From the root down to the leaves
+    std::vector<LevelReport> levels;
+
+    // Pages in the free lists, and pages neither reachable from the root nor free. Orphaned pages can only be
+    // told apart when every page takes the same bytes, see `pages_accounted`.
+    std::int64_t free_pages = 0;
+    std::int64_t orphaned_pages = 0;
+    bool pages_accounted = false;
+
+    // Keys out of order within a page or outside the range routed to it by its parent
+    std::int64_t ordering_violations = 0;
+    // Leaves whose next_leaf or prev_leaf pointer does not lead to their neighbour in key order
+    std::int64_t link_violations = 0;
+    // Pages with an impossible header, referenced from outside the file or from two places
+    std::int64_t corrupt_pages = 0;
+    // Pages holding a number of records other than the one stored by their parent, in trees keeping subtree counts
+    std::int64_t count_mismatches = 0;
+    std::vector<std::string> problems;
+
+    // Distance in pages between the leaves adjacent in key order, which a scan moves across
+    std::int64_t leaf_steps = 0;
+    std::int64_t sequential_leaf_steps = 0;
+    std::int64_t backward_leaf_steps = 0;
+    double mean_leaf_distance = 0;
+
+    auto report_problem(std::string description) -> void;
+
+    [[nodiscard]] auto consistent() const -> bool;
+
+    // Whether rewriting the tree with compact() would pay off for its scans
+    [[nodiscard]] auto should_compact() const -> bool;
+};
+
+auto operator << (std::ostream &out, const TreeReport &report) -> std::ostream&;
+
+
+#endif //B_PLUS_TREE_TREE_REPORT_HPP
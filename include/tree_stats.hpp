@@ -0,0 +1,174 @@
+#ifndef B_PLUS_TREE_TREE_STATS_HPP
+#define B_PLUS_TREE_TREE_STATS_HPP
+
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <ostream>
+#include <functional>
+#include <condition_variable>
+
+#include "property.hpp"
+#include "buffer_pool.hpp"
+
+
+// Public operations whose latency is recorded. Cursors are lazy, so scans are only timed through the range
+// searches and aggregates that drain them.
+enum TreeOperation {
+    insertOperation = 0,
+    removeOperation,
+    insertManyOperation,
+    removeManyOperation,
+    searchOperation,
+    searchManyOperation,
+    aboveOperation,
+    belowOperation,
+    betweenOperation,
+    aggregateOperation,
+    rankOperation,
+    bulkLoadOperation,
+    compactOperation,
+    TREE_OPERATIONS
+};
+
+// Structural changes made by the balance methods of the pages
+enum TreeEvent {
+    pageSplit = 0,
+    pageMerge,
+    pageBorrow,
+    rootChange,
+    TREE_EVENTS
+};
+
+auto operation_name(TreeOperation operation) -> const char*;
+
+// Every power of two of nanoseconds is split in this many buckets, so percentiles are off by 25% at most
+constexpr std::size_t LATENCY_SUB_BUCKETS = 4;
+
+constexpr std::size_t LATENCY_BUCKETS = 64 * LATENCY_SUB_BUCKETS;
+
+
+struct LatencySummary {
+    std::uint64_t count;
+    std::uint64_t total_nanoseconds;
+    std::uint64_t p50;
+    std::uint64_t p90;
+    std::uint64_t p99;
+    std::uint64_t p999;
+    std::uint64_t max;
+};
+
+
+// Log-linear histogram of nanoseconds, it may be recorded from several threads at once
+class LatencyHistogram {
+    std::array<std::atomic<std::uint64_t>, LATENCY_BUCKETS> buckets;
+    std::atomic<std::uint64_t> total_nanoseconds;
+
+    static auto bucket_of(std::uint64_t nanoseconds) -> std::size_t;
+
+    // Greatest latency falling in the bucket
+    static auto bucket_limit(std::size_t bucket) -> std::uint64_t;
+
+public:
+
+    LatencyHistogram();
+
+    auto record(std::uint64_t nanoseconds) -> void;
+
+    [[nodiscard]] auto summary() const -> LatencySummary;
+};
+
+
+// Snapshot returned by BPlusTree::stats. Page loads and saves count every page (de)serialized by the tree, either
+// served by the buffer pool or read from the file, see `buffer_pool` for the latter.
+struct TreeStats {
+    std::uint64_t data_page_loads;
+    std::uint64_t data_page_saves;
+    std::uint64_t index_page_loads;
+    std::uint64_t index_page_saves;
+
+    std::uint64_t splits;
+    std::uint64_t merges;
+    std::uint64_t borrows;
+    std::uint64_t root_changes;
+
+    std::int32_t height;
+    std::int64_t file_size;
+
+    // Only measured when the pages are surveyed, zero otherwise
+    std::int64_t data_pages;
+    std::int64_t index_pages;
+    double data_page_fill;
+    double index_page_fill;
+
+    BufferPoolStats buffer_pool;
+    std::array<LatencySummary, TREE_OPERATIONS> latencies;
+};
+
+auto operator << (std::ostream &out, const TreeStats &stats) -> std::ostream&;
+
+
+// Counters updated by the tree as it works. They are relaxed atomics: each one is exact, but a snapshot taken
+// while other threads operate may mix counts from before and after a given operation.
+class TreeStatistics {
+    std::array<std::atomic<std::uint64_t>, 2> page_loads;
+    std::array<std::atomic<std::uint64_t>, 2> page_saves;
+    std::array<std::atomic<std::uint64_t>, TREE_EVENTS> events;
+    std::array<LatencyHistogram, TREE_OPERATIONS> latencies;
+
+public:
+
+    TreeStatistics();
+
+    auto page_loaded(PageType type) -> void;
+
+    auto page_saved(PageType type) -> void;
+
+    auto record(TreeEvent event) -> void;
+
+    auto record(TreeOperation operation, std::chrono::nanoseconds elapsed) -> void;
+
+    // Fills the counters and latencies of `stats`, the fields measured on the tree itself are left untouched
+    auto snapshot(TreeStats &stats) const -> void;
+};
+
+
+// Records the latency of an operation when it goes out of scope, also when it ends with an exception
+class OperationTimer {
+    TreeStatistics &statistics;
+    TreeOperation operation;
+    std::chrono::steady_clock::time_point start;
+
+public:
+
+    OperationTimer(TreeStatistics &statistics, TreeOperation operation);
+
+    ~OperationTimer();
+};
+
+
+// Background thread calling `report` every `period` until stopped
+class StatsReporter {
+    std::thread worker;
+    std::mutex latch;
+    std::condition_variable wake;
+    bool stopping = false;
+
+public:
+
+    StatsReporter() = default;
+
+    ~StatsReporter();
+
+    // Replaces the running reporter, if any
+    auto start(std::chrono::milliseconds period, std::function<void()> report) -> void;
+
+    auto stop() -> void;
+};
+
+
+#endif //B_PLUS_TREE_TREE_STATS_HPP
@@ -0,0 +1,144 @@
+#ifndef B_PLUS_TREE_WRITE_AHEAD_LOG_HPP
+#define B_PLUS_TREE_WRITE_AHEAD_LOG_HPP
+
+
+#include <array>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "storage.hpp"
+#include "buffer_pool.hpp"
+
+
+const std::string WAL_FILE_EXTENSION = ".wal";
+
+// Size of the log that triggers a checkpoint, after which the log starts over
+constexpr std::uint64_t WAL_CHECKPOINT_SIZE = 64 << 20;
+
+// Metadata fields restored by the log, in the order given by BPlusTree::metadata_state
+using LoggedMetadata = std::array<std::int64_t, 4>;
+
+
+// Redo log of whole page images. The pages written by an operation are staged by the thread running it and
+// appended at once, followed by a commit record holding the metadata of the tree. Commits are made durable with
+// group commit: the first thread waiting for its records writes and syncs everything appended so far, while the
+// threads arriving meanwhile wait for that batch or the next one.
+// Staged pages stay pinned in the buffer pool until their records are durable, so a page never reaches the index
+// file before its image reaches the log.
+class WriteAheadLog {
+public:
+
+    // Page written by an operation, with its content from before the operation and the image to log
+    struct StagedPage {
+        std::int64_t pos;
+        std::vector<char> previous_image;
+        std::vector<char> image;
+    };
+
+private:
+
+    int file_descriptor;
+
+    std::mutex latch;
+    std::condition_variable synced;
+    std::vector<char> pending;
+    std::uint64_t appended_lsn;
+    std::uint64_t durable_lsn;
+    bool syncing;
+
+    // A failed write leaves the log unusable, later commits fail as well
+    bool failed;
+
+    std::unordered_map<std::thread::id, std::vector<StagedPage>> staged;
+
+    auto append_record(std::uint32_t type, std::int64_t pos, const char *payload, std::size_t size) -> void;
+
+public:
+
+    explicit WriteAheadLog(const std::string &file_name);
+
+    ~WriteAheadLog();
+
+    // Starts collecting the pages written by the calling thread
+    auto begin() -> void;
+
+    // Records the image of a page written by the current operation of the calling thread, along with its
+    // content before the write. Returns whether the page was staged for the first time, in which case it must
+    // stay pinned until the operation ends.
+    auto stage(std::int64_t pos, const char *previous_image, const char *image, std::size_t size) -> bool;
+
+    // Appends the staged pages and the commit record, adding their positions to `positions`. Returns the log
+    // position following the commit record, or 0 when nothing was staged. The images land in the log in the
+    // order of the calls, so writers sharing a page must append before releasing its latch.
+    auto append(const LoggedMetadata &metadata, std::vector<std::int64_t> &positions) -> std::uint64_t;
+
+    // Waits until the log is durable up to `lsn`
+    auto wait_durable(std::uint64_t lsn) -> void;
+
+    // Appends the staged pages and the commit record, then waits until they are durable. The positions of the
+    // staged pages are added to `positions`, even when the commit fails.
+    auto commit(const LoggedMetadata &metadata, std::vector<std::int64_t> &positions) -> void;
+
+    // Drops the staged pages without logging them and returns them, so that their content from before the
+    // operation can be put back
+    auto abort() -> std::vector<StagedPage>;
+
+    // Applies every committed operation found in the log to the storage, and passes the metadata of the last
+    // one to `restore`. Returns whether anything was replayed.
+    auto replay(Storage &storage, const std::function<void(const LoggedMetadata&)> &restore) -> bool;
+
+    // Empties the log, once every page it covers is durable in the index file
+    auto truncate() -> void;
+
+    auto size() -> std::uint64_t;
+
+    // Pages staged by the current operation of the calling thread
+    auto staged_pages() -> std::size_t;
+};
+
+
+// Ties the pages written by a tree operation to the log. Without a log it does nothing. An operation destroyed
+// before it is appended, because it threw, puts back the previous content of its pages; the metadata of the tree
+// is restored by the caller.
+class LoggedOperation {
+    WriteAheadLog *log;
+    BufferPool *buffer_pool;
+    bool finished;
+
+    // Pages and end of the records appended by `append`, released by `commit`
+    std::vector<std::int64_t> positions;
+    std::uint64_t commit_lsn;
+
+    auto release() -> void;
+
+public:
+
+    LoggedOperation(WriteAheadLog *log, BufferPool *buffer_pool);
+
+    ~LoggedOperation();
+
+    // Appends the pages of the operation to the log without waiting for them, to be called while the latches of
+    // those pages are still held
+    auto append(const LoggedMetadata &metadata) -> void;
+
+    // Waits until the records appended by `append` are durable
+    auto commit() -> void;
+
+    auto commit(const LoggedMetadata &metadata) -> void;
+
+    // Pages held in the pool by the operation so far
+    auto pending() -> std::size_t;
+};
+
+
+// Makes the content of the file, or the entries of the directory, durable
+auto sync_file(const std::string &file_name) -> void;
+
+
+#endif //B_PLUS_TREE_WRITE_AHEAD_LOG_HPP
@@ -30,11 +30,8 @@ auto main() -> int {
             true
     );
 
-    const std::function<std::int32_t(Record &)> index_by_id = [](Record &record) -> std::int32_t {
-        return record.id;
-    };
-
-    BPlusTree<std::int32_t, Record> bPlusTree(props, index_by_id);
+    // the key and record types are deduced from the extractor
+    BPlusTree bPlusTree(props, key_of<&Record::id>{});
 
     do {
         displayMenu();
@@ -26,6 +26,7 @@ auto BPlusTree<TYPES()>::create_index() -> void {
     close(metadata_file);
 
     // finally, creates an empty file for the B+
+    std::fstream b_plus_index_file;
     open(b_plus_index_file,properties.INDEX_FULL_PATH, std::ios::out);
     if (!b_plus_index_file.is_open()) {
         throw CreateFileError();
@@ -36,7 +37,78 @@ auto BPlusTree<TYPES()>::create_index() -> void {
 
 
 template<TYPES(typename)>
-auto BPlusTree<TYPES()>::locate_data_page(const FieldType &key) -> std::streampos {
+auto BPlusTree<TYPES()>::metadata_state() const -> std::array<std::int64_t, 4> {
+    return { properties.SEEK_ROOT, properties.ROOT_STATUS,
+             properties.FREE_DATA_PAGE_HEAD, properties.FREE_INDEX_PAGE_HEAD };
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::restore_metadata(const LoggedMetadata &state) -> void {
+    properties.SEEK_ROOT = state[0];
+    properties.ROOT_STATUS = static_cast<std::int32_t>(state[1]);
+    properties.FREE_DATA_PAGE_HEAD = state[2];
+    properties.FREE_INDEX_PAGE_HEAD = state[3];
+    // the pages put back by the log bypass IndexPage::save, so the resident copy cannot follow them
+    pinned_index.invalidate();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::save_metadata(bool force) -> void {
+    // The metadata only changes when the root page moves or pages are released and reused,
+    // so most operations do not need to rewrite it. Durable trees carry it in the log between checkpoints.
+    if (!force && (log || persisted_state == metadata_state())) {
+        return;
+    }
+
+    if (!log) {
+        open(metadata_file, properties.METADATA_FULL_PATH, std::ios::out);
+        properties.save(metadata_file);
+        close(metadata_file);
+    } else {
+        // a torn metadata file could not be recovered
+        replace_metadata(properties.METADATA_FULL_PATH);
+    }
+
+    persisted_state = metadata_state();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::replace_metadata(const std::string &path) -> void {
+    std::string const temporary_path = path + ".tmp";
+    open(metadata_file, temporary_path, std::ios::out);
+    properties.save(metadata_file);
+    close(metadata_file);
+    if (log) {
+        sync_file(temporary_path);
+    }
+    std::filesystem::rename(temporary_path, path);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::finish_compaction() -> void {
+    std::string const compacted_index = properties.INDEX_FULL_PATH + COMPACT_FILE_EXTENSION;
+    std::string const compacted_metadata = properties.METADATA_FULL_PATH + COMPACT_FILE_EXTENSION;
+
+    // compact() renames the index file before the metadata file, so either may be left
+    if (std::filesystem::exists(compacted_metadata)) {
+        if (std::filesystem::exists(compacted_index)) {
+            std::filesystem::rename(compacted_index, properties.INDEX_FULL_PATH);
+        }
+        std::filesystem::rename(compacted_metadata, properties.METADATA_FULL_PATH);
+    } else {
+        std::filesystem::remove(compacted_index);
+    }
+    std::filesystem::remove(compacted_metadata + ".tmp");
+    std::filesystem::remove(compacted_metadata + ".build");
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::locate_data_page(const FieldType &key, bool last) -> std::streampos {
     switch (properties.ROOT_STATUS) {
         case emptyPage: {
             return emptyPage;
@@ -45,6 +117,10 @@ auto BPlusTree<TYPES()>::locate_data_page(const FieldType &key) -> std::streampo
             return properties.SEEK_ROOT;
         }
         case indexPage: {
+            if (uses_pinned_index()) {
+                return pinned_index.locate(key, last).seek_page;
+            }
+
             // iterates through the index pages and descends the B+ in order to locate the first data page
             // that may contain the key to search.
             std::streampos seek_page = properties.SEEK_ROOT;
@@ -52,10 +128,7 @@ auto BPlusTree<TYPES()>::locate_data_page(const FieldType &key) -> std::streampo
 
             do {
                 index_page.load(seek_page);
-                std::int32_t child_pos = 0;
-                while ((child_pos < index_page.len()) && gt(key, index_page.keys[child_pos])) {
-                    ++child_pos;
-                }
+                std::int32_t child_pos = last ? index_page.last_child_position(key) : index_page.child_position(key);
                 seek_page = index_page.children[child_pos];
             } while (!index_page.points_to_leaf);
 
@@ -66,6 +139,258 @@ auto BPlusTree<TYPES()>::locate_data_page(const FieldType &key) -> std::streampo
 }
 
 
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::locate_leaf_range(const FieldType &key)
+        -> std::pair<std::streampos, std::optional<FieldType>> {
+    std::optional<FieldType> upper_fence;
+    if (properties.ROOT_STATUS != indexPage) {
+        return { properties.SEEK_ROOT, upper_fence };
+    }
+    if (uses_pinned_index()) {
+        LeafLocation<FieldType> location = pinned_index.locate(key);
+        return { location.seek_page, location.upper_fence };
+    }
+
+    std::streampos seek_page = properties.SEEK_ROOT;
+    IndexPage<TYPES()> index_page(this);
+
+    do {
+        index_page.load(seek_page);
+        std::int32_t child_pos = index_page.child_position(key);
+        // separators found deeper in the tree are tighter
+        if (child_pos < static_cast<std::int32_t>(index_page.len())) {
+            upper_fence = index_page.keys[child_pos];
+        }
+        seek_page = index_page.children[child_pos];
+    } while (!index_page.points_to_leaf);
+
+    return { seek_page, upper_fence };
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::fetch_pages(const std::vector<std::int64_t> &positions, Page<TYPES()> &page) -> void {
+    if (positions.size() < 2) {
+        return;
+    }
+
+    // backends exposing the file in memory and files whose pages differ in size only get a read ahead hint
+    std::int32_t const size = page.page_size();
+    if (properties.PAGE_SIZE == 0 || storage->view(positions.front(), size, false)) {
+        for (std::int64_t pos: positions) {
+            page.prefetch(pos);
+        }
+        return;
+    }
+    buffer_pool.fetch_batch(positions, size);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::search_subtree(std::streampos seek_page,
+                                        const std::vector<FieldType> &keys,
+                                        const std::vector<std::size_t> &order,
+                                        std::size_t first,
+                                        std::size_t last,
+                                        std::vector<std::vector<RecordType>> &located_records) -> void {
+    IndexPage<TYPES()> index_page(this);
+    index_page.load(seek_page);
+
+    // the probes are sorted, so the ones routed to the same child are contiguous
+    std::vector<std::pair<std::int32_t, std::size_t>> groups;
+    for (std::size_t i = first; i < last; ++i) {
+        std::int32_t const child_pos = index_page.child_position(keys[order[i]]);
+        if (groups.empty() || groups.back().first != child_pos) {
+            groups.emplace_back(child_pos, i);
+        }
+    }
+
+    std::vector<std::int64_t> children;
+    for (auto const &[child_pos, group_first]: groups) {
+        children.push_back(index_page.children[child_pos]);
+    }
+
+    if (index_page.points_to_leaf) {
+        DataPage<TYPES()> data_page(this);
+        fetch_pages(children, data_page);
+    } else {
+        IndexPage<TYPES()> child_page(this);
+        fetch_pages(children, child_page);
+    }
+
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        std::size_t const group_last = (g + 1 < groups.size()) ? groups[g + 1].second : last;
+        if (index_page.points_to_leaf) {
+            search_leaf(children[g], keys, order, groups[g].second, group_last, located_records);
+        } else {
+            search_subtree(children[g], keys, order, groups[g].second, group_last, located_records);
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::search_leaf(std::streampos seek_page,
+                                     const std::vector<FieldType> &keys,
+                                     const std::vector<std::size_t> &order,
+                                     std::size_t first,
+                                     std::size_t last,
+                                     std::vector<std::vector<RecordType>> &located_records) -> void {
+    DataPage<TYPES()> data_page(this);
+    DataPage<TYPES()> next_page(this);
+    auto const load_leaf = [this](DataPage<TYPES()> &page, std::streampos pos) {
+        std::shared_lock<std::shared_mutex> leaf_lock(page_latch(pos));
+        page.load(pos);
+    };
+    load_leaf(data_page, seek_page);
+
+    for (std::size_t i = first; i < last; ++i) {
+        const FieldType &key = keys[order[i]];
+        std::vector<RecordType> &matches = located_records[order[i]];
+        DataPage<TYPES()> *page = &data_page;
+        auto position = static_cast<std::size_t>(data_page.lower_bound(key));
+
+        // the records with the key may continue in the following leaves
+        while (true) {
+            for (; position < page->len() && !gt(page->keys[position], key); ++position) {
+                matches.push_back(page->records[position]);
+            }
+            if (position < page->len() || page->next_leaf == emptyPage) {
+                break;
+            }
+            load_leaf(next_page, page->next_leaf);
+            page = &next_page;
+            position = 0;
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::first_data_page() -> std::streampos {
+    if (properties.ROOT_STATUS != indexPage) {
+        return properties.SEEK_ROOT;
+    }
+
+    // the leftmost path of the tree leads to the head of the leaf chain
+    std::streampos seek_page = properties.SEEK_ROOT;
+    IndexPage<TYPES()> index_page(this);
+
+    do {
+        index_page.load(seek_page);
+        seek_page = index_page.children[0];
+    } while (!index_page.points_to_leaf);
+
+    return seek_page;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::last_data_page() -> std::streampos {
+    if (properties.ROOT_STATUS != indexPage) {
+        return properties.SEEK_ROOT;
+    }
+
+    std::streampos seek_page = properties.SEEK_ROOT;
+    IndexPage<TYPES()> index_page(this);
+
+    do {
+        index_page.load(seek_page);
+        seek_page = index_page.children[index_page.len()];
+    } while (!index_page.points_to_leaf);
+
+    return seek_page;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::page_latch(std::streampos pos) -> std::shared_mutex& {
+    // positions are multiples of the page size, so they are scrambled before picking a stripe
+    auto const hash = static_cast<std::uint64_t>(static_cast<std::int64_t>(pos)) * 0x9E3779B97F4A7C15ULL;
+    return page_latches[(hash >> 32) % PAGE_LATCH_STRIPES];
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::extract_key(RecordType &record) -> FieldType {
+    return std::invoke(get_search_field, record);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::uses_pinned_index() const -> bool {
+    return properties.PINNED_INDEX && properties.ROOT_STATUS == indexPage;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::insert_in_leaf(RecordType &record, LoggedOperation &operation) -> bool {
+    if (properties.ROOT_STATUS == emptyPage || (properties.SUBTREE_COUNTS && properties.ROOT_STATUS == indexPage)) {
+        return false;
+    }
+
+    std::streampos seek_page = locate_data_page(extract_key(record));
+    std::unique_lock<std::shared_mutex> leaf_lock(page_latch(seek_page));
+
+    // a page reaching its capacity is split right away
+    DataPage<TYPES()> data_page(this);
+    data_page.load(seek_page);
+    if (!data_page.fits(record)) {
+        return false;
+    }
+
+    data_page.sorted_insert(record);
+    data_page.save(seek_page);
+    operation.append(metadata_state());
+    return true;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::remove_from_leaf(const FieldType &key, LoggedOperation &operation) -> bool {
+    if (properties.ROOT_STATUS == emptyPage || (properties.SUBTREE_COUNTS && properties.ROOT_STATUS == indexPage)) {
+        return false;
+    }
+
+    // same descent as the recursive remove, which also updates the separators equal to the key
+    std::streampos seek_page = properties.SEEK_ROOT;
+    bool const has_parent = properties.ROOT_STATUS == indexPage;
+    if (has_parent && uses_pinned_index()) {
+        LeafLocation<FieldType> location = pinned_index.locate(key);
+        if (location.separator_match) {
+            return false;
+        }
+        seek_page = location.seek_page;
+    } else if (has_parent) {
+        IndexPage<TYPES()> index_page(this);
+        do {
+            index_page.load(seek_page);
+            std::int32_t child_pos = index_page.child_position(key);
+            if (child_pos < static_cast<std::int32_t>(index_page.len()) && !gt(index_page.keys[child_pos], key)) {
+                return false;
+            }
+            seek_page = index_page.children[child_pos];
+        } while (!index_page.points_to_leaf);
+    }
+
+    std::unique_lock<std::shared_mutex> leaf_lock(page_latch(seek_page));
+
+    // the root leaf is only dropped once empty, other leaves are merged below their minimum
+    DataPage<TYPES()> data_page(this);
+    data_page.load(seek_page);
+    std::int32_t const record_pos = data_page.lower_bound(key);
+    if (record_pos == static_cast<std::int32_t>(data_page.len()) ||
+        !data_page.can_spare(record_pos, !has_parent)) {
+        return false;
+    }
+
+    data_page.remove(key);
+    data_page.save(seek_page);
+    operation.append(metadata_state());
+    return true;
+}
+
+
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::insert(std::streampos seek_page, PageType type,
                                                             RecordType &record) -> InsertResult {
@@ -75,7 +400,7 @@ auto BPlusTree<TYPES()>::insert(std::streampos seek_page, PageType type,
         data_page.load(seek_page);
         data_page.sorted_insert(record);
         data_page.save(seek_page);
-        return InsertResult { data_page.len() };
+        return InsertResult { data_page.len(), data_page.overflows() };
     }
 
     // Otherwise, the index page is iterated to locate the right child to descend the tree.
@@ -83,20 +408,25 @@ auto BPlusTree<TYPES()>::insert(std::streampos seek_page, PageType type,
     IndexPage<TYPES()> index_page(this);
     index_page.load(seek_page);
 
-    std::int32_t child_pos = 0;
-    while (child_pos < index_page.len() && gt(get_search_field(record), index_page.keys[child_pos])) {
-        ++child_pos;
-    }
+    std::int32_t child_pos = index_page.child_position(extract_key(record));
 
     auto children_type = static_cast<PageType>(index_page.points_to_leaf);
     std::streampos child_seek = index_page.children[child_pos];
     InsertResult prev_page_status = this->insert(child_seek, children_type, record);
 
+    // a split saves the parent along with its new separator
+    if (properties.SUBTREE_COUNTS) {
+        ++index_page.counts[child_pos];
+        if (!prev_page_status.overflow) {
+            index_page.save(seek_page);
+        }
+    }
+
     // Conditionally splits a page if it's full
     std::shared_ptr<Page<TYPES()>> child = nullptr;
-    if (children_type == dataPage && (prev_page_status.size == properties.MAX_DATA_PAGE_CAPACITY)) {
+    if (children_type == dataPage && prev_page_status.overflow) {
         child = std::make_shared<DataPage<TYPES()>>(this);
-    } else if (children_type == indexPage && (prev_page_status.size == properties.MAX_INDEX_PAGE_CAPACITY)) {
+    } else if (children_type == indexPage && prev_page_status.overflow) {
         child = std::make_shared<IndexPage<TYPES()>>(this);
     }
 
@@ -106,38 +436,207 @@ auto BPlusTree<TYPES()>::insert(std::streampos seek_page, PageType type,
     }
 
     // We track the current number of keys to the upcoming state, so it can handle the logic for the page split
-    return InsertResult { index_page.len() };
+    return InsertResult { index_page.len(), index_page.overflows() };
 }
 
 
 template<TYPES(typename)>
 BPlusTree<TYPES()>::BPlusTree(Property property, FieldMapping search_field, Compare greater)
-        : gt(greater), get_search_field(search_field), properties(std::move(property)) {
+        : properties(std::move(property)), buffer_pool(properties.BUFFER_POOL_CAPACITY),
+          gt(greater), get_search_field(std::move(search_field)), pinned_index(this) {
+    finish_compaction();
     open(metadata_file, properties.METADATA_FULL_PATH, std::ios::in);
 
-    // if the metadata file cannot be opened, creates the index
     if (!metadata_file.good()) {
+        // if the metadata file cannot be opened, creates the index. Both kinds of pages are padded to the same
+        // size, rounded up to the block size, so that every page starts and ends at a block boundary.
         close(metadata_file);
+        auto const block_size = static_cast<std::int32_t>(get_buffer_size());
+        std::int32_t const layout_size = std::max(DataPage<TYPES()>(this).bytes_len(),
+                                                  IndexPage<TYPES()>(this).bytes_len());
+        properties.PAGE_SIZE = (layout_size + block_size - 1) / block_size * block_size;
         create_index();
+    } else {
+        // otherwise, just loads the metadata in RAM
+        properties.load(metadata_file);
+        close(metadata_file);
+    }
+
+    persisted_state = metadata_state();
+
+    // the index file remains open for the whole lifetime of the tree
+    storage = open_storage();
+
+    // operations committed before a crash may be missing from the index and metadata files. A log left by a
+    // durable tree is replayed even if this one is not durable.
+    std::string const log_path = properties.INDEX_FULL_PATH + WAL_FILE_EXTENSION;
+    if (properties.DURABLE || std::filesystem::exists(log_path)) {
+        log = std::make_unique<WriteAheadLog>(log_path);
+        bool const replayed = log->replay(*storage, [this](const LoggedMetadata &metadata) {
+            restore_metadata(metadata);
+        });
+        if (replayed) {
+            save_metadata(true);
+        }
+        log->truncate();
+
+        if (!properties.DURABLE) {
+            log.reset();
+            std::filesystem::remove(log_path);
+        }
+    }
+
+    buffer_pool.attach(storage.get());
+
+    // a logged batch needs room for the pages of one change in half of the pool
+    if (properties.DURABLE && static_cast<std::size_t>(properties.BUFFER_POOL_CAPACITY) / 2 < change_pages()) {
+        throw BufferPoolTooSmall();
+    }
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::open_storage() -> std::unique_ptr<Storage> {
+    // pages written in place through a mapping could reach the file before their image reaches the log
+    StorageBackend backend = properties.STORAGE_BACKEND;
+    if (properties.DURABLE && backend == mmapStorage) {
+        backend = positionalStorage;
+    }
+    return make_storage(backend, properties.INDEX_FULL_PATH);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::checkpoint() -> void {
+    // the log can only be emptied once every page it covers and the metadata are durable
+    buffer_pool.flush();
+    storage->sync();
+    save_metadata(true);
+    log->truncate();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::checkpoint_if_needed() -> void {
+    if (!log || log->size() < WAL_CHECKPOINT_SIZE) {
         return;
     }
-    // otherwise, just loads the metadata in RAM
-    properties.load(metadata_file);
-    close(metadata_file);
+
+    std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (log->size() >= WAL_CHECKPOINT_SIZE) {
+        checkpoint();
+    }
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::change_pages() -> std::size_t {
+    std::size_t height = 0;
+    if (properties.ROOT_STATUS != emptyPage) {
+        height = 1;
+    }
+    if (properties.ROOT_STATUS == indexPage) {
+        std::streampos seek_page = properties.SEEK_ROOT;
+        IndexPage<TYPES()> index_page(this);
+        do {
+            index_page.load(seek_page);
+            seek_page = index_page.children[0];
+            ++height;
+        } while (!index_page.points_to_leaf);
+    }
+    return 2 * height + 3;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::count_key(const FieldType &key) -> std::size_t {
+    std::size_t count = 0;
+    std::streampos seek_page = locate_data_page(key);
+    DataPage<TYPES()> data_page(this);
+    while (seek_page != emptyPage) {
+        data_page.load(seek_page);
+        std::int32_t record_pos = data_page.lower_bound(key);
+        while (record_pos < static_cast<std::int32_t>(data_page.len()) &&
+               !gt(data_page.keys[record_pos], key)) {
+            ++count;
+            ++record_pos;
+        }
+        // records equal to the key may continue on the next leaf
+        if (record_pos < static_cast<std::int32_t>(data_page.len())) {
+            break;
+        }
+        seek_page = data_page.next_leaf;
+    }
+    return count;
+}
+
+
+template<TYPES(typename)>
+BPlusTree<TYPES()>::~BPlusTree() {
+    stats_reporter.stop();
+    flush();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::flush() -> void {
+    std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (log) {
+        checkpoint();
+        return;
+    }
+
+    buffer_pool.flush();
+    save_metadata(true);
 }
 
 
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::insert(RecordType &record) -> void {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in | std::ios::out);
+    OperationTimer timer(statistics, insertOperation);
+    bool inserted;
+    {
+        std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+        LoggedOperation operation(log.get(), &buffer_pool);
+        inserted = insert_in_leaf(record, operation);
+        if (inserted) {
+            operation.commit();
+        }
+    }
+
+    if (!inserted) {
+        std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+        LoggedOperation operation(log.get(), &buffer_pool);
+        LoggedMetadata const previous_state = metadata_state();
+        try {
+            insert_from_root(record);
+        } catch (...) {
+            // the operation puts its pages back, the metadata has to match them
+            if (log) {
+                restore_metadata(previous_state);
+            }
+            throw;
+        }
+        save_metadata();
+        operation.commit(metadata_state());
+    }
+
+    checkpoint_if_needed();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::insert_from_root(RecordType &record) -> void {
     auto root_page_type = static_cast<PageType>(properties.ROOT_STATUS);
 
     if (root_page_type == emptyPage) {
         DataPage<TYPES()> data_page(this);
+        data_page.check_size(record);
         data_page.push_back(record);
-        data_page.save(std::ios::beg);
+        std::streampos seek_root = data_page.allocate();
+        data_page.save(seek_root);
 
-        properties.SEEK_ROOT = 0;
+        properties.SEEK_ROOT = seek_root;
         properties.ROOT_STATUS = dataPage;
     } else {
         // Attempt to insert the new record into the B+ tree.
@@ -147,10 +646,10 @@ auto BPlusTree<TYPES()>::insert(RecordType &record) -> void {
         // At the end of the recursive calls generated above, we must check (as a base case) if the root page is full
         // and needs to be split.
         std::shared_ptr<Page<TYPES()>> root = nullptr;
-        if (root_page_type == dataPage && (result.size == properties.MAX_DATA_PAGE_CAPACITY)) {
+        if (root_page_type == dataPage && result.overflow) {
             root = std::make_shared<DataPage<TYPES()>>(this);
         }
-        else if (root_page_type == indexPage && (result.size == properties.MAX_INDEX_PAGE_CAPACITY)) {
+        else if (root_page_type == indexPage && result.overflow) {
             root = std::make_shared<IndexPage<TYPES()>>(this);
         }
 
@@ -159,167 +658,483 @@ auto BPlusTree<TYPES()>::insert(RecordType &record) -> void {
             root->balance_root_insert(seek_root);
         }
     }
-
-    open(metadata_file, properties.METADATA_FULL_PATH, std::ios::out);
-    properties.save(metadata_file);
-
-    close(metadata_file);
-    close(b_plus_index_file);
 }
 
 
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::search(const FieldType &key) -> std::vector<RecordType> {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in);
-    std::streampos seek_page = locate_data_page(key);
-    if (seek_page == emptyPage) {
-        return {};
-    }
-
+    OperationTimer timer(statistics, searchOperation);
     std::vector<RecordType> located_records;
-    DataPage<TYPES()> data_page(this);
+    for (RecordType &record: scan_between(key, key)) {
+        located_records.push_back(record);
+    }
+    return located_records;
+}
 
-    do {
-        data_page.load(seek_page);
 
-        for (int i = 0; i < data_page.len(); ++i) {
-            if (gt(key, get_search_field(data_page.records[i]))) {
-                continue;
-            }
-            if (gt(get_search_field(data_page.records[i]), key)) {
-                close(b_plus_index_file);
-                return located_records;
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::search_many(const std::vector<FieldType> &keys) -> std::vector<std::vector<RecordType>> {
+    OperationTimer timer(statistics, searchManyOperation);
+    std::vector<std::vector<RecordType>> located_records(keys.size());
+    std::vector<std::size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return gt(keys[b], keys[a]);
+    });
+
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (keys.empty() || properties.ROOT_STATUS == emptyPage) {
+        return located_records;
+    }
+    if (properties.ROOT_STATUS == dataPage) {
+        search_leaf(properties.SEEK_ROOT, keys, order, 0, keys.size(), located_records);
+    } else if (uses_pinned_index()) {
+        // the resident index routes every probe at once, only the leaves are read
+        std::vector<std::int64_t> leaves;
+        std::vector<std::size_t> group_firsts;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            std::int64_t const leaf = pinned_index.locate(keys[order[i]]).seek_page;
+            if (leaves.empty() || leaves.back() != leaf) {
+                leaves.push_back(leaf);
+                group_firsts.push_back(i);
             }
-            located_records.push_back(data_page.records[i]);
         }
-        seek_page = data_page.next_leaf;
-    } while (seek_page != emptyPage);
+        group_firsts.push_back(order.size());
 
-    close(b_plus_index_file);
+        DataPage<TYPES()> data_page(this);
+        fetch_pages(leaves, data_page);
+        for (std::size_t g = 0; g < leaves.size(); ++g) {
+            search_leaf(leaves[g], keys, order, group_firsts[g], group_firsts[g + 1], located_records);
+        }
+    } else {
+        search_subtree(properties.SEEK_ROOT, keys, order, 0, keys.size(), located_records);
+    }
     return located_records;
 }
 
 
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::above(const FieldType &lower_bound) -> std::vector<RecordType> {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in);
-    std::streampos seek_page = locate_data_page(lower_bound);
-    if (seek_page == emptyPage) {
-        return {};
-    }
-
+    OperationTimer timer(statistics, aboveOperation);
     std::vector<RecordType> located_records;
-    DataPage<TYPES()> data_page(this);
-
-    do {
-        data_page.load(seek_page);
-
-        for (std::int32_t i = 0; i < data_page.len(); ++i) {
-            if (gt(lower_bound, get_search_field(data_page.records[i]))) {
-                continue;
-            }
-            located_records.push_back(data_page.records[i]);
-        }
-
-        seek_page = data_page.next_leaf;
-    } while (seek_page != emptyPage);
-
-    close(b_plus_index_file);
+    for (RecordType &record: scan_above(lower_bound)) {
+        located_records.push_back(record);
+    }
     return located_records;
 }
 
 
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::below(const FieldType &upper_bound) -> std::vector<RecordType> {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in);
-    std::streampos seek_page = locate_data_page(upper_bound);
-    if (seek_page == emptyPage) {
-        return {};
+    OperationTimer timer(statistics, belowOperation);
+    std::vector<RecordType> located_records;
+    for (RecordType &record: scan_below(upper_bound)) {
+        located_records.push_back(record);
     }
+    return located_records;
+}
 
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::between(const FieldType &lower_bound,
+                                    const FieldType &upper_bound) -> std::vector<RecordType> {
+    OperationTimer timer(statistics, betweenOperation);
     std::vector<RecordType> located_records;
-    DataPage<TYPES()> data_page(this);
+    for (RecordType &record: scan_between(lower_bound, upper_bound)) {
+        located_records.push_back(record);
+    }
+    return located_records;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::scan_above(const FieldType &lower_bound, std::size_t limit) -> Cursor<TYPES()> {
+    return Cursor<TYPES()>(this, forwardScan, lower_bound, std::nullopt, limit);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::scan_below(const FieldType &upper_bound, std::size_t limit) -> Cursor<TYPES()> {
+    return Cursor<TYPES()>(this, backwardScan, std::nullopt, upper_bound, limit);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::scan_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                                      std::size_t limit) -> Cursor<TYPES()> {
+    return Cursor<TYPES()>(this, forwardScan, lower_bound, upper_bound, limit);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::scan(ScanDirection direction, std::size_t limit) -> Cursor<TYPES()> {
+    return Cursor<TYPES()>(this, direction, std::nullopt, std::nullopt, limit);
+}
+
+
+template<TYPES(typename)>
+template<typename Visitor>
+auto BPlusTree<TYPES()>::for_each_run(const FieldType &lower_bound, const FieldType &upper_bound,
+                                      Visitor &&visit) -> void {
+    Cursor<TYPES()> cursor(this, forwardScan, lower_bound, upper_bound);
+    while (cursor.valid()) {
+        auto const [first, last] = cursor.leaf_run();
+        visit(cursor.leaf(), first, last);
+        cursor.advance(last - first);
+    }
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::count_between(const FieldType &lower_bound, const FieldType &upper_bound) -> std::size_t {
+    OperationTimer timer(statistics, aggregateOperation);
+    if (properties.SUBTREE_COUNTS) {
+        if (gt(lower_bound, upper_bound)) {
+            return 0;
+        }
+        std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+        return count_before(upper_bound, true) - count_before(lower_bound, false);
+    }
+
+    std::size_t count = 0;
+    for_each_run(lower_bound, upper_bound, [&count](DataPage<TYPES()> &, std::int32_t first, std::int32_t last) {
+        count += static_cast<std::size_t>(last - first);
+    });
+    return count;
+}
+
+
+template<TYPES(typename)>
+template<typename Projection>
+auto BPlusTree<TYPES()>::sum_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                                     Projection projection) -> aggregate_sum_t<projected_t<Projection>> {
+    OperationTimer timer(statistics, aggregateOperation);
+    using Sum = aggregate_sum_t<projected_t<Projection>>;
+    Sum sum {};
+    for_each_run(lower_bound, upper_bound, [&](DataPage<TYPES()> &leaf, std::int32_t first, std::int32_t last) {
+        for (std::int32_t i = first; i < last; ++i) {
+            sum += static_cast<Sum>(std::invoke(projection, leaf.records[i]));
+        }
+    });
+    return sum;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::min_between(const FieldType &lower_bound,
+                                     const FieldType &upper_bound) -> std::optional<RecordType> {
+    OperationTimer timer(statistics, aggregateOperation);
+    Cursor<TYPES()> cursor(this, forwardScan, lower_bound, upper_bound, 1);
+    if (!cursor.valid()) {
+        return std::nullopt;
+    }
+    return cursor.record();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::max_between(const FieldType &lower_bound,
+                                     const FieldType &upper_bound) -> std::optional<RecordType> {
+    OperationTimer timer(statistics, aggregateOperation);
+    Cursor<TYPES()> cursor(this, backwardScan, lower_bound, upper_bound, 1);
+    if (!cursor.valid()) {
+        return std::nullopt;
+    }
+    return cursor.record();
+}
+
+
+template<TYPES(typename)>
+template<typename Projection>
+auto BPlusTree<TYPES()>::min_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                                     Projection projection) -> std::optional<projected_t<Projection>> {
+    OperationTimer timer(statistics, aggregateOperation);
+    std::optional<projected_t<Projection>> least;
+    for_each_run(lower_bound, upper_bound, [&](DataPage<TYPES()> &leaf, std::int32_t first, std::int32_t last) {
+        for (std::int32_t i = first; i < last; ++i) {
+            projected_t<Projection> value = std::invoke(projection, leaf.records[i]);
+            if (!least || value < *least) {
+                least = std::move(value);
+            }
+        }
+    });
+    return least;
+}
 
-    do {
-        data_page.load(seek_page);
 
-        for (std::int32_t i = data_page.len() - 1; i >= 0; --i) {
-            if (gt(get_search_field(data_page.records[i]), upper_bound)) {
-                continue;
+template<TYPES(typename)>
+template<typename Projection>
+auto BPlusTree<TYPES()>::max_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                                     Projection projection) -> std::optional<projected_t<Projection>> {
+    OperationTimer timer(statistics, aggregateOperation);
+    std::optional<projected_t<Projection>> greatest;
+    for_each_run(lower_bound, upper_bound, [&](DataPage<TYPES()> &leaf, std::int32_t first, std::int32_t last) {
+        for (std::int32_t i = first; i < last; ++i) {
+            projected_t<Projection> value = std::invoke(projection, leaf.records[i]);
+            if (!greatest || *greatest < value) {
+                greatest = std::move(value);
             }
-            located_records.push_back(data_page.records[i]);
         }
+    });
+    return greatest;
+}
 
-        seek_page = data_page.prev_leaf;
-    } while (seek_page != emptyPage);
 
-    close(b_plus_index_file);
-    return located_records;
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::require_counts() const -> void {
+    if (!properties.SUBTREE_COUNTS) {
+        throw UncountedTree();
+    }
 }
 
 
 template<TYPES(typename)>
-auto BPlusTree<TYPES()>::between(const FieldType &lower_bound,
-                                    const FieldType &upper_bound) -> std::vector<RecordType> {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in);
-    std::streampos seek_page = locate_data_page(lower_bound);
-    if (seek_page == emptyPage) {
-        return {};
+auto BPlusTree<TYPES()>::adjust_counts(const FieldType &key, std::int64_t delta) -> void {
+    if (!properties.SUBTREE_COUNTS || properties.ROOT_STATUS != indexPage) {
+        return;
     }
 
-    std::vector<RecordType> located_records;
+    // same descent as locate_leaf_range
+    std::streampos seek_page = properties.SEEK_ROOT;
+    IndexPage<TYPES()> index_page(this);
+    do {
+        index_page.load(seek_page);
+        std::int32_t const child_pos = index_page.child_position(key);
+        index_page.counts[child_pos] += delta;
+        index_page.save(seek_page);
+        seek_page = index_page.children[child_pos];
+    } while (!index_page.points_to_leaf);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::record_count() -> std::size_t {
+    switch (properties.ROOT_STATUS) {
+        case emptyPage: {
+            return 0;
+        }
+        case dataPage: {
+            std::shared_lock<std::shared_mutex> leaf_lock(page_latch(properties.SEEK_ROOT));
+            DataPage<TYPES()> data_page(this);
+            data_page.load(properties.SEEK_ROOT);
+            return data_page.len();
+        }
+        case indexPage: {
+            IndexPage<TYPES()> index_page(this);
+            index_page.load(properties.SEEK_ROOT);
+            return static_cast<std::size_t>(index_page.subtree_size());
+        }
+    }
+    throw LogicError();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::count_before(const FieldType &key, bool inclusive) -> std::size_t {
+    if (properties.ROOT_STATUS == emptyPage) {
+        return 0;
+    }
+
+    // the children before the one leading to the key only hold lesser keys, or not greater ones when inclusive
+    std::int64_t before = 0;
+    std::streampos seek_page = properties.SEEK_ROOT;
+    if (properties.ROOT_STATUS == indexPage) {
+        IndexPage<TYPES()> index_page(this);
+        do {
+            index_page.load(seek_page);
+            std::int32_t const child_pos = inclusive ? index_page.last_child_position(key)
+                                                     : index_page.child_position(key);
+            before += index_page.records_before(child_pos);
+            seek_page = index_page.children[child_pos];
+        } while (!index_page.points_to_leaf);
+    }
+
+    std::shared_lock<std::shared_mutex> leaf_lock(page_latch(seek_page));
     DataPage<TYPES()> data_page(this);
+    data_page.load(seek_page);
+    before += inclusive ? data_page.upper_bound(key) : data_page.lower_bound(key);
+    return static_cast<std::size_t>(before);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::locate_rank(std::int64_t &rank) -> std::streampos {
+    std::streampos seek_page = properties.SEEK_ROOT;
+    if (properties.ROOT_STATUS != indexPage) {
+        return seek_page;
+    }
 
+    IndexPage<TYPES()> index_page(this);
     do {
-        data_page.load(seek_page);
+        index_page.load(seek_page);
+        seek_page = index_page.children[index_page.child_at_rank(rank)];
+    } while (!index_page.points_to_leaf);
+    return seek_page;
+}
 
-        for (std::int32_t i = 0; i < data_page.len(); ++i) {
-            if (gt(lower_bound,  get_search_field(data_page.records[i]))) {
-                continue;
-            }
-            if (gt(get_search_field(data_page.records[i]), upper_bound)) {
-                close(b_plus_index_file);
-                return located_records;
-            }
-            located_records.push_back(data_page.records[i]);
+
+template<TYPES(typename)>
+template<typename Generator>
+auto BPlusTree<TYPES()>::sample_ranks(std::size_t first, std::size_t last, std::size_t count,
+                                      Generator &generator) -> std::vector<RecordType> {
+    std::vector<RecordType> sampled;
+    if (first >= last) {
+        return sampled;
+    }
+
+    std::uniform_int_distribution<std::size_t> distribution(first, last - 1);
+    std::vector<std::size_t> ranks(count);
+    for (std::size_t &rank: ranks) {
+        rank = distribution(generator);
+    }
+    std::sort(ranks.begin(), ranks.end());
+
+    // ranks falling in the same leaf share its load
+    DataPage<TYPES()> data_page(this);
+    std::streampos loaded_page = emptyPage;
+    sampled.reserve(count);
+    for (std::size_t rank: ranks) {
+        auto relative_rank = static_cast<std::int64_t>(rank);
+        std::streampos const seek_page = locate_rank(relative_rank);
+        if (seek_page != loaded_page) {
+            std::shared_lock<std::shared_mutex> leaf_lock(page_latch(seek_page));
+            data_page.load(seek_page);
+            loaded_page = seek_page;
         }
-        seek_page = data_page.next_leaf;
-    } while (seek_page != emptyPage);
+        sampled.push_back(data_page.records[relative_rank]);
+    }
+    return sampled;
+}
 
-    close(b_plus_index_file);
-    return located_records;
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::size() -> std::size_t {
+    OperationTimer timer(statistics, rankOperation);
+    require_counts();
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    return record_count();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::rank(const FieldType &key) -> std::size_t {
+    OperationTimer timer(statistics, rankOperation);
+    require_counts();
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    return count_before(key, false);
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::select(std::size_t rank) -> std::optional<RecordType> {
+    OperationTimer timer(statistics, rankOperation);
+    require_counts();
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (rank >= record_count()) {
+        return std::nullopt;
+    }
+
+    auto relative_rank = static_cast<std::int64_t>(rank);
+    std::streampos const seek_page = locate_rank(relative_rank);
+    std::shared_lock<std::shared_mutex> leaf_lock(page_latch(seek_page));
+    DataPage<TYPES()> data_page(this);
+    data_page.load(seek_page);
+    return data_page.records[relative_rank];
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::scan_from(std::size_t offset, std::size_t limit) -> Cursor<TYPES()> {
+    require_counts();
+    return Cursor<TYPES()>(this, offset, limit);
+}
+
+
+template<TYPES(typename)>
+template<typename Generator>
+auto BPlusTree<TYPES()>::sample(std::size_t count, Generator &generator) -> std::vector<RecordType> {
+    OperationTimer timer(statistics, rankOperation);
+    require_counts();
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    return sample_ranks(0, record_count(), count, generator);
+}
+
+
+template<TYPES(typename)>
+template<typename Generator>
+auto BPlusTree<TYPES()>::sample_between(const FieldType &lower_bound, const FieldType &upper_bound,
+                                        std::size_t count, Generator &generator) -> std::vector<RecordType> {
+    OperationTimer timer(statistics, rankOperation);
+    require_counts();
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (gt(lower_bound, upper_bound)) {
+        return {};
+    }
+    return sample_ranks(count_before(lower_bound, false), count_before(upper_bound, true), count, generator);
 }
 
 
 template<TYPES(typename)>
 auto BPlusTree<TYPES()>::remove(const FieldType &key) -> void {
-    open(b_plus_index_file, properties.INDEX_FULL_PATH, std::ios::in | std::ios::out);
+    OperationTimer timer(statistics, removeOperation);
+    bool removed;
+    {
+        std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+        LoggedOperation operation(log.get(), &buffer_pool);
+        removed = remove_from_leaf(key, operation);
+        if (removed) {
+            operation.commit();
+        }
+    }
+
+    if (!removed) {
+        std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+        LoggedOperation operation(log.get(), &buffer_pool);
+        LoggedMetadata const previous_state = metadata_state();
+        try {
+            remove_from_root(key);
+        } catch (...) {
+            // the operation puts its pages back, the metadata has to match them
+            if (log) {
+                restore_metadata(previous_state);
+            }
+            throw;
+        }
+        save_metadata();
+        operation.commit(metadata_state());
+    }
+
+    checkpoint_if_needed();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::remove_from_root(const FieldType &key) -> void {
     auto root_page_type = static_cast<PageType>(properties.ROOT_STATUS);
 
     if (root_page_type == emptyPage) {
-        close(b_plus_index_file);
         throw KeyNotFound();
     }
 
     std::streampos seek_root = properties.SEEK_ROOT;
     RemoveResult<FieldType> result = this->remove(seek_root, root_page_type, key);
 
-    if (result.size == 0) {
-        std::shared_ptr<Page<TYPES()>> root;
-        if (root_page_type == indexPage) {
-            root = std::make_shared<IndexPage<TYPES()>>(this);
-        } else {
-            root = std::make_shared<DataPage<TYPES()>>(this);
-        }
-        root->load(seek_root);
-        root->balance_root_remove();
+    if (!result.overflow && result.size != 0) {
+        return;
     }
 
-    open(metadata_file, properties.METADATA_FULL_PATH, std::ios::out);
-    properties.save(metadata_file);
-
-    close(metadata_file);
-    close(b_plus_index_file);
+    std::shared_ptr<Page<TYPES()>> root;
+    if (root_page_type == indexPage) {
+        root = std::make_shared<IndexPage<TYPES()>>(this);
+    } else {
+        root = std::make_shared<DataPage<TYPES()>>(this);
+    }
+    root->load(seek_root);
+    if (result.overflow) {
+        root->balance_root_insert(seek_root);
+    } else {
+        root->balance_root_remove();
+    }
 }
 
 
@@ -331,25 +1146,29 @@ auto BPlusTree<TYPES()>::remove(std::streampos seek_page, PageType type,
         data_page.load(seek_page);
         std::shared_ptr<FieldType> predecessor = data_page.remove(key);
         data_page.save(seek_page);
-        return RemoveResult<FieldType> { data_page.len(), predecessor };
+        // the records of a compressed page may take more space once one of them is gone
+        return RemoveResult<FieldType> { data_page.len(), predecessor, data_page.overflows() };
     }
 
     IndexPage<TYPES()> index_page(this);
     index_page.load(seek_page);
 
-    std::int32_t child_pos = 0;
-    while (child_pos < index_page.len() && gt(key, index_page.keys[child_pos])) {
-        ++child_pos;
-    }
+    std::int32_t child_pos = index_page.child_position(key);
 
     auto children_type = static_cast<PageType>(index_page.points_to_leaf);
     std::streampos child_seek = index_page.children[child_pos];
     RemoveResult<FieldType> result = this->remove(child_seek, children_type, key);
 
+    if (properties.SUBTREE_COUNTS) {
+        --index_page.counts[child_pos];
+    }
+
     if (child_pos < index_page.len() && result.predecessor && !gt(index_page.keys[child_pos], key)) {
         index_page.keys[child_pos] = *result.predecessor;
         index_page.save(seek_page);
         result.predecessor = nullptr;
+    } else if (properties.SUBTREE_COUNTS) {
+        index_page.save(seek_page);
     }
 
     std::shared_ptr<Page<TYPES()>> child;
@@ -360,6 +1179,385 @@ auto BPlusTree<TYPES()>::remove(std::streampos seek_page, PageType type,
     }
 
     child->load(child_seek);
-    child->balance_page_remove(seek_page, index_page, child_pos);
-    return RemoveResult<FieldType> { index_page.len(), result.predecessor };
+    if (result.overflow) {
+        child->balance_page_insert(seek_page, index_page, child_pos);
+    } else {
+        child->balance_page_remove(seek_page, index_page, child_pos);
+    }
+    return RemoveResult<FieldType> { index_page.len(), result.predecessor, index_page.overflows() };
+}
+
+
+template<TYPES(typename)>
+template<typename Iterator>
+auto BPlusTree<TYPES()>::insert_many(Iterator first, Iterator last) -> void {
+    OperationTimer timer(statistics, insertManyOperation);
+    // records with the same key keep their order in the batch
+    std::vector<std::pair<FieldType, RecordType>> keyed;
+    for (; first != last; ++first) {
+        RecordType record = *first;
+        keyed.emplace_back(extract_key(record), std::move(record));
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [this](const auto &a, const auto &b) {
+        return gt(b.first, a.first);
+    });
+    std::vector<RecordType> records;
+    records.reserve(keyed.size());
+    for (auto &[key, record]: keyed) {
+        records.push_back(std::move(record));
+    }
+
+    // every record is checked before the first one is inserted, so an oversized one leaves the tree untouched
+    DataPage<TYPES()> size_check(this);
+    for (RecordType &record: records) {
+        size_check.check_size(record);
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+        std::optional<LoggedOperation> operation(std::in_place, log.get(), &buffer_pool);
+
+        // staged pages are pinned until committed, so long batches are logged in several operations. Each step
+        // starts a new one unless the pages it may write still fit in half of the pool.
+        std::size_t const budget = static_cast<std::size_t>(properties.BUFFER_POOL_CAPACITY) / 2;
+        std::size_t step_pages = change_pages();
+        std::int64_t seek_root = properties.SEEK_ROOT;
+
+        LoggedMetadata committed_state = metadata_state();
+        try {
+            std::size_t i = 0;
+            while (i < records.size()) {
+                if (operation->pending() + step_pages > budget) {
+                    operation->commit(metadata_state());
+                    operation.emplace(log.get(), &buffer_pool);
+                    committed_state = metadata_state();
+                }
+                // the records inserted so far stay committed
+                if (log && step_pages > budget) {
+                    throw BufferPoolTooSmall();
+                }
+
+                if (properties.ROOT_STATUS == emptyPage) {
+                    insert_from_root(records[i++]);
+                    seek_root = properties.SEEK_ROOT;
+                    step_pages = change_pages();
+                    continue;
+                }
+
+                auto [seek_page, upper_fence] = locate_leaf_range(extract_key(records[i]));
+                auto const routed_here = [&, fence = upper_fence](std::size_t j) {
+                    return j < records.size() && !(fence && gt(extract_key(records[j]), *fence));
+                };
+
+                // the leaf is filled up to one record below its capacity, reaching it would split the page
+                DataPage<TYPES()> data_page(this);
+                data_page.load(seek_page);
+                std::size_t const first_record = i;
+                while (routed_here(i) && data_page.fits(records[i])) {
+                    data_page.sorted_insert(records[i++]);
+                }
+                if (i > first_record) {
+                    data_page.save(seek_page);
+                    adjust_counts(extract_key(records[first_record]), static_cast<std::int64_t>(i - first_record));
+                }
+
+                // the leaf is full while records still belong to it, the regular insert splits it
+                if (i == first_record) {
+                    insert_from_root(records[i++]);
+                }
+
+                // the tree only grows when the root moves
+                if (properties.SEEK_ROOT != seek_root) {
+                    seek_root = properties.SEEK_ROOT;
+                    step_pages = change_pages();
+                }
+            }
+        } catch (...) {
+            // the current operation puts its pages back, the metadata has to match them
+            if (log) {
+                restore_metadata(committed_state);
+            }
+            throw;
+        }
+
+        save_metadata();
+        operation->commit(metadata_state());
+    }
+
+    checkpoint_if_needed();
+}
+
+
+template<TYPES(typename)>
+template<typename Iterator>
+auto BPlusTree<TYPES()>::remove_many(Iterator first, Iterator last) -> void {
+    OperationTimer timer(statistics, removeManyOperation);
+    std::vector<FieldType> keys(first, last);
+    std::sort(keys.begin(), keys.end(), [this](const FieldType &a, const FieldType &b) {
+        return gt(b, a);
+    });
+
+    {
+        std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+
+        // every key is checked before the first one is removed
+        for (std::size_t i = 0; i < keys.size();) {
+            std::size_t j = i + 1;
+            while (j < keys.size() && !gt(keys[j], keys[i])) {
+                ++j;
+            }
+            if (count_key(keys[i]) < j - i) {
+                throw KeyNotFound();
+            }
+            i = j;
+        }
+
+        std::optional<LoggedOperation> operation(std::in_place, log.get(), &buffer_pool);
+        std::size_t const budget = static_cast<std::size_t>(properties.BUFFER_POOL_CAPACITY) / 2;
+        std::size_t step_pages = change_pages();
+        if (log && step_pages > budget) {
+            throw BufferPoolTooSmall();
+        }
+        std::int64_t seek_root = properties.SEEK_ROOT;
+
+        LoggedMetadata committed_state = metadata_state();
+        try {
+            std::size_t i = 0;
+            while (i < keys.size()) {
+                if (operation->pending() + step_pages > budget) {
+                    operation->commit(metadata_state());
+                    operation.emplace(log.get(), &buffer_pool);
+                    committed_state = metadata_state();
+                }
+
+                auto [seek_page, upper_fence] = locate_leaf_range(keys[i]);
+                bool const is_root = properties.ROOT_STATUS != indexPage;
+
+                // keys equal to the fence are separators as well, they are left to the regular remove along with
+                // the keys found on a later leaf
+                DataPage<TYPES()> data_page(this);
+                data_page.load(seek_page);
+                std::size_t const first_key = i;
+                while (i < keys.size()) {
+                    if (upper_fence && !gt(*upper_fence, keys[i])) {
+                        break;
+                    }
+                    std::int32_t const record_pos = data_page.lower_bound(keys[i]);
+                    if (record_pos == static_cast<std::int32_t>(data_page.len()) ||
+                        gt(data_page.keys[record_pos], keys[i]) || !data_page.can_spare(record_pos, is_root)) {
+                        break;
+                    }
+                    data_page.remove(keys[i++]);
+                }
+                if (i > first_key) {
+                    data_page.save(seek_page);
+                    adjust_counts(keys[first_key], -static_cast<std::int64_t>(i - first_key));
+                }
+
+                // the leaf would underflow, or the key needs the regular remove
+                if (i == first_key) {
+                    remove_from_root(keys[i++]);
+                }
+
+                // the tree only shrinks when the root moves
+                if (properties.SEEK_ROOT != seek_root) {
+                    seek_root = properties.SEEK_ROOT;
+                    step_pages = change_pages();
+                }
+            }
+        } catch (...) {
+            // the current operation puts its pages back, the metadata has to match them
+            if (log) {
+                restore_metadata(committed_state);
+            }
+            throw;
+        }
+
+        save_metadata();
+        operation->commit(metadata_state());
+    }
+
+    checkpoint_if_needed();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::buffer_pool_stats() const -> BufferPoolStats {
+    return buffer_pool.stats();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::stats(bool survey_pages) -> TreeStats {
+    // the counters are read first, so they leave out the pages read below
+    TreeStats stats {};
+    statistics.snapshot(stats);
+    stats.buffer_pool = buffer_pool.stats();
+
+    std::shared_lock<std::shared_mutex> tree_lock(tree_latch);
+    stats.file_size = storage->size();
+
+    // the index levels are walked top-down, only along the leftmost path unless the pages are surveyed
+    std::vector<std::int64_t> level;
+    if (properties.ROOT_STATUS != emptyPage) {
+        level.push_back(properties.SEEK_ROOT);
+    }
+    bool reached_leaves = properties.ROOT_STATUS == dataPage;
+    double index_fill = 0;
+    IndexPage<TYPES()> index_page(this);
+
+    while (!level.empty() && !reached_leaves) {
+        ++stats.height;
+        std::vector<std::int64_t> next_level;
+        for (std::int64_t pos: level) {
+            index_page.load(pos);
+            reached_leaves = index_page.points_to_leaf;
+            if (!survey_pages) {
+                next_level.push_back(index_page.children[0]);
+                break;
+            }
+            ++stats.index_pages;
+            index_fill += index_page.occupancy();
+            next_level.insert(next_level.end(), index_page.children.begin(),
+                              index_page.children.begin() + static_cast<std::ptrdiff_t>(index_page.len()) + 1);
+        }
+        level = std::move(next_level);
+    }
+
+    if (level.empty()) {
+        return stats;
+    }
+    ++stats.height;
+
+    if (survey_pages) {
+        double data_fill = 0;
+        DataPage<TYPES()> data_page(this);
+        for (std::int64_t pos: level) {
+            std::shared_lock<std::shared_mutex> leaf_lock(page_latch(pos));
+            data_page.load(pos);
+            data_fill += data_page.occupancy();
+        }
+        stats.data_pages = static_cast<std::int64_t>(level.size());
+        stats.data_page_fill = data_fill / static_cast<double>(stats.data_pages);
+        if (stats.index_pages > 0) {
+            stats.index_page_fill = index_fill / static_cast<double>(stats.index_pages);
+        }
+    }
+    return stats;
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::dump_stats(std::chrono::milliseconds period, std::ostream &out) -> void {
+    stats_reporter.start(period, [this, &out] {
+        TreeStats snapshot = stats();
+        out << snapshot << std::flush;
+    });
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::stop_stats_dump() -> void {
+    stats_reporter.stop();
+}
+
+
+template<TYPES(typename)>
+template<typename Iterator>
+auto BPlusTree<TYPES()>::bulk_load(Iterator first, Iterator last, double fill_factor) -> void {
+    OperationTimer timer(statistics, bulkLoadOperation);
+    std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+    if (properties.ROOT_STATUS != emptyPage) {
+        throw NotEmptyIndex();
+    }
+
+    BulkLoader<TYPES()> loader(this, fill_factor);
+    for (; first != last; ++first) {
+        RecordType record = *first;
+        loader.push(record);
+    }
+
+    loader.finish();
+    if (log) {
+        checkpoint();
+    }
+    save_metadata();
+}
+
+
+template<TYPES(typename)>
+auto BPlusTree<TYPES()>::compact(double fill_factor) -> void {
+    OperationTimer timer(statistics, compactOperation);
+    std::unique_lock<std::shared_mutex> tree_lock(tree_latch);
+    // The compacted tree is built next to the current one and replaces it once complete. The metadata written
+    // by the temporary tree is not the final one, so it is kept apart.
+    Property compacted_properties = properties;
+    compacted_properties.INDEX_FULL_PATH = properties.INDEX_FULL_PATH + COMPACT_FILE_EXTENSION;
+    compacted_properties.METADATA_FULL_PATH = properties.METADATA_FULL_PATH + COMPACT_FILE_EXTENSION + ".build";
+    std::string const compacted_metadata = properties.METADATA_FULL_PATH + COMPACT_FILE_EXTENSION;
+    compacted_properties.SEEK_ROOT = emptyPage;
+    compacted_properties.ROOT_STATUS = emptyPage;
+    compacted_properties.FREE_DATA_PAGE_HEAD = emptyPage;
+    compacted_properties.FREE_INDEX_PAGE_HEAD = emptyPage;
+    compacted_properties.DURABLE = false;
+    std::filesystem::remove(compacted_properties.METADATA_FULL_PATH);
+
+    // the log must not hold images of the file about to be replaced
+    if (log) {
+        checkpoint();
+    }
+
+    {
+        BPlusTree<TYPES()> compacted(compacted_properties, get_search_field, gt);
+        BulkLoader<TYPES()> loader(&compacted, fill_factor);
+
+        std::streampos seek_page = first_data_page();
+        if (seek_page != emptyPage) {
+            DataPage<TYPES()> data_page(this);
+            data_page.load(seek_page);
+
+            while (true) {
+                for (std::int32_t i = 0; i < data_page.len(); ++i) {
+                    loader.push(data_page.records[i]);
+                }
+                if (data_page.next_leaf == emptyPage) {
+                    break;
+                }
+                data_page.load(data_page.next_leaf);
+            }
+        }
+
+        loader.finish();
+        properties.SEEK_ROOT = compacted.properties.SEEK_ROOT;
+        properties.ROOT_STATUS = compacted.properties.ROOT_STATUS;
+        properties.PAGE_SIZE = compacted.properties.PAGE_SIZE;
+        properties.FREE_DATA_PAGE_HEAD = emptyPage;
+        properties.FREE_INDEX_PAGE_HEAD = emptyPage;
+    }
+
+    // Every frame belongs to the old file, so they are dropped with it
+    buffer_pool.attach(nullptr);
+    storage.reset();
+    std::filesystem::remove(compacted_properties.METADATA_FULL_PATH);
+
+    // The compaction is complete once the new metadata is in place next to the new index file. The index file
+    // is renamed before the metadata file, and finish_compaction() completes the renames if they are interrupted.
+    if (log) {
+        sync_file(compacted_properties.INDEX_FULL_PATH);
+    }
+    replace_metadata(compacted_metadata);
+    if (log) {
+        sync_file(properties.DIRECTORY_PATH);
+    }
+    std::filesystem::rename(compacted_properties.INDEX_FULL_PATH, properties.INDEX_FULL_PATH);
+    std::filesystem::rename(compacted_metadata, properties.METADATA_FULL_PATH);
+    if (log) {
+        sync_file(properties.DIRECTORY_PATH);
+    }
+    persisted_state = metadata_state();
+
+    storage = open_storage();
+    buffer_pool.attach(storage.get());
+    pinned_index.invalidate();
+    ++version;
 }
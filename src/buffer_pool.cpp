@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cstring>
+
+#include "buffer_pool.hpp"
+#include "error_handler.hpp"
+
+
+BufferPool::BufferPool(std::size_t capacity)
+        : storage(nullptr), capacity(std::max<std::size_t>(capacity, 1)), clock_hand(0), end_of_file(-1),
+          statistics() {
+    frames.reserve(this->capacity);
+}
+
+
+auto BufferPool::attach(Storage *new_storage) -> void {
+    clear();
+    std::lock_guard<std::mutex> lock(latch);
+    storage = new_storage;
+}
+
+
+auto BufferPool::file_end() -> std::int64_t {
+    // Pages written around the pool (e.g. through a storage view) also move the end of the file
+    end_of_file = std::max(end_of_file, storage->size());
+    return end_of_file;
+}
+
+
+auto BufferPool::victim() -> std::size_t {
+    // the frames are reserved upfront, so pushing one never moves those handed out to other threads
+    if (frames.size() < capacity) {
+        frames.push_back(Frame { -1, {}, 0, false, false, false });
+        return frames.size() - 1;
+    }
+
+    // Two full turns of the clock are enough to clear every reference bit
+    for (std::size_t step = 0; step < 2 * capacity; ++step) {
+        Frame &frame = frames[clock_hand];
+        std::size_t const current = clock_hand;
+        clock_hand = (clock_hand + 1) % capacity;
+
+        if (frame.pin_count > 0) {
+            continue;
+        }
+        if (frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+
+        if (frame.dirty) {
+            write_behind(current);
+        }
+        page_table.erase(frame.pos);
+        ++statistics.evictions;
+        return current;
+    }
+
+    throw BufferPoolExhausted();
+}
+
+
+auto BufferPool::fetch(Frame &frame) -> void {
+    std::size_t const bytes_read = storage->read(frame.pos, frame.data.data(), frame.data.size());
+
+    // Bytes past the end of the file belong to a page that was never written
+    std::fill(frame.data.begin() + static_cast<std::int64_t>(bytes_read), frame.data.end(), 0);
+}
+
+
+auto BufferPool::write_back(Frame &frame) -> void {
+    storage->write(frame.pos, frame.data.data(), frame.data.size());
+    frame.dirty = false;
+    ++statistics.write_backs;
+}
+
+
+auto BufferPool::write_back(std::vector<Frame*> &dirty_frames) -> void {
+    std::sort(dirty_frames.begin(), dirty_frames.end(), [](const Frame *a, const Frame *b) {
+        return a->pos < b->pos;
+    });
+
+    std::vector<IORequest> requests;
+    requests.reserve(dirty_frames.size());
+    for (Frame *frame: dirty_frames) {
+        requests.push_back(IORequest { frame->pos, frame->data.data(), frame->data.size() });
+    }
+    storage->write_batch(requests);
+
+    for (Frame *frame: dirty_frames) {
+        frame->dirty = false;
+        ++statistics.write_backs;
+    }
+}
+
+
+auto BufferPool::write_behind(std::size_t first) -> void {
+    std::vector<Frame*> dirty_frames;
+    for (std::size_t step = 0; step < capacity && dirty_frames.size() < WRITE_BACK_BATCH; ++step) {
+        Frame &frame = frames[(first + step) % capacity];
+        if (frame.dirty && frame.pin_count == 0) {
+            dirty_frames.push_back(&frame);
+        }
+    }
+    write_back(dirty_frames);
+}
+
+
+auto BufferPool::claim(std::int64_t pos, std::size_t size, bool loading) -> Frame& {
+    ++statistics.misses;
+    std::size_t const frame_id = victim();
+    Frame &frame = frames[frame_id];
+    frame.pos = pos;
+    frame.data.resize(size);
+    frame.pin_count = 1;
+    frame.dirty = false;
+    frame.referenced = true;
+    frame.loading = loading;
+
+    page_table[pos] = frame_id;
+    end_of_file = std::max(end_of_file, pos + static_cast<std::int64_t>(size));
+    return frame;
+}
+
+
+auto BufferPool::finish_loading(Frame &frame) -> void {
+    frame.loading = false;
+    loaded.notify_all();
+}
+
+
+auto BufferPool::pin(std::int64_t pos, std::size_t size, bool load) -> char* {
+    std::unique_lock<std::mutex> lock(latch);
+    end_of_file = std::max(end_of_file, pos + static_cast<std::int64_t>(size));
+
+    auto iter = page_table.find(pos);
+    while (iter != page_table.end() && frames[iter->second].loading) {
+        loaded.wait(lock);
+        iter = page_table.find(pos);
+    }
+
+    if (iter != page_table.end()) {
+        Frame &frame = frames[iter->second];
+
+        // The same offset may be read through a different page layout, but the frame cannot be resized under
+        // the pointers handed out for it
+        if (frame.data.size() != size) {
+            if (frame.pin_count > 0) {
+                throw FrameInUse();
+            }
+            if (frame.dirty) {
+                write_back(frame);
+            }
+            frame.data.resize(size);
+            if (load) {
+                fetch(frame);
+            }
+        }
+
+        ++statistics.hits;
+        ++frame.pin_count;
+        frame.referenced = true;
+        return frame.data.data();
+    }
+
+    Frame &frame = claim(pos, size, load);
+    if (load) {
+        // the frame is pinned and marked as loading, so it can be read without the latch
+        lock.unlock();
+        fetch(frame);
+        lock.lock();
+        finish_loading(frame);
+    }
+    return frame.data.data();
+}
+
+
+auto BufferPool::unpin(std::int64_t pos, bool dirty) -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    auto iter = page_table.find(pos);
+    if (iter == page_table.end()) {
+        return;
+    }
+
+    Frame &frame = frames[iter->second];
+    if (frame.pin_count > 0) {
+        --frame.pin_count;
+    }
+    frame.dirty = frame.dirty || dirty;
+}
+
+
+auto BufferPool::prefetch(std::int64_t pos, std::size_t size) -> void {
+    {
+        std::lock_guard<std::mutex> lock(latch);
+        if (page_table.contains(pos)) {
+            return;
+        }
+        ++statistics.prefetches;
+    }
+    storage->prefetch(pos, size);
+}
+
+
+auto BufferPool::fetch_batch(const std::vector<std::int64_t> &positions, std::size_t size) -> void {
+    std::unique_lock<std::mutex> lock(latch);
+    std::vector<Frame*> batch_frames;
+    std::vector<IORequest> requests;
+    for (std::int64_t pos: positions) {
+        if (page_table.contains(pos)) {
+            continue;
+        }
+        // the rest of the pool is left for the pages that are pinned meanwhile, missing pages are read on demand
+        if (requests.size() >= capacity / 2) {
+            break;
+        }
+
+        // frames of the batch stay pinned until every read is done, so they cannot evict each other
+        Frame &frame = claim(pos, size, true);
+        batch_frames.push_back(&frame);
+        requests.push_back(IORequest { pos, frame.data.data(), size });
+    }
+
+    lock.unlock();
+    storage->read_batch(requests);
+    lock.lock();
+
+    for (Frame *frame: batch_frames) {
+        --frame->pin_count;
+        finish_loading(*frame);
+    }
+}
+
+
+auto BufferPool::allocate(std::size_t size) -> std::int64_t {
+    std::lock_guard<std::mutex> lock(latch);
+    std::int64_t const pos = file_end();
+    end_of_file += static_cast<std::int64_t>(size);
+    return pos;
+}
+
+
+auto BufferPool::write_back_dirty() -> void {
+    // Writes dirty frames in file order, so that appended pages never leave holes behind
+    std::vector<Frame*> dirty_frames;
+    for (Frame &frame: frames) {
+        if (frame.dirty) {
+            dirty_frames.push_back(&frame);
+        }
+    }
+
+    write_back(dirty_frames);
+}
+
+
+auto BufferPool::flush() -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    write_back_dirty();
+    storage->flush();
+}
+
+
+auto BufferPool::clear() -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    if (storage != nullptr) {
+        write_back_dirty();
+    }
+    frames.clear();
+    page_table.clear();
+    clock_hand = 0;
+    end_of_file = -1;
+}
+
+
+auto BufferPool::stats() const -> BufferPoolStats {
+    std::lock_guard<std::mutex> lock(latch);
+    return statistics;
+}
@@ -0,0 +1,236 @@
+#include "bulk_loader.hpp"
+
+
+template<TYPES(typename)>
+BulkLoader<TYPES()>::BulkLoader(BPlusTree<TYPES()> *tree, double fill_factor)
+        : tree(tree), previous(tree), current(tree), previous_seek(emptyPage), current_bytes(0) {
+    leaf_target = fill_target(tree->properties.MAX_DATA_PAGE_CAPACITY,
+                              tree->properties.MIN_DATA_PAGE_CAPACITY, fill_factor);
+    children_target = fill_target(tree->properties.MAX_INDEX_PAGE_CAPACITY,
+                                  tree->properties.MIN_INDEX_PAGE_CAPACITY, fill_factor) + 1;
+
+    // a page filled below its minimum occupancy plus one entry could end up under it
+    auto const bytes_target = [fill_factor](Page<TYPES()> &page) {
+        auto const target = static_cast<std::int32_t>(std::lround(fill_factor * page.high_water()));
+        return std::clamp(target, page.low_water() + page.entry_limit(), page.high_water());
+    };
+    leaf_bytes_target = bytes_target(current);
+    IndexPage<TYPES()> index_page(tree);
+    index_bytes_target = bytes_target(index_page);
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::fill_target(std::int32_t max_capacity, std::int32_t min_capacity,
+                                      double fill_factor) -> std::size_t {
+    // a page holding its maximum capacity is split right away, so a stable page keeps at most one slot free
+    auto const target = static_cast<std::int32_t>(std::lround(fill_factor * (max_capacity - 1)));
+    return std::clamp(target, std::max(min_capacity, 1), std::max(max_capacity - 1, 1));
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::distribute(std::size_t items, std::size_t target,
+                                     std::size_t minimum) -> std::vector<std::size_t> {
+    std::size_t groups = (items + target - 1) / target;
+    while (groups > 1 && items / groups < minimum) {
+        --groups;
+    }
+
+    std::vector<std::size_t> sizes(groups, items / groups);
+    for (std::size_t i = 0; i < items % groups; ++i) {
+        ++sizes[i];
+    }
+    return sizes;
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::write_leaf(DataPage<TYPES()> &leaf, std::int64_t seek_leaf,
+                                     const FieldType *next_key) -> void {
+    leaf.save(seek_leaf);
+    FieldType const &last_key = leaf.keys[leaf.len() - 1];
+    level.emplace_back(seek_leaf, next_key ? SeparatorTruncation<FieldType, Compare>::between(last_key, *next_key)
+                                           : last_key);
+    level_counts.push_back(static_cast<std::int64_t>(leaf.len()));
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::leaf_complete(const RecordType &record) -> bool {
+    if (!current.byte_bounded()) {
+        return current.len() == leaf_target;
+    }
+    if (current.is_empty()) {
+        return false;
+    }
+    return static_cast<std::int32_t>(current.len()) + 1 >= tree->properties.MAX_DATA_PAGE_CAPACITY ||
+           current_bytes + current.insert_size(static_cast<std::int32_t>(current.len()), record) > leaf_bytes_target;
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::push(RecordType &record) -> void {
+    FieldType key = tree->extract_key(record);
+    if (last_key && tree->gt(*last_key, key)) {
+        throw UnsortedInput();
+    }
+    last_key = key;
+    current.check_size(record);
+
+    if (leaf_complete(record)) {
+        std::int64_t const current_seek = current.allocate();
+        if (previous_seek != emptyPage) {
+            previous.next_leaf = current_seek;
+            write_leaf(previous, previous_seek, &current.keys[0]);
+        }
+
+        current.prev_leaf = previous_seek;
+        previous = current;
+        previous_seek = current_seek;
+        current.num_records = 0;
+        current_bytes = 0;
+    }
+
+    current_bytes += current.insert_size(static_cast<std::int32_t>(current.len()), record);
+    current.push_back(record);
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::finish() -> void {
+    if (previous_seek == emptyPage && current.is_empty()) {
+        return;
+    }
+
+    if (previous_seek != emptyPage && current.underflows()) {
+        auto const max_capacity = static_cast<std::size_t>(tree->properties.MAX_DATA_PAGE_CAPACITY);
+        bool fits_previous = previous.len() + current.len() < max_capacity;
+        if (current.byte_bounded()) {
+            fits_previous = fits_previous && previous.merged_size(current) <= previous.high_water();
+        }
+
+        if (fits_previous) {
+            previous.merge(current);
+            current.num_records = 0;
+        } else if (!current.byte_bounded()) {
+            while (previous.len() > current.len() + 1) {
+                RecordType record = previous.pop_back();
+                current.push_front(record);
+            }
+        } else {
+            while (current.underflows() && previous.can_spare(previous.len() - 1)) {
+                RecordType record = previous.pop_back();
+                current.push_front(record);
+            }
+        }
+    }
+
+    if (!current.is_empty()) {
+        std::int64_t const current_seek = current.allocate();
+        if (previous_seek != emptyPage) {
+            previous.next_leaf = current_seek;
+            write_leaf(previous, previous_seek, &current.keys[0]);
+        }
+
+        current.prev_leaf = previous_seek;
+        current.next_leaf = emptyPage;
+        write_leaf(current, current_seek, nullptr);
+    } else {
+        previous.next_leaf = emptyPage;
+        write_leaf(previous, previous_seek, nullptr);
+    }
+
+    tree->properties.ROOT_STATUS = dataPage;
+    build_index_levels();
+    tree->properties.SEEK_ROOT = level[0].first;
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::group_by_size() -> std::vector<std::size_t> {
+    // the separator before a child is the greatest key of the previous one
+    bool const counted = tree->properties.SUBTREE_COUNTS;
+    auto const payload = [this, counted](std::size_t first, std::size_t children) {
+        std::int32_t size = IndexPage<TYPES()>::child_size(counted);
+        for (std::size_t child = first; child + 1 < first + children; ++child) {
+            size += IndexPage<TYPES()>::entry_size(level[child].second, counted);
+        }
+        return size;
+    };
+
+    auto const max_children = static_cast<std::size_t>(tree->properties.MAX_INDEX_PAGE_CAPACITY);
+    std::vector<std::size_t> sizes;
+    std::size_t first = 0;
+    std::size_t children = 1;
+    std::int32_t size = IndexPage<TYPES()>::child_size(counted);
+    for (std::size_t child = 1; child < level.size(); ++child) {
+        std::int32_t const entry = IndexPage<TYPES()>::entry_size(level[child - 1].second, counted);
+        if (size + entry > index_bytes_target || children + 1 > max_children) {
+            sizes.push_back(children);
+            first = child;
+            children = 1;
+            size = IndexPage<TYPES()>::child_size(counted);
+        } else {
+            size += entry;
+            ++children;
+        }
+    }
+    sizes.push_back(children);
+
+    // the last page is merged into the previous one or takes children from it until it reaches its minimum
+    IndexPage<TYPES()> index_page(tree);
+    if (sizes.size() > 1 && payload(first, sizes.back()) < index_page.low_water()) {
+        std::size_t const previous_first = first - sizes[sizes.size() - 2];
+        std::size_t const merged = sizes[sizes.size() - 2] + sizes.back();
+        if (merged <= max_children && payload(previous_first, merged) <= index_page.high_water()) {
+            sizes.pop_back();
+            sizes.back() = merged;
+        } else {
+            while (payload(first, sizes.back()) < index_page.low_water() &&
+                   payload(previous_first, sizes[sizes.size() - 2] - 1) >= index_page.low_water()) {
+                --sizes[sizes.size() - 2];
+                ++sizes.back();
+                --first;
+            }
+        }
+    }
+    return sizes;
+}
+
+
+template<TYPES(typename)>
+auto BulkLoader<TYPES()>::build_index_levels() -> void {
+    std::size_t const children_minimum = tree->properties.MIN_INDEX_PAGE_CAPACITY + 1;
+    bool points_to_leaf = true;
+
+    while (level.size() > 1) {
+        std::vector<std::pair<std::int64_t, FieldType>> parents;
+        std::vector<std::int64_t> parent_counts;
+        std::size_t child = 0;
+
+        std::vector<std::size_t> const group_sizes = IndexPage<TYPES()>::fixed_layout
+                ? distribute(level.size(), children_target, children_minimum)
+                : group_by_size();
+
+        for (std::size_t const group_size: group_sizes) {
+            IndexPage<TYPES()> index_page(tree, points_to_leaf);
+            index_page.children[0] = level[child].first;
+            index_page.counts[0] = level_counts[child];
+            for (std::size_t i = 1; i < group_size; ++i) {
+                index_page.push_back(level[child + i - 1].second, level[child + i].first, level_counts[child + i]);
+            }
+
+            std::int64_t const index_page_seek = index_page.allocate();
+            index_page.save(index_page_seek);
+            parents.emplace_back(index_page_seek, level[child + group_size - 1].second);
+            parent_counts.push_back(index_page.subtree_size());
+            child += group_size;
+        }
+
+        level.swap(parents);
+        level_counts.swap(parent_counts);
+        points_to_leaf = false;
+        tree->properties.ROOT_STATUS = indexPage;
+    }
+}
@@ -0,0 +1,295 @@
+#include "cursor.hpp"
+
+
+template<TYPES(typename)>
+Cursor<TYPES()>::Cursor(BPlusTree<TYPES()> *tree,
+                        ScanDirection direction,
+                        std::optional<FieldType> lower_bound,
+                        std::optional<FieldType> upper_bound,
+                        std::size_t limit)
+        : tree(tree), page(tree), seek_page(emptyPage), position(0), direction(direction),
+          lower_bound(std::move(lower_bound)), upper_bound(std::move(upper_bound)), remaining(limit),
+          next_upcoming(0), prefetched(0), sequential_steps(0), version(tree->version), last_key_count(0) {
+    std::shared_lock<std::shared_mutex> tree_lock(tree->tree_latch);
+    if (direction == forwardScan) {
+        load(this->lower_bound ? tree->locate_data_page(*this->lower_bound) : tree->first_data_page());
+    } else {
+        load(this->upper_bound ? tree->locate_data_page(*this->upper_bound, true) : tree->last_data_page());
+    }
+
+    if (seek_page == emptyPage) {
+        return;
+    }
+
+    if (direction == forwardScan) {
+        position = this->lower_bound ? page.lower_bound(*this->lower_bound) : 0;
+    } else {
+        position = (this->upper_bound ? page.upper_bound(*this->upper_bound) : page.len()) - 1;
+    }
+    settle();
+}
+
+
+template<TYPES(typename)>
+Cursor<TYPES()>::Cursor(BPlusTree<TYPES()> *tree, std::size_t offset, std::size_t limit)
+        : tree(tree), page(tree), seek_page(emptyPage), position(0), direction(forwardScan), remaining(limit),
+          next_upcoming(0), prefetched(0), sequential_steps(0), version(tree->version), last_key_count(0) {
+    std::shared_lock<std::shared_mutex> tree_lock(tree->tree_latch);
+    if (offset >= tree->record_count()) {
+        return;
+    }
+
+    auto rank = static_cast<std::int64_t>(offset);
+    load(tree->locate_rank(rank));
+    position = static_cast<std::int32_t>(rank);
+    settle();
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::load(std::int64_t seek) -> void {
+    seek_page = seek;
+    if (seek_page != emptyPage) {
+        std::shared_lock<std::shared_mutex> leaf_lock(tree->page_latch(seek_page));
+        page.load(seek_page);
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::advance_page() -> void {
+    while (seek_page != emptyPage) {
+        if (direction == forwardScan) {
+            if (position < static_cast<std::int32_t>(page.len())) {
+                break;
+            }
+            load(page.next_leaf);
+            position = 0;
+        } else {
+            if (position >= 0) {
+                break;
+            }
+            load(page.prev_leaf);
+            position = static_cast<std::int32_t>(page.len()) - 1;
+        }
+
+        if (seek_page != emptyPage) {
+            read_ahead();
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::reseek() -> void {
+    // The leaf links of the page in memory may be stale, so the scan descends the tree again. The siblings
+    // listed for the read-ahead may have moved as well.
+    upcoming.clear();
+    next_upcoming = 0;
+    prefetched = 0;
+    if (direction == forwardScan) {
+        load(tree->locate_data_page(*last_key));
+        position = (seek_page != emptyPage) ? page.lower_bound(*last_key) : 0;
+    } else {
+        load(tree->locate_data_page(*last_key, true));
+        position = (seek_page != emptyPage) ? page.upper_bound(*last_key) - 1 : 0;
+    }
+
+    for (std::size_t skipped = 0; skipped < last_key_count; ++skipped) {
+        advance_page();
+        if (seek_page == emptyPage) {
+            return;
+        }
+
+        FieldType key = page.keys[position];
+        if (tree->gt(key, *last_key) || tree->gt(*last_key, key)) {
+            return;
+        }
+        position += (direction == forwardScan) ? 1 : -1;
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::settle() -> void {
+    advance_page();
+    if (seek_page == emptyPage) {
+        return;
+    }
+
+    FieldType key = page.keys[position];
+    bool const out_of_range = (direction == forwardScan)
+            ? (upper_bound && tree->gt(key, *upper_bound))
+            : (lower_bound && tree->gt(*lower_bound, key));
+
+    if (out_of_range || remaining == 0) {
+        seek_page = emptyPage;
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::read_ahead() -> void {
+    if (++sequential_steps < READ_AHEAD_TRIGGER) {
+        return;
+    }
+
+    if (next_upcoming < upcoming.size() && upcoming[next_upcoming] == seek_page) {
+        ++next_upcoming;
+    } else {
+        collect_upcoming();
+    }
+
+    prefetched = std::max(prefetched, next_upcoming);
+    std::size_t const window_end = std::min(upcoming.size(), next_upcoming + READ_AHEAD_PAGES);
+    for (; prefetched < window_end; ++prefetched) {
+        page.prefetch(upcoming[prefetched]);
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::collect_upcoming() -> void {
+    upcoming.clear();
+    next_upcoming = 0;
+    prefetched = 0;
+
+    if (tree->properties.ROOT_STATUS != indexPage || page.is_empty()) {
+        return;
+    }
+
+    // descends towards the current leaf, through the key that leads to it in the scan direction
+    FieldType key = page.keys[direction == forwardScan ? page.len() - 1 : 0];
+    IndexPage<TYPES()> parent(tree);
+    std::int64_t child = tree->properties.SEEK_ROOT;
+    std::int32_t child_pos;
+
+    do {
+        parent.load(child);
+        child_pos = (direction == forwardScan) ? parent.child_position(key) : parent.last_child_position(key);
+        child = parent.children[child_pos];
+    } while (!parent.points_to_leaf);
+
+    // duplicated keys may lead to a different leaf, in which case there is nothing to read ahead
+    if (child != seek_page) {
+        return;
+    }
+
+    // the separators tell which siblings are entirely out of the scan bounds
+    if (direction == forwardScan) {
+        for (std::int32_t i = child_pos + 1; i <= static_cast<std::int32_t>(parent.len()); ++i) {
+            if (upper_bound && tree->gt(parent.keys[i - 1], *upper_bound)) {
+                break;
+            }
+            upcoming.push_back(parent.children[i]);
+        }
+    } else {
+        for (std::int32_t i = child_pos - 1; i >= 0; --i) {
+            if (lower_bound && tree->gt(*lower_bound, parent.keys[i])) {
+                break;
+            }
+            upcoming.push_back(parent.children[i]);
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::valid() const -> bool {
+    return seek_page != emptyPage;
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::record() -> RecordType& {
+    return page.records[position];
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::next() -> void {
+    if (!valid()) {
+        return;
+    }
+
+    FieldType key = page.keys[position];
+    if (last_key && !tree->gt(key, *last_key) && !tree->gt(*last_key, key)) {
+        ++last_key_count;
+    } else {
+        last_key = key;
+        last_key_count = 1;
+    }
+
+    --remaining;
+    std::shared_lock<std::shared_mutex> tree_lock(tree->tree_latch);
+    // writes made after the check are noticed on the next step
+    std::uint64_t const current = tree->version;
+    if (version != current) {
+        version = current;
+        reseek();
+    } else {
+        position += (direction == forwardScan) ? 1 : -1;
+    }
+    settle();
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::leaf_run() -> std::pair<std::int32_t, std::int32_t> {
+    auto const limit = static_cast<std::int32_t>(std::min<std::size_t>(remaining, page.len()));
+    if (direction == forwardScan) {
+        std::int32_t const last = upper_bound ? page.upper_bound(*upper_bound) : page.len();
+        return { position, std::min(last, position + limit) };
+    }
+    std::int32_t const first = lower_bound ? page.lower_bound(*lower_bound) : 0;
+    return { std::max(first, position + 1 - limit), position + 1 };
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::leaf() -> DataPage<TYPES()>& {
+    return page;
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::advance(std::int32_t count) -> void {
+    if (!valid()) {
+        return;
+    }
+
+    remaining -= count;
+    position += (direction == forwardScan) ? count : -count;
+    settle();
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::begin() -> iterator {
+    return iterator { this };
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::end() -> std::default_sentinel_t {
+    return std::default_sentinel;
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::iterator::operator * () const -> RecordType& {
+    return cursor->record();
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::iterator::operator ++ () -> iterator& {
+    cursor->next();
+    return *this;
+}
+
+
+template<TYPES(typename)>
+auto Cursor<TYPES()>::iterator::operator ++ (int) -> void {
+    cursor->next();
+}
@@ -9,12 +9,212 @@ template<TYPES(typename)>
 DataPage<TYPES()>::~DataPage() = default;
 
 
+template<TYPES(typename)>
+auto DataPage<TYPES()>::type() -> PageType {
+    return dataPage;
+}
+
+
 template<TYPES(typename)>
 auto DataPage<TYPES()>::bytes_len() -> int {
+    if (byte_bounded()) {
+        // slotted and compressed pages take a block, however many records it holds
+        return static_cast<int>(get_buffer_size());
+    }
     return sizeof(std::int32_t) + 2 * sizeof(std::int64_t) + max_capacity() * sizeof(RecordType);
 }
 
 
+template<TYPES(typename)>
+auto DataPage<TYPES()>::header_size() -> std::int32_t {
+    return sizeof(std::int32_t) + 2 * sizeof(std::int64_t);
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::entry_size(const RecordType &record) -> std::int32_t {
+    if constexpr (fixed_layout) {
+        return sizeof(RecordType);
+    }
+    return sizeof(Slot) + static_cast<std::int32_t>(Serializer<RecordType>::size(record));
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::delta_size(const RecordType &record, const RecordType *previous) -> std::int32_t {
+    if constexpr (fixed_layout) {
+        return ::delta_size(reinterpret_cast<const char *>(&record), reinterpret_cast<const char *>(previous),
+                            sizeof(RecordType));
+    }
+    return entry_size(record);
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::compressed() -> bool {
+    return fixed_layout && this->tree->properties.COMPRESSED_LEAVES;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::byte_bounded() -> bool {
+    return !fixed_layout || compressed();
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::stored_size(std::int32_t record_pos) -> std::int32_t {
+    if (compressed()) {
+        return delta_size(records[record_pos], record_pos > 0 ? &records[record_pos - 1] : nullptr);
+    }
+    return entry_size(records[record_pos]);
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::insert_size(std::int32_t record_pos, const RecordType &record) -> std::int32_t {
+    if (!compressed()) {
+        return entry_size(record);
+    }
+
+    // the record following the new one is encoded against it from then on
+    const RecordType *previous = record_pos > 0 ? &records[record_pos - 1] : nullptr;
+    std::int32_t size = delta_size(record, previous);
+    if (record_pos < static_cast<std::int32_t>(len())) {
+        size += delta_size(records[record_pos], &record) - stored_size(record_pos);
+    }
+    return size;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::remove_size(std::int32_t record_pos) -> std::int32_t {
+    std::int32_t size = stored_size(record_pos);
+    if (compressed() && record_pos + 1 < static_cast<std::int32_t>(len())) {
+        const RecordType *previous = record_pos > 0 ? &records[record_pos - 1] : nullptr;
+        size += stored_size(record_pos + 1) - delta_size(records[record_pos + 1], previous);
+    }
+    return size;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::merged_size(DataPage<TYPES()> &right_sibling) -> std::int32_t {
+    std::int32_t size = payload_size() + right_sibling.payload_size();
+    if (compressed() && !this->is_empty() && !right_sibling.is_empty()) {
+        size += delta_size(right_sibling.records[0], &records[len() - 1]) - right_sibling.stored_size(0);
+    }
+    return size;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::payload_size() -> std::int32_t {
+    std::int32_t size = 0;
+    for (std::int32_t i = 0; i < static_cast<std::int32_t>(len()); ++i) {
+        size += stored_size(i);
+    }
+    return size;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::overflows() -> bool {
+    if (!byte_bounded()) {
+        return len() == max_capacity();
+    }
+    return len() == max_capacity() || payload_size() > this->high_water();
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::underflows() -> bool {
+    if (!byte_bounded()) {
+        return static_cast<std::int32_t>(len()) < this->tree->properties.MIN_DATA_PAGE_CAPACITY;
+    }
+    // both limits must be short, so that a merge fits in bytes and in number of records
+    return payload_size() < this->low_water() &&
+           static_cast<std::int32_t>(len()) < this->tree->properties.MIN_DATA_PAGE_CAPACITY;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::occupancy() -> double {
+    // pages bounded by bytes are still split once they hold MAX_DATA_PAGE_CAPACITY records
+    double const records = static_cast<double>(len()) / static_cast<double>(max_capacity());
+    if (!byte_bounded()) {
+        return records;
+    }
+    return std::max(records, static_cast<double>(payload_size()) / static_cast<double>(this->page_size() - header_size()));
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::check_size(RecordType &record) -> void {
+    // a record stored whole may have to be re-encoded on both sides of an insertion into a page that grew past
+    // its limit by one record, after lending its first one
+    if (compressed() && 3 * (entry_size(record) + DELTA_OVERHEAD) > 2 * this->entry_limit()) {
+        throw EntryTooLarge();
+    }
+    if constexpr (!fixed_layout || !IndexPage<TYPES()>::fixed_layout) {
+        if (entry_size(record) > this->entry_limit() ||
+            IndexPage<TYPES()>::entry_size(this->tree->extract_key(record), this->tree->properties.SUBTREE_COUNTS) > this->entry_limit()) {
+            throw EntryTooLarge();
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::fits(const RecordType &record) -> bool {
+    if (static_cast<std::int32_t>(len()) + 1 >= this->tree->properties.MAX_DATA_PAGE_CAPACITY) {
+        return false;
+    }
+    if (!byte_bounded()) {
+        return true;
+    }
+    std::int32_t const record_pos = upper_bound(this->tree->extract_key(const_cast<RecordType &>(record)));
+    return payload_size() + insert_size(record_pos, record) <= this->high_water();
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::can_spare(std::int32_t record_pos, bool is_root) -> bool {
+    // records of a compressed page may be encoded longer against a new neighbour, so a removal could make it
+    // overflow
+    std::int32_t const remaining = byte_bounded() ? payload_size() - remove_size(record_pos) : 0;
+    if (compressed() && remaining > this->high_water()) {
+        return false;
+    }
+
+    // the root leaf is only dropped once empty
+    if (is_root) {
+        return len() > 1;
+    }
+    if (!byte_bounded()) {
+        return static_cast<std::int32_t>(len()) > this->tree->properties.MIN_DATA_PAGE_CAPACITY;
+    }
+    return len() > 1 && (remaining >= this->low_water() ||
+                         static_cast<std::int32_t>(len()) > this->tree->properties.MIN_DATA_PAGE_CAPACITY);
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::split_position() -> std::int32_t {
+    if (!byte_bounded()) {
+        return this->tree->properties.SPLIT_POS_DATA_PAGE;
+    }
+
+    std::int32_t const half = payload_size() / 2;
+    std::int32_t size = 0;
+    std::int32_t split_pos = 0;
+    while (static_cast<std::size_t>(split_pos) < len() && size < half) {
+        size += stored_size(split_pos++);
+    }
+    return std::clamp<std::int32_t>(split_pos, 1, std::max<std::int32_t>(len() - 1, 1));
+}
+
+
 template<typename KeyType, typename RecordType, typename Greater, typename Index>
 auto DataPage<KeyType, RecordType, Greater, Index>::len() -> std::size_t {
     return this->num_records;
@@ -31,12 +231,12 @@ template<TYPES(typename)>
 DataPage<TYPES()>::DataPage(BPlusTree<TYPES()>* tree)
         : Page<TYPES()>(tree), num_records(0), next_leaf(emptyPage), prev_leaf(emptyPage) {
     records.resize(max_capacity(), RecordType());
+    keys.resize(max_capacity(), FieldType());
 }
 
 
 template<TYPES(typename)>
-auto DataPage<TYPES()>::write() -> void {
-    char* buffer = new char[bytes_len()];
+auto DataPage<TYPES()>::write(char *buffer) -> void {
     int offset = 0;
 
     memcpy(buffer + offset, (char *) &num_records, sizeof(std::int32_t));
@@ -48,21 +248,38 @@ auto DataPage<TYPES()>::write() -> void {
     memcpy(buffer + offset, (char *) &prev_leaf, sizeof(std::int64_t));
     offset += sizeof(std::int64_t);
 
+    if constexpr (!fixed_layout) {
+        // the slots follow the header and the records are packed backwards from the end of the page
+        std::int32_t end = this->page_size();
+        for (int i = 0; i < len(); ++i) {
+            Slot slot { 0, static_cast<std::int32_t>(Serializer<RecordType>::size(records[i])) };
+            end -= slot.size;
+            slot.offset = end;
+            Serializer<RecordType>::write(buffer + end, records[i]);
+            memcpy(buffer + offset, (char *) &slot, sizeof(Slot));
+            offset += sizeof(Slot);
+        }
+        return;
+    }
+
+    if (compressed()) {
+        for (int i = 0; i < len(); ++i) {
+            offset += encode_delta((const char *) &records[i], i > 0 ? (const char *) &records[i - 1] : nullptr,
+                                   sizeof(RecordType), buffer + offset);
+        }
+        return;
+    }
+
     for (int i = 0; i < len(); ++i) {
         memcpy(buffer + offset, (char *) &records[i], sizeof(RecordType));
         offset += sizeof(RecordType);
     }
-
-    this->tree->b_plus_index_file.write(buffer, bytes_len());
-    delete [] buffer;
 }
 
 
 template<TYPES(typename)>
-auto DataPage<TYPES()>::read() -> void {
-    char* buffer = new char[bytes_len()];
+auto DataPage<TYPES()>::read(const char *buffer) -> void {
     int offset = 0;
-    this->tree->b_plus_index_file.read(buffer, bytes_len());
 
     memcpy((char *) &num_records, buffer + offset, sizeof(std::int32_t));
     offset += sizeof(std::int32_t);
@@ -73,12 +290,56 @@ auto DataPage<TYPES()>::read() -> void {
     memcpy((char *) & prev_leaf, buffer + offset, sizeof(std::int64_t));
     offset += sizeof(std::int64_t);
 
+    if constexpr (!fixed_layout) {
+        for (int i = 0; i < len(); ++i) {
+            Slot slot {};
+            memcpy((char *) &slot, buffer + offset, sizeof(Slot));
+            offset += sizeof(Slot);
+            Serializer<RecordType>::read(buffer + slot.offset, slot.size, records[i]);
+            keys[i] = this->tree->extract_key(records[i]);
+        }
+        return;
+    }
+
+    if (compressed()) {
+        for (int i = 0; i < len(); ++i) {
+            offset += decode_delta(buffer + offset, i > 0 ? (const char *) &records[i - 1] : nullptr,
+                                   sizeof(RecordType), (char *) &records[i]);
+            keys[i] = this->tree->extract_key(records[i]);
+        }
+        return;
+    }
+
     for (int i = 0; i < len(); ++i) {
         memcpy((char *) & records[i], buffer + offset, sizeof(RecordType));
         offset += sizeof(RecordType);
+        keys[i] = this->tree->extract_key(records[i]);
+    }
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::allocate() -> std::streampos {
+    std::int64_t &free_head = this->tree->properties.FREE_DATA_PAGE_HEAD;
+    if (free_head == emptyPage) {
+        return this->tree->buffer_pool.allocate(this->page_size());
     }
 
-    delete [] buffer;
+    // released data pages are linked through their next leaf pointer
+    std::streampos free_seek = free_head;
+    DataPage<TYPES()> free_page(this->tree);
+    free_page.load(free_seek);
+    free_head = free_page.next_leaf;
+    return free_seek;
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::release(std::streampos pos) -> void {
+    DataPage<TYPES()> free_page(this->tree);
+    free_page.next_leaf = this->tree->properties.FREE_DATA_PAGE_HEAD;
+    free_page.save(pos);
+    this->tree->properties.FREE_DATA_PAGE_HEAD = pos;
 }
 
 
@@ -91,7 +352,8 @@ auto DataPage<TYPES()>::split(std::int32_t split_pos) -> SplitResult<TYPES()> {
     }
 
     num_records -= new_data_page->len();
-    return SplitResult<TYPES()> { new_data_page, this->tree->get_search_field(records[len() - 1]) };
+    FieldType separator = SeparatorTruncation<FieldType, Compare>::between(keys[len() - 1], new_data_page->keys[0]);
+    return SplitResult<TYPES()> { new_data_page, separator };
 }
 
 
@@ -101,12 +363,12 @@ auto DataPage<TYPES()>::balance_page_insert(std::streampos seek_parent,
                                                std::int32_t child_pos) -> void {
     std::streampos child_seek = parent.children[child_pos];
     // Create a new data page to accommodate the split
-    SplitResult<TYPES()> split = this->split(this->tree->properties.SPLIT_POS_DATA_PAGE);
+    SplitResult<TYPES()> split = this->split(split_position());
     auto new_page = std::dynamic_pointer_cast<DataPage<TYPES()>>(split.new_page);
+    this->tree->statistics.record(pageSplit);
 
-    // Seek to the end of the B+Tree index file to append the new page
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_page_seek = this->tree->b_plus_index_file.tellp();
+    // Reuse a released slot or reserve room at the end of the B+Tree index file for the new page
+    std::streampos new_page_seek = new_page->allocate();
 
     // Set the previous leaf pointer of the new page
     new_page->prev_leaf = child_seek;
@@ -131,7 +393,7 @@ auto DataPage<TYPES()>::balance_page_insert(std::streampos seek_parent,
     this->save(child_seek);
 
     // Update references to data pages in the parent index page
-    parent.reallocate_references_after_split(child_pos, split.split_key, new_page_seek);
+    parent.reallocate_references_after_split(child_pos, split.split_key, new_page_seek, new_page->len());
 
     // Seek to the location of the parent index page in the index file and update it
     parent.save(seek_parent);
@@ -140,11 +402,11 @@ auto DataPage<TYPES()>::balance_page_insert(std::streampos seek_parent,
 
 template<TYPES(typename)>
 auto DataPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPage<TYPES()>& parent, std::int32_t child_pos) -> void {
-    std::int32_t minimum = this->tree->properties.MIN_DATA_PAGE_CAPACITY;
-    if (len() >= minimum) {
+    if (!underflows()) {
         return;
     }
 
+    std::streampos child_seek = parent.children[child_pos];
     DataPage<TYPES()> left_sibling(this->tree);
     DataPage<TYPES()> right_sibling(this->tree);
 
@@ -152,13 +414,14 @@ auto DataPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPag
         std::streampos seek_left_sibling = parent.children[child_pos - 1];
         left_sibling.load(seek_left_sibling);
 
-        if (left_sibling.len() > minimum) {
+        if (left_sibling.can_spare(left_sibling.len() - 1)) {
             // left-borrow
+            this->tree->statistics.record(pageBorrow);
             RecordType to_borrow = left_sibling.pop_back();
             this->push_front(to_borrow);
-            RecordType left_max_record = left_sibling.max_record();
-            FieldType new_key = this->tree->get_search_field(left_max_record);
-            parent.keys[child_pos - 1] = new_key;
+            parent.keys[child_pos - 1] = SeparatorTruncation<FieldType, Compare>::between(
+                    left_sibling.keys[left_sibling.len() - 1], keys[0]);
+            parent.transfer_count(child_pos - 1, child_pos, 1);
 
             // save changes
             left_sibling.save(seek_left_sibling);
@@ -170,12 +433,17 @@ auto DataPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPag
         std::streampos seek_right_sibling = parent.children[1];
         right_sibling.load(seek_right_sibling);
 
-        if (right_sibling.len() > minimum) {
+        // a compressed sibling may only be unable to spare its first record because the next one would be
+        // encoded longer, it lends it anyway when both do not fit in a page
+        bool const lends = right_sibling.can_spare(0) ||
+                           (compressed() && merged_size(right_sibling) > this->high_water());
+        if (lends) {
             // right-borrow
+            this->tree->statistics.record(pageBorrow);
             RecordType to_borrow = right_sibling.pop_front();
             this->push_back(to_borrow);
-            FieldType new_key = this->tree->get_search_field(to_borrow);
-            parent.keys[0] = new_key;
+            parent.keys[0] = SeparatorTruncation<FieldType, Compare>::between(keys[len() - 1], right_sibling.keys[0]);
+            parent.transfer_count(1, 0, 1);
 
             // save changes
             right_sibling.save(seek_right_sibling);
@@ -187,15 +455,17 @@ auto DataPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPag
 
     if (child_pos > 0) {
         // left-merge
+        this->tree->statistics.record(pageMerge);
         std::streampos seek_left_sibling = parent.children[child_pos - 1];
         left_sibling.merge(*this);
         left_sibling.next_leaf = this->next_leaf;
 
-        if (child_pos < parent.len()) {
+        // the next leaf may belong to another parent, so it is reached through the leaf chain
+        if (this->next_leaf != emptyPage) {
             DataPage<TYPES()> other_sibling(this->tree);
-            other_sibling.load(parent.children[child_pos + 1]);
+            other_sibling.load(this->next_leaf);
             other_sibling.prev_leaf = seek_left_sibling;
-            other_sibling.save(parent.children[child_pos + 1]);
+            other_sibling.save(this->next_leaf);
         }
 
         parent.reallocate_references_after_merge(child_pos - 1);
@@ -203,36 +473,40 @@ auto DataPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPag
         // save changes
         left_sibling.save(seek_left_sibling);
         parent.save(seek_parent);
+        this->release(child_seek);
     } else {
         // right-merge
+        this->tree->statistics.record(pageMerge);
         this->merge(right_sibling);
         this->next_leaf = right_sibling.next_leaf;
 
-        if (parent.len() >= 2) {
+        if (this->next_leaf != emptyPage) {
             DataPage<TYPES()> other_sibling(this->tree);
-            other_sibling.load(parent.children[2]);
+            other_sibling.load(this->next_leaf);
             other_sibling.prev_leaf = parent.children[0];
-            other_sibling.save(parent.children[2]);
+            other_sibling.save(this->next_leaf);
         }
 
+        std::streampos seek_right_sibling = parent.children[1];
         parent.reallocate_references_after_merge(child_pos);
 
         // save changes
         this->save(parent.children[child_pos]);
         parent.save(seek_parent);
+        this->release(seek_right_sibling);
     }
 }
 
 
 template<TYPES(typename)>
 auto DataPage<TYPES()>::balance_root_insert(std::streampos old_root_seek) -> void {
-    SplitResult<TYPES()> split = this->split(this->tree->properties.SPLIT_POS_DATA_PAGE);
+    SplitResult<TYPES()> split = this->split(split_position());
     auto new_page = std::dynamic_pointer_cast<DataPage<TYPES()>>(split.new_page);
+    this->tree->statistics.record(pageSplit);
 
     new_page->prev_leaf = old_root_seek;
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_page_seek = this->tree->b_plus_index_file.tellp();
-    new_page->write();
+    std::streampos new_page_seek = new_page->allocate();
+    new_page->save(new_page_seek);
 
     this->next_leaf = new_page_seek;
     this->save(old_root_seek);
@@ -241,22 +515,26 @@ auto DataPage<TYPES()>::balance_root_insert(std::streampos old_root_seek) -> voi
     new_root.keys[0] = split.split_key;
     new_root.children[0] = old_root_seek;
     new_root.children[1] = new_page_seek;
+    new_root.counts[0] = len();
+    new_root.counts[1] = new_page->len();
     new_root.num_keys = 1;
 
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_root_seek = this->tree->b_plus_index_file.tellp();
-    new_root.write();
+    std::streampos new_root_seek = new_root.allocate();
+    new_root.save(new_root_seek);
 
     this->tree->properties.SEEK_ROOT = new_root_seek;
     this->tree->properties.ROOT_STATUS = indexPage;
+    this->tree->statistics.record(rootChange);
 }
 
 
 template<TYPES(typename)>
 auto DataPage<TYPES()>::balance_root_remove() -> void {
     if (this->is_empty()) {
+        this->release(this->tree->properties.SEEK_ROOT);
         this->tree->properties.SEEK_ROOT = emptyPage;
         this->tree->properties.ROOT_STATUS = emptyPage;
+        this->tree->statistics.record(rootChange);
     }
 }
 
@@ -267,11 +545,11 @@ auto DataPage<TYPES()>::push_front(RecordType &record) -> void {
         throw FullPage();
     }
 
-    for (int i = len() - 1; i >= 0; --i) {
-        records[i + 1] = records[i];
-    }
+    std::move_backward(records.begin(), records.begin() + num_records, records.begin() + num_records + 1);
+    std::move_backward(keys.begin(), keys.begin() + num_records, keys.begin() + num_records + 1);
 
     records[0] = record;
+    keys[0] = this->tree->extract_key(record);
     num_records++;
 }
 
@@ -282,7 +560,9 @@ auto DataPage<TYPES()>::push_back(RecordType &record) -> void {
         throw FullPage();
     }
 
-    records[num_records++] = record;
+    records[num_records] = record;
+    keys[num_records] = this->tree->extract_key(record);
+    ++num_records;
 }
 
 
@@ -303,10 +583,8 @@ auto DataPage<TYPES()>::pop_front() -> RecordType {
     }
 
     RecordType record = records[0];
-
-    for (int i = 0; i < len() - 1; ++i) {
-        records[i] = records[i + 1];
-    }
+    std::move(records.begin() + 1, records.begin() + num_records, records.begin());
+    std::move(keys.begin() + 1, keys.begin() + num_records, keys.begin());
 
     --num_records;
     return record;
@@ -323,51 +601,58 @@ auto DataPage<TYPES()>::max_record() -> RecordType  {
 }
 
 
+template<TYPES(typename)>
+auto DataPage<TYPES()>::lower_bound(const FieldType &key) -> std::int32_t {
+    return KeySearch<FieldType, Compare>::lower_bound(keys.data(), len(), key, this->tree->gt);
+}
+
+
+template<TYPES(typename)>
+auto DataPage<TYPES()>::upper_bound(const FieldType &key) -> std::int32_t {
+    return KeySearch<FieldType, Compare>::upper_bound(keys.data(), len(), key, this->tree->gt);
+}
+
+
 template<TYPES(typename)>
 auto DataPage<TYPES()>::sorted_insert(RecordType &record) -> void {
     if (this->is_full()) {
         throw FullPage();
     }
 
-    FieldType key = this->tree->get_search_field(record);
-    int record_pos = len();
-    while (record_pos >= 1 && this->tree->gt(this->tree->get_search_field(records[record_pos - 1]), key)) {
-        records[record_pos] = records[record_pos - 1];
-        --record_pos;
-    }
+    check_size(record);
+
+    // Records with the same key keep their insertion order
+    FieldType key = this->tree->extract_key(record);
+    std::int32_t record_pos = upper_bound(key);
+    std::move_backward(records.begin() + record_pos, records.begin() + num_records, records.begin() + num_records + 1);
+    std::move_backward(keys.begin() + record_pos, keys.begin() + num_records, keys.begin() + num_records + 1);
 
     records[record_pos] = record;
+    keys[record_pos] = std::move(key);
     ++num_records;
 }
 
 
 template<TYPES(typename)>
 auto DataPage<TYPES()>::remove(FieldType key) -> std::shared_ptr<FieldType> {
-    std::int32_t i = 0;
+    std::int32_t i = lower_bound(key);
 
-    while (i < len() && this->tree->gt(key, this->tree->get_search_field(records[i]))) {
-        ++i;
-    }
-
-    if (i == len() || this->tree->gt(this->tree->get_search_field(records[i]), key)) {
+    if (i == static_cast<std::int32_t>(len()) || this->tree->gt(keys[i], key)) {
         throw KeyNotFound();
     }
 
-    while (i < len() - 1) {
-        records[i] = records[i + 1];
-        i++;
-    }
-
+    std::move(records.begin() + i + 1, records.begin() + num_records, records.begin() + i);
+    std::move(keys.begin() + i + 1, keys.begin() + num_records, keys.begin() + i);
     num_records--;
 
     if (len() > 0) {
-        return std::make_shared<FieldType>(this->tree->get_search_field(records[len() - 1]));
+        return std::make_shared<FieldType>(keys[len() - 1]);
     }
 
     if (prev_leaf != emptyPage) {
         DataPage<TYPES()> prev_data_page(this->tree);
         prev_data_page.load(prev_leaf);
-        return std::make_shared<FieldType>(this->tree->get_search_field(prev_data_page.records[prev_data_page.len() - 1]));
+        return std::make_shared<FieldType>(prev_data_page.keys[prev_data_page.len() - 1]);
     }
 
     return nullptr;
@@ -384,6 +669,11 @@ auto DataPage<TYPES()>::merge(DataPage<TYPES()> &right_sibling) -> void {
 
 template <typename RecordType>
 auto get_expected_data_page_capacity() -> std::int32_t{
+    if constexpr (!Serializer<RecordType>::fixed_size) {
+        // bounds the number of slots, the bytes of the records fill the page first
+        return static_cast<std::int32_t>(
+                (get_buffer_size() - 2 * sizeof(std::int64_t) - sizeof(std::int32_t)) / sizeof(Slot));
+    }
     return std::floor(
             static_cast<double>(get_buffer_size() - 2 * sizeof(std::int64_t) - sizeof(std::int32_t)) /
             (sizeof(RecordType))
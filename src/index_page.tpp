@@ -10,6 +10,7 @@ IndexPage<TYPES()>::IndexPage(BPlusTree<TYPES()>* tree, bool points_to_leaf)
     : Page<TYPES()>(tree), num_keys(0), points_to_leaf(points_to_leaf){
     keys.resize(max_capacity(), FieldType());
     children.resize(max_capacity() + 1, emptyPage);
+    counts.resize(max_capacity() + 1, 0);
 }
 
 
@@ -17,9 +18,132 @@ template <TYPES(typename)>
 IndexPage<TYPES()>::~IndexPage() = default;
 
 
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::type() -> PageType {
+    return indexPage;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::counted() -> bool {
+    return this->tree->properties.SUBTREE_COUNTS;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::subtree_size() -> std::int64_t {
+    return records_before(len() + 1);
+}
+
+
 template <TYPES(typename)>
 auto IndexPage<TYPES()>::bytes_len() -> int {
-    return sizeof(std::int32_t) + max_capacity() * sizeof(FieldType) + (max_capacity() + 1) * sizeof(std::int64_t) + sizeof(bool);
+    if constexpr (!fixed_layout) {
+        return static_cast<int>(get_buffer_size());
+    }
+    return sizeof(std::int32_t) + max_capacity() * sizeof(FieldType) +
+           (max_capacity() + 1) * child_size(counted()) + sizeof(bool);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::header_size() -> std::int32_t {
+    return sizeof(std::int32_t) + sizeof(bool);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::child_size(bool counted) -> std::int32_t {
+    return counted ? 2 * sizeof(std::int64_t) : sizeof(std::int64_t);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::entry_size(const FieldType &key, bool counted) -> std::int32_t {
+    if constexpr (fixed_layout) {
+        return sizeof(FieldType) + child_size(counted);
+    } else if constexpr (front_coded) {
+        return sizeof(PrefixSlot) + child_size(counted) + static_cast<std::int32_t>(key.size());
+    }
+    return sizeof(Slot) + child_size(counted) + static_cast<std::int32_t>(Serializer<FieldType>::size(key));
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::stored_size(std::int32_t key_pos) -> std::int32_t {
+    if constexpr (front_coded) {
+        if (key_pos > 0) {
+            return entry_size(keys[key_pos], counted()) -
+                   static_cast<std::int32_t>(shared_prefix_length(keys[key_pos - 1], keys[key_pos]));
+        }
+    }
+    return entry_size(keys[key_pos], counted());
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::payload_size() -> std::int32_t {
+    std::int32_t size = child_size(counted());
+    for (std::int32_t i = 0; i < len(); ++i) {
+        size += stored_size(i);
+    }
+    return size;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::overflows() -> bool {
+    if constexpr (fixed_layout) {
+        return len() == max_capacity();
+    }
+    return len() == max_capacity() || payload_size() > this->high_water();
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::underflows() -> bool {
+    if constexpr (fixed_layout) {
+        return static_cast<std::int32_t>(len()) < this->tree->properties.MIN_INDEX_PAGE_CAPACITY;
+    }
+    // a page short on bytes but holding many small keys is still merged within the count limit
+    return payload_size() < this->low_water() &&
+           static_cast<std::int32_t>(len()) < this->tree->properties.MIN_INDEX_PAGE_CAPACITY;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::occupancy() -> double {
+    double const keys = static_cast<double>(len()) / static_cast<double>(max_capacity());
+    if constexpr (fixed_layout) {
+        return keys;
+    }
+    return std::max(keys, static_cast<double>(payload_size()) / static_cast<double>(this->page_size() - header_size()));
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::can_spare(std::int32_t key_pos) -> bool {
+    if constexpr (fixed_layout) {
+        return static_cast<std::int32_t>(len()) > this->tree->properties.MIN_INDEX_PAGE_CAPACITY;
+    }
+    return len() > 1 && (payload_size() - entry_size(keys[key_pos], counted()) >= this->low_water() ||
+                         static_cast<std::int32_t>(len()) > this->tree->properties.MIN_INDEX_PAGE_CAPACITY);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::split_position() -> std::int32_t {
+    if constexpr (fixed_layout) {
+        return this->tree->properties.SPLIT_POS_INDEX_PAGE;
+    }
+
+    std::int32_t const half = payload_size() / 2;
+    std::int32_t size = child_size(counted());
+    std::int32_t split_pos = 0;
+    while (static_cast<std::size_t>(split_pos) < len() && size + stored_size(split_pos) < half) {
+        size += stored_size(split_pos++);
+    }
+    return std::clamp<std::int32_t>(split_pos, 1, std::max<std::int32_t>(len() - 2, 1));
 }
 
 
@@ -36,13 +160,56 @@ auto IndexPage<FieldType, RecordType, Greater, Index>::max_capacity() -> std::si
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::write() -> void {
-    char* buffer = new char[bytes_len()];
+auto IndexPage<TYPES()>::save(std::streampos pos) -> void {
+    Page<TYPES()>::save(pos);
+    this->tree->pinned_index.update(pos, *this);
+}
 
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::write(char *buffer) -> void {
     int offset = 0;
     memcpy(buffer + offset, (char *) &num_keys, sizeof(std::int32_t));
     offset += sizeof(std::int32_t);
 
+    if constexpr (!fixed_layout) {
+        // the children and the slots of the keys follow the header, the keys are packed from the end of the page
+        memcpy(buffer + offset, (char *) &points_to_leaf, sizeof(bool));
+        offset += sizeof(bool);
+
+        memcpy(buffer + offset, (char *) children.data(), (num_keys + 1) * sizeof(std::int64_t));
+        offset += (num_keys + 1) * sizeof(std::int64_t);
+
+        if (counted()) {
+            memcpy(buffer + offset, (char *) counts.data(), (num_keys + 1) * sizeof(std::int64_t));
+            offset += (num_keys + 1) * sizeof(std::int64_t);
+        }
+
+        std::int32_t end = this->page_size();
+        if constexpr (front_coded) {
+            for (int i = 0; i < num_keys; ++i) {
+                auto const shared = static_cast<std::int32_t>(i > 0 ? shared_prefix_length(keys[i - 1], keys[i]) : 0);
+                PrefixSlot slot { 0, static_cast<std::int32_t>(keys[i].size()) - shared, shared };
+                end -= slot.size;
+                slot.offset = end;
+                memcpy(buffer + end, keys[i].data() + shared, slot.size);
+                memcpy(buffer + offset, (char *) &slot, sizeof(PrefixSlot));
+                offset += sizeof(PrefixSlot);
+            }
+            return;
+        }
+
+        for (int i = 0; i < num_keys; ++i) {
+            Slot slot { 0, static_cast<std::int32_t>(Serializer<FieldType>::size(keys[i])) };
+            end -= slot.size;
+            slot.offset = end;
+            Serializer<FieldType>::write(buffer + end, keys[i]);
+            memcpy(buffer + offset, (char *) &slot, sizeof(Slot));
+            offset += sizeof(Slot);
+        }
+        return;
+    }
+
     for (int i = 0; i < max_capacity(); ++i) {
         memcpy(buffer + offset, (char *)&keys[i], sizeof(FieldType));
         offset += sizeof(FieldType);
@@ -53,22 +220,55 @@ auto IndexPage<TYPES()>::write() -> void {
         offset += sizeof(std::int64_t);
     }
 
-    memcpy(buffer + offset, (char *)&points_to_leaf, sizeof(bool));
-    this->tree->b_plus_index_file.write(buffer, bytes_len());
+    if (counted()) {
+        for (int i = 0; i <= max_capacity(); ++i) {
+            memcpy(buffer + offset, (char *)&counts[i], sizeof(std::int64_t));
+            offset += sizeof(std::int64_t);
+        }
+    }
 
-    delete [] buffer;
+    memcpy(buffer + offset, (char *)&points_to_leaf, sizeof(bool));
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::read() -> void {
-    char* buffer = new char[bytes_len()];
-    this->tree->b_plus_index_file.read(buffer, bytes_len());
-
+auto IndexPage<TYPES()>::read(const char *buffer) -> void {
     int offset = 0;
     memcpy((char *)& num_keys, buffer + offset, sizeof(std::int32_t));
     offset += sizeof(std::int32_t);
 
+    if constexpr (!fixed_layout) {
+        memcpy((char *) &points_to_leaf, buffer + offset, sizeof(bool));
+        offset += sizeof(bool);
+
+        memcpy((char *) children.data(), buffer + offset, (num_keys + 1) * sizeof(std::int64_t));
+        offset += (num_keys + 1) * sizeof(std::int64_t);
+
+        if (counted()) {
+            memcpy((char *) counts.data(), buffer + offset, (num_keys + 1) * sizeof(std::int64_t));
+            offset += (num_keys + 1) * sizeof(std::int64_t);
+        }
+
+        if constexpr (front_coded) {
+            for (int i = 0; i < num_keys; ++i) {
+                PrefixSlot slot {};
+                memcpy((char *) &slot, buffer + offset, sizeof(PrefixSlot));
+                offset += sizeof(PrefixSlot);
+                keys[i].assign(i > 0 ? keys[i - 1] : FieldType(), 0, slot.shared);
+                keys[i].append(buffer + slot.offset, slot.size);
+            }
+            return;
+        }
+
+        for (int i = 0; i < num_keys; ++i) {
+            Slot slot {};
+            memcpy((char *) &slot, buffer + offset, sizeof(Slot));
+            offset += sizeof(Slot);
+            Serializer<FieldType>::read(buffer + slot.offset, slot.size, keys[i]);
+        }
+        return;
+    }
+
     for (int i = 0; i < max_capacity(); ++i) {
         memcpy((char *) &keys[i], buffer + offset, sizeof(FieldType));
         offset += sizeof(FieldType);
@@ -79,8 +279,40 @@ auto IndexPage<TYPES()>::read() -> void {
         offset += sizeof(std::int64_t);
     }
 
+    if (counted()) {
+        for (int i = 0; i <= max_capacity(); ++i) {
+            memcpy((char *) &counts[i], buffer + offset, sizeof(std::int64_t));
+            offset += sizeof(std::int64_t);
+        }
+    }
+
     memcpy((char *) &points_to_leaf, buffer + offset, sizeof(bool));
-    delete [] buffer;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::allocate() -> std::streampos {
+    std::int64_t &free_head = this->tree->properties.FREE_INDEX_PAGE_HEAD;
+    if (free_head == emptyPage) {
+        return this->tree->buffer_pool.allocate(this->page_size());
+    }
+
+    // released index pages are linked through their first child
+    std::streampos free_seek = free_head;
+    IndexPage<TYPES()> free_page(this->tree);
+    free_page.load(free_seek);
+    free_head = free_page.children[0];
+    return free_seek;
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::release(std::streampos pos) -> void {
+    IndexPage<TYPES()> free_page(this->tree);
+    free_page.children[0] = this->tree->properties.FREE_INDEX_PAGE_HEAD;
+    free_page.save(pos);
+    this->tree->properties.FREE_INDEX_PAGE_HEAD = pos;
+    this->tree->pinned_index.invalidate();
 }
 
 
@@ -90,9 +322,10 @@ auto IndexPage<TYPES()>::split(std::int32_t split_pos) -> SplitResult<TYPES()> {
     FieldType new_key = keys[split_pos];
 
     for (int i = split_pos + 1; i < num_keys; ++i) {
-        new_index_page->push_back(keys[i], children[i + 1]);
+        new_index_page->push_back(keys[i], children[i + 1], counts[i + 1]);
     }
     new_index_page->children[0] = children[split_pos + 1];
+    new_index_page->counts[0] = counts[split_pos + 1];
 
     num_keys -= (new_index_page->num_keys + 1);
     return SplitResult<TYPES()> { new_index_page, new_key };
@@ -105,16 +338,16 @@ auto IndexPage<TYPES()>::balance_page_insert(std::streampos seek_parent,
                                                 std::int32_t child_pos) -> void {
     std::streampos child_seek = parent.children[child_pos];
 
-    SplitResult<TYPES()> split = this->split(this->tree->properties.SPLIT_POS_INDEX_PAGE);
+    SplitResult<TYPES()> split = this->split(split_position());
     auto new_page = std::dynamic_pointer_cast<IndexPage<TYPES()>>(split.new_page);
+    this->tree->statistics.record(pageSplit);
 
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_page_seek = this->tree->b_plus_index_file.tellp();
-    new_page->write();
+    std::streampos new_page_seek = new_page->allocate();
+    new_page->save(new_page_seek);
 
     this->save(child_seek);
 
-    parent.reallocate_references_after_split(child_pos, split.split_key, new_page_seek);
+    parent.reallocate_references_after_split(child_pos, split.split_key, new_page_seek, new_page->subtree_size());
 
     // Seek to the location of the parent index page in the index file and update it
     parent.save(seek_parent);
@@ -123,11 +356,11 @@ auto IndexPage<TYPES()>::balance_page_insert(std::streampos seek_parent,
 
 template<TYPES(typename)>
 auto IndexPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPage<TYPES()>& parent, std::int32_t child_pos) -> void {
-    std::int32_t minimum = this->tree->properties.MIN_INDEX_PAGE_CAPACITY;
-    if (len() >= minimum) {
+    if (!underflows()) {
         return;
     }
 
+    std::streampos child_seek = parent.children[child_pos];
     IndexPage<TYPES()> left_sibling(this->tree);
     IndexPage<TYPES()> right_sibling(this->tree);
 
@@ -135,11 +368,13 @@ auto IndexPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPa
         std::streampos seek_left_sibling = parent.children[child_pos - 1];
         left_sibling.load(seek_left_sibling);
 
-        if (left_sibling.len() > minimum) {
+        if (left_sibling.can_spare(left_sibling.len() - 1)) {
             // left-borrow
-            auto [last_key, last_child] = left_sibling.pop_back();
-            this->push_front(parent.keys[child_pos - 1], last_child);
+            this->tree->statistics.record(pageBorrow);
+            auto [last_key, last_child, last_count] = left_sibling.pop_back();
+            this->push_front(parent.keys[child_pos - 1], last_child, last_count);
             parent.keys[child_pos - 1] = last_key;
+            parent.transfer_count(child_pos - 1, child_pos, last_count);
 
             // save changes
             left_sibling.save(seek_left_sibling);
@@ -152,11 +387,13 @@ auto IndexPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPa
         std::streampos seek_right_sibling = parent.children[1];
         right_sibling.load(seek_right_sibling);
 
-        if (right_sibling.len() > minimum) {
+        if (right_sibling.can_spare(0)) {
             // right-borrow
-            auto [first_key, first_child] = right_sibling.pop_front();
-            this->push_back(parent.keys[0], first_child);
+            this->tree->statistics.record(pageBorrow);
+            auto [first_key, first_child, first_count] = right_sibling.pop_front();
+            this->push_back(parent.keys[0], first_child, first_count);
             parent.keys[0] = first_key;
+            parent.transfer_count(1, 0, first_count);
 
             // save changes
             right_sibling.save(seek_right_sibling);
@@ -169,31 +406,36 @@ auto IndexPage<TYPES()>::balance_page_remove(std::streampos seek_parent, IndexPa
     if (child_pos > 0) {
         std::streampos seek_left_sibling = parent.children[child_pos - 1];
         // left-merge
+        this->tree->statistics.record(pageMerge);
         left_sibling.merge(*this, parent.keys[child_pos - 1]);
         parent.reallocate_references_after_merge(child_pos - 1);
 
         // save changes
         left_sibling.save(seek_left_sibling);
         parent.save(seek_parent);
+        this->release(child_seek);
     } else {
         // right-merge
+        this->tree->statistics.record(pageMerge);
+        std::streampos seek_right_sibling = parent.children[1];
         this->merge(right_sibling, parent.keys[0]);
         parent.reallocate_references_after_merge(0);
 
         // save changes
         this->save(parent.children[0]);
         parent.save(seek_parent);
+        this->release(seek_right_sibling);
     }
 }
 
 
 template<TYPES(typename)>
 auto IndexPage<TYPES()>::balance_root_insert(std::streampos old_root_seek) -> void {
-    SplitResult<TYPES()> split = this->split(this->tree->properties.SPLIT_POS_INDEX_PAGE);
+    SplitResult<TYPES()> split = this->split(split_position());
     auto new_page = std::dynamic_pointer_cast<IndexPage<TYPES()>>(split.new_page);
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_page_seek = this->tree->b_plus_index_file.tellp();
-    new_page->write();
+    this->tree->statistics.record(pageSplit);
+    std::streampos new_page_seek = new_page->allocate();
+    new_page->save(new_page_seek);
 
     this->save(old_root_seek);
 
@@ -202,29 +444,33 @@ auto IndexPage<TYPES()>::balance_root_insert(std::streampos old_root_seek) -> vo
     new_root.keys[0] = split.split_key;
     new_root.children[0] = old_root_seek;
     new_root.children[1] = new_page_seek;
+    new_root.counts[0] = this->subtree_size();
+    new_root.counts[1] = new_page->subtree_size();
 
-    seek(this->tree->b_plus_index_file, 0, std::ios::end);
-    std::streampos new_root_seek = this->tree->b_plus_index_file.tellp();
-    new_root.write();
+    std::streampos new_root_seek = new_root.allocate();
+    new_root.save(new_root_seek);
 
     this->tree->properties.SEEK_ROOT = new_root_seek;
+    this->tree->statistics.record(rootChange);
 }
 
 
 template<TYPES(typename)>
 auto IndexPage<TYPES()>::balance_root_remove() -> void {
     if (this->is_empty()) {
+        this->release(this->tree->properties.SEEK_ROOT);
         this->tree->properties.SEEK_ROOT = children[0];
 
         if (points_to_leaf) {
             this->tree->properties.ROOT_STATUS = dataPage;
         }
+        this->tree->statistics.record(rootChange);
     }
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::push_front(FieldType& key, std::streampos child) -> void {
+auto IndexPage<TYPES()>::push_front(FieldType& key, std::streampos child, std::int64_t count) -> void {
     if (this->is_full()) {
         throw FullPage();
     }
@@ -235,28 +481,31 @@ auto IndexPage<TYPES()>::push_front(FieldType& key, std::streampos child) -> voi
 
     for (int i = num_keys + 1; i > 0; --i) {
         children[i] = children[i - 1];
+        counts[i] = counts[i - 1];
     }
 
     keys[0] = key;
     children[0] = child;
+    counts[0] = count;
     ++num_keys;
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::push_back(FieldType &key, std::streampos child) -> void {
+auto IndexPage<TYPES()>::push_back(FieldType &key, std::streampos child, std::int64_t count) -> void {
     if (this->is_full()) {
         throw FullPage();
     }
 
     keys[num_keys] = key;
     children[num_keys + 1] = child;
+    counts[num_keys + 1] = count;
     ++num_keys;
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::pop_front() -> std::pair<FieldType, std::streampos> {
+auto IndexPage<TYPES()>::pop_front() -> std::tuple<FieldType, std::streampos, std::int64_t> {
     if (this->is_empty()) {
         throw EmptyPage();
     }
@@ -267,60 +516,111 @@ auto IndexPage<TYPES()>::pop_front() -> std::pair<FieldType, std::streampos> {
     }
 
     std::streampos child = children[0];
+    std::int64_t count = counts[0];
     for (std::int32_t i = 0; i < len(); ++i) {
         children[i] = children[i + 1];
+        counts[i] = counts[i + 1];
     }
 
     --num_keys;
-    return std::make_pair(key, child);
+    return std::make_tuple(key, child, count);
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::pop_back() -> std::pair<FieldType, std::streampos> {
+auto IndexPage<TYPES()>::pop_back() -> std::tuple<FieldType, std::streampos, std::int64_t> {
     if (this->is_empty()) {
         throw EmptyPage();
     }
 
     --num_keys;
-    return std::make_pair(keys[num_keys], children[num_keys + 1]);
+    return std::make_tuple(keys[num_keys], children[num_keys + 1], counts[num_keys + 1]);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::child_position(const FieldType &key) -> std::int32_t {
+    return KeySearch<FieldType, Compare>::lower_bound(keys.data(), len(), key, this->tree->gt);
 }
 
 
 template <TYPES(typename)>
-auto IndexPage<TYPES()>::reallocate_references_after_split(std::int32_t child_pos, FieldType& new_key, std::streampos new_page_seek) -> void {
+auto IndexPage<TYPES()>::last_child_position(const FieldType &key) -> std::int32_t {
+    return KeySearch<FieldType, Compare>::upper_bound(keys.data(), len(), key, this->tree->gt);
+}
+
+
+template <TYPES(typename)>
+auto IndexPage<TYPES()>::reallocate_references_after_split(std::int32_t child_pos,
+                                                           FieldType& new_key,
+                                                           std::streampos new_page_seek,
+                                                           std::int64_t new_page_count) -> void {
     for (int i = len(); i > child_pos; --i) {
         keys[i] = keys[i - 1];
         children[i + 1] = children[i];
+        counts[i + 1] = counts[i];
     }
 
     keys[child_pos] = new_key;
     children[child_pos + 1] = new_page_seek;
+    counts[child_pos + 1] = new_page_count;
+    counts[child_pos] -= new_page_count;
     ++num_keys;
 }
 
 
 template<TYPES(typename)>
 auto IndexPage<TYPES()>::reallocate_references_after_merge(std::int32_t merged_child_pos) -> void {
+    counts[merged_child_pos] += counts[merged_child_pos + 1];
     for (std::int32_t i = merged_child_pos; i < len() - 1; ++i) {
         keys[i] = keys[i + 1];
         children[i + 1] = children[i + 2];
+        counts[i + 1] = counts[i + 2];
     }
     --num_keys;
 }
 
 
+template<TYPES(typename)>
+auto IndexPage<TYPES()>::transfer_count(std::int32_t from, std::int32_t to, std::int64_t count) -> void {
+    counts[from] -= count;
+    counts[to] += count;
+}
+
+
+template<TYPES(typename)>
+auto IndexPage<TYPES()>::child_at_rank(std::int64_t &rank) -> std::int32_t {
+    auto const last = static_cast<std::int32_t>(len());
+    std::int32_t child_pos = 0;
+    while (child_pos < last && rank >= counts[child_pos]) {
+        rank -= counts[child_pos++];
+    }
+    return child_pos;
+}
+
+
+template<TYPES(typename)>
+auto IndexPage<TYPES()>::records_before(std::int32_t child_pos) -> std::int64_t {
+    return std::accumulate(counts.begin(), counts.begin() + child_pos, std::int64_t(0));
+}
+
+
 template<TYPES(typename)>
 auto IndexPage<TYPES()>::merge(IndexPage<TYPES()> &right_sibling, FieldType& new_key) -> void {
-    push_back(new_key, right_sibling.children[0]);
+    push_back(new_key, right_sibling.children[0], right_sibling.counts[0]);
     for (std::int32_t i = 0; i < right_sibling.len(); ++i) {
-        push_back(right_sibling.keys[i], right_sibling.children[i + 1]);
+        push_back(right_sibling.keys[i], right_sibling.children[i + 1], right_sibling.counts[i + 1]);
     }
 }
 
 
 template <typename FieldType>
 auto get_expected_index_page_capacity() -> std::int32_t {
+    if constexpr (!Serializer<FieldType>::fixed_size) {
+        return static_cast<std::int32_t>(
+                (get_buffer_size() - sizeof(std::int32_t) - sizeof(std::int64_t) - sizeof(bool)) /
+                (sizeof(std::int64_t) + sizeof(Slot)));
+    }
     return std::floor(
             static_cast<double>(get_buffer_size() - sizeof(std::int32_t) - sizeof(std::int64_t) - sizeof(bool))  /
             (sizeof(std::int64_t) + sizeof(FieldType))
@@ -0,0 +1,198 @@
+#include <bit>
+#include <algorithm>
+
+#include "key_search.hpp"
+
+
+template<typename FieldType, typename ElementType, typename Compare, typename Projection>
+auto branchless_lower_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection) -> std::size_t {
+    if (size == 0) {
+        return 0;
+    }
+
+    // The loop body compiles to a conditional move, so the amount of iterations only depends on the size
+    ElementType *base = first;
+    while (size > 1) {
+        std::size_t const half = size / 2;
+        base = gt(key, projection(base[half])) ? base + half : base;
+        size -= half;
+    }
+
+    return (base - first) + static_cast<std::size_t>(gt(key, projection(*base)));
+}
+
+
+template<typename FieldType, typename ElementType, typename Compare, typename Projection>
+auto branchless_upper_bound(ElementType *first, std::size_t size, const FieldType &key,
+                            Compare &gt, Projection &&projection) -> std::size_t {
+    if (size == 0) {
+        return 0;
+    }
+
+    ElementType *base = first;
+    while (size > 1) {
+        std::size_t const half = size / 2;
+        base = !gt(projection(base[half]), key) ? base + half : base;
+        size -= half;
+    }
+
+    return (base - first) + static_cast<std::size_t>(!gt(projection(*base), key));
+}
+
+
+template<typename FieldType, typename Compare, typename Enable>
+template<typename ElementType, typename Projection>
+auto KeySearch<FieldType, Compare, Enable>::lower_bound(ElementType *first, std::size_t size, const FieldType &key,
+                                                        Compare &gt, Projection &&projection) -> std::size_t {
+    return branchless_lower_bound(first, size, key, gt, projection);
+}
+
+
+template<typename FieldType, typename Compare, typename Enable>
+template<typename ElementType, typename Projection>
+auto KeySearch<FieldType, Compare, Enable>::upper_bound(ElementType *first, std::size_t size, const FieldType &key,
+                                                        Compare &gt, Projection &&projection) -> std::size_t {
+    return branchless_upper_bound(first, size, key, gt, projection);
+}
+
+
+template<typename FieldType, typename Compare>
+template<typename ElementType, typename Projection>
+auto KeySearch<FieldType, Compare, std::enable_if_t<is_simd_searchable<FieldType, Compare>>>::lower_bound(
+        ElementType *first, std::size_t size, const FieldType &key,
+        Compare &gt, Projection &&projection) -> std::size_t {
+    if constexpr (std::is_same_v<std::remove_cvref_t<Projection>, std::identity> &&
+                  std::is_same_v<std::remove_cv_t<ElementType>, FieldType>) {
+        // Binary search until the boundary lies in a small window, then count the preceding keys of the window
+        ElementType *base = first;
+        while (size > SIMD_SEARCH_WINDOW) {
+            std::size_t const half = size / 2;
+            base = gt(key, base[half]) ? base + half : base;
+            size -= half;
+        }
+        return (base - first) + count_preceding(base, size, key);
+    } else {
+        return branchless_lower_bound(first, size, key, gt, projection);
+    }
+}
+
+
+template<typename FieldType, typename Compare>
+template<typename ElementType, typename Projection>
+auto KeySearch<FieldType, Compare, std::enable_if_t<is_simd_searchable<FieldType, Compare>>>::upper_bound(
+        ElementType *first, std::size_t size, const FieldType &key,
+        Compare &gt, Projection &&projection) -> std::size_t {
+    return branchless_upper_bound(first, size, key, gt, projection);
+}
+
+
+template<typename FieldType, typename Compare>
+auto KeySearch<FieldType, Compare, std::enable_if_t<is_simd_searchable<FieldType, Compare>>>::count_preceding(
+        const FieldType *first, std::size_t size, const FieldType &key) -> std::size_t {
+    // With std::greater a key precedes the needle when it is smaller, with std::less when it is bigger
+    constexpr bool ascending = std::is_same_v<Compare, std::greater<FieldType>>;
+    std::size_t count = 0;
+    std::size_t i = 0;
+
+#if defined(B_PLUS_TREE_SIMD_SEARCH)
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<FieldType, std::int32_t>) {
+        __m256i const needle = _mm256_set1_epi32(key);
+        for (; i + 8 <= size; i += 8) {
+            __m256i const keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            __m256i const mask = ascending ? _mm256_cmpgt_epi32(needle, keys) : _mm256_cmpgt_epi32(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(mask))));
+        }
+    } else if constexpr (std::is_same_v<FieldType, std::int64_t>) {
+        __m256i const needle = _mm256_set1_epi64x(key);
+        for (; i + 4 <= size; i += 4) {
+            __m256i const keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            __m256i const mask = ascending ? _mm256_cmpgt_epi64(needle, keys) : _mm256_cmpgt_epi64(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(mask))));
+        }
+    } else if constexpr (std::is_same_v<FieldType, float>) {
+        __m256 const needle = _mm256_set1_ps(key);
+        for (; i + 8 <= size; i += 8) {
+            __m256 const keys = _mm256_loadu_ps(first + i);
+            __m256 const mask = ascending ? _mm256_cmp_ps(needle, keys, _CMP_GT_OQ)
+                                          : _mm256_cmp_ps(keys, needle, _CMP_GT_OQ);
+            count += std::popcount(static_cast<unsigned>(_mm256_movemask_ps(mask)));
+        }
+    } else if constexpr (std::is_same_v<FieldType, double>) {
+        __m256d const needle = _mm256_set1_pd(key);
+        for (; i + 4 <= size; i += 4) {
+            __m256d const keys = _mm256_loadu_pd(first + i);
+            __m256d const mask = ascending ? _mm256_cmp_pd(needle, keys, _CMP_GT_OQ)
+                                           : _mm256_cmp_pd(keys, needle, _CMP_GT_OQ);
+            count += std::popcount(static_cast<unsigned>(_mm256_movemask_pd(mask)));
+        }
+    }
+#else
+    if constexpr (std::is_same_v<FieldType, std::int32_t>) {
+        __m128i const needle = _mm_set1_epi32(key);
+        for (; i + 4 <= size; i += 4) {
+            __m128i const keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            __m128i const mask = ascending ? _mm_cmpgt_epi32(needle, keys) : _mm_cmpgt_epi32(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(mask))));
+        }
+    } else if constexpr (std::is_same_v<FieldType, std::int64_t>) {
+        __m128i const needle = _mm_set1_epi64x(key);
+        for (; i + 2 <= size; i += 2) {
+            __m128i const keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            __m128i const mask = ascending ? _mm_cmpgt_epi64(needle, keys) : _mm_cmpgt_epi64(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(mask))));
+        }
+    } else if constexpr (std::is_same_v<FieldType, float>) {
+        __m128 const needle = _mm_set1_ps(key);
+        for (; i + 4 <= size; i += 4) {
+            __m128 const keys = _mm_loadu_ps(first + i);
+            __m128 const mask = ascending ? _mm_cmpgt_ps(needle, keys) : _mm_cmpgt_ps(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm_movemask_ps(mask)));
+        }
+    } else if constexpr (std::is_same_v<FieldType, double>) {
+        __m128d const needle = _mm_set1_pd(key);
+        for (; i + 2 <= size; i += 2) {
+            __m128d const keys = _mm_loadu_pd(first + i);
+            __m128d const mask = ascending ? _mm_cmpgt_pd(needle, keys) : _mm_cmpgt_pd(keys, needle);
+            count += std::popcount(static_cast<unsigned>(_mm_movemask_pd(mask)));
+        }
+    }
+#endif
+#endif
+
+    for (; i < size; ++i) {
+        count += static_cast<std::size_t>(ascending ? first[i] < key : key < first[i]);
+    }
+    return count;
+}
+
+
+inline auto shared_prefix_length(const std::string &a, const std::string &b) -> std::size_t {
+    auto const [end_a, end_b] = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+    return end_a - a.begin();
+}
+
+
+template<typename FieldType, typename Compare, typename Enable>
+auto SeparatorTruncation<FieldType, Compare, Enable>::between(const FieldType &left, const FieldType &) -> FieldType {
+    return left;
+}
+
+
+template<typename FieldType, typename Compare>
+auto SeparatorTruncation<FieldType, Compare, std::enable_if_t<is_lexicographic<FieldType, Compare>>>::between(
+        const FieldType &left, const FieldType &right) -> FieldType {
+    constexpr bool ascending = std::is_same_v<Compare, std::greater<std::string>> ||
+                               std::is_same_v<Compare, std::greater<>>;
+    std::size_t const shared = shared_prefix_length(left, right);
+
+    // the lexicographically greater key cut right after the first byte telling them apart. In ascending order it
+    // must still be less than the right key, so it may not be the whole key.
+    const std::string &greater = ascending ? right : left;
+    if (shared + 1 > greater.size() || (ascending && shared + 1 == greater.size())) {
+        return left;
+    }
+    std::string separator = greater.substr(0, shared + 1);
+    return separator.size() < left.size() ? separator : left;
+}
@@ -0,0 +1,172 @@
+#include <cstring>
+#include <algorithm>
+
+#include "leaf_codec.hpp"
+
+
+// Largest run length held by the nibbles of a control byte, longer runs continue in a varint
+constexpr std::size_t NIBBLE_LIMIT = 15;
+
+
+// Tags of the encoded records
+enum DeltaTag : std::uint8_t {
+    wholeRecord = 0,  // the record follows as it is
+    runsRecord  = 1   // the XOR with the previous record follows as runs of zeros and literals
+};
+
+
+static auto varint_size(std::size_t value) -> std::int32_t {
+    std::int32_t size = 1;
+    for (; value >= 0x80; value >>= 7) {
+        ++size;
+    }
+    return size;
+}
+
+
+static auto write_varint(std::size_t value, char *out) -> std::int32_t {
+    std::int32_t size = 0;
+    for (; value >= 0x80; value >>= 7) {
+        out[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    }
+    out[size++] = static_cast<char>(value);
+    return size;
+}
+
+
+static auto read_varint(const char *in, std::size_t &value) -> std::int32_t {
+    std::int32_t size = 0;
+    value = 0;
+    for (int shift = 0;; shift += 7) {
+        auto const byte = static_cast<std::uint8_t>(in[size++]);
+        value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return size;
+        }
+    }
+}
+
+
+static auto xor_byte(const char *record, const char *previous, std::size_t i) -> char {
+    return previous ? static_cast<char>(record[i] ^ previous[i]) : record[i];
+}
+
+
+// Visits the runs of the XOR of both records as (zeros, literals) pairs, the last one may have no literals
+template<typename Visitor>
+static auto for_each_run(const char *record, const char *previous, std::size_t size, Visitor &&visit) -> void {
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t const zeros_start = i;
+        while (i < size && xor_byte(record, previous, i) == 0) {
+            ++i;
+        }
+        std::size_t const literals_start = i;
+        while (i < size && xor_byte(record, previous, i) != 0) {
+            ++i;
+        }
+        visit(literals_start - zeros_start, literals_start, i - literals_start);
+    }
+}
+
+
+// Each run starts with a control byte holding both lengths in its nibbles, a nibble at NIBBLE_LIMIT is followed
+// by a varint with the rest of the length
+static auto control_size(std::size_t zeros, std::size_t literals) -> std::int32_t {
+    std::int32_t size = 1;
+    if (zeros >= NIBBLE_LIMIT) {
+        size += varint_size(zeros - NIBBLE_LIMIT);
+    }
+    if (literals >= NIBBLE_LIMIT) {
+        size += varint_size(literals - NIBBLE_LIMIT);
+    }
+    return size;
+}
+
+
+static auto write_control(std::size_t zeros, std::size_t literals, char *out) -> std::int32_t {
+    out[0] = static_cast<char>((std::min(zeros, NIBBLE_LIMIT) << 4) | std::min(literals, NIBBLE_LIMIT));
+    std::int32_t size = 1;
+    if (zeros >= NIBBLE_LIMIT) {
+        size += write_varint(zeros - NIBBLE_LIMIT, out + size);
+    }
+    if (literals >= NIBBLE_LIMIT) {
+        size += write_varint(literals - NIBBLE_LIMIT, out + size);
+    }
+    return size;
+}
+
+
+static auto read_control(const char *in, std::size_t &zeros, std::size_t &literals) -> std::int32_t {
+    auto const control = static_cast<std::uint8_t>(in[0]);
+    zeros = control >> 4;
+    literals = control & 0x0f;
+    std::int32_t size = 1;
+    std::size_t rest = 0;
+    if (zeros == NIBBLE_LIMIT) {
+        size += read_varint(in + size, rest);
+        zeros += rest;
+    }
+    if (literals == NIBBLE_LIMIT) {
+        size += read_varint(in + size, rest);
+        literals += rest;
+    }
+    return size;
+}
+
+
+static auto runs_size(const char *record, const char *previous, std::size_t size) -> std::int32_t {
+    std::int32_t bytes = 0;
+    for_each_run(record, previous, size, [&bytes](std::size_t zeros, std::size_t, std::size_t literals) {
+        bytes += control_size(zeros, literals) + static_cast<std::int32_t>(literals);
+    });
+    return bytes;
+}
+
+
+auto delta_size(const char *record, const char *previous, std::size_t size) -> std::int32_t {
+    return DELTA_OVERHEAD + std::min(runs_size(record, previous, size), static_cast<std::int32_t>(size));
+}
+
+
+auto encode_delta(const char *record, const char *previous, std::size_t size, char *out) -> std::int32_t {
+    if (runs_size(record, previous, size) >= static_cast<std::int32_t>(size)) {
+        out[0] = static_cast<char>(wholeRecord);
+        std::memcpy(out + DELTA_OVERHEAD, record, size);
+        return DELTA_OVERHEAD + static_cast<std::int32_t>(size);
+    }
+
+    out[0] = static_cast<char>(runsRecord);
+    std::int32_t offset = DELTA_OVERHEAD;
+    for_each_run(record, previous, size, [&](std::size_t zeros, std::size_t start, std::size_t literals) {
+        offset += write_control(zeros, literals, out + offset);
+        for (std::size_t i = start; i < start + literals; ++i) {
+            out[offset++] = xor_byte(record, previous, i);
+        }
+    });
+    return offset;
+}
+
+
+auto decode_delta(const char *in, const char *previous, std::size_t size, char *record) -> std::int32_t {
+    if (static_cast<std::uint8_t>(in[0]) == wholeRecord) {
+        std::memcpy(record, in + DELTA_OVERHEAD, size);
+        return DELTA_OVERHEAD + static_cast<std::int32_t>(size);
+    }
+
+    std::int32_t offset = DELTA_OVERHEAD;
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t zeros = 0;
+        std::size_t literals = 0;
+        offset += read_control(in + offset, zeros, literals);
+        for (std::size_t end = i + zeros; i < end; ++i) {
+            record[i] = previous ? previous[i] : 0;
+        }
+        for (std::size_t end = i + literals; i < end; ++i) {
+            char const byte = in[offset++];
+            record[i] = previous ? static_cast<char>(byte ^ previous[i]) : byte;
+        }
+    }
+    return offset;
+}
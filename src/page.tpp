@@ -26,14 +26,76 @@ auto Page<TYPES()>::is_empty() -> bool {
 }
 
 
+template<TYPES(typename)>
+auto Page<TYPES()>::entry_limit() -> std::int32_t {
+    return page_size() / MAX_ENTRY_FRACTION;
+}
+
+
+template<TYPES(typename)>
+auto Page<TYPES()>::high_water() -> std::int32_t {
+    return page_size() - header_size() - 2 * entry_limit();
+}
+
+
+template<TYPES(typename)>
+auto Page<TYPES()>::low_water() -> std::int32_t {
+    return (page_size() - header_size()) / MIN_FILL_FRACTION;
+}
+
+
+template<TYPES(typename)>
+auto Page<TYPES()>::page_size() -> std::int32_t {
+    std::int32_t const padded_size = this->tree->properties.PAGE_SIZE;
+    return (padded_size > 0) ? padded_size : bytes_len();
+}
+
+
 template<TYPES(typename)>
 auto Page<TYPES()>::save(std::streampos pos) -> void {
-    seek(this->tree->b_plus_index_file, pos);
-    write();
+    ++this->tree->version;
+
+    // Backends exposing the file in memory are written in place, the OS page cache plays the role of the pool
+    this->tree->statistics.page_saved(type());
+
+    if (char *view = this->tree->storage->view(pos, page_size(), true)) {
+        write(view);
+        return;
+    }
+
+    // The whole page is overwritten, so there is no need to fetch its previous content, unless a logged
+    // operation has to put it back when it fails
+    bool const logged = this->tree->log != nullptr;
+    char *frame = this->tree->buffer_pool.pin(pos, page_size(), logged);
+    std::vector<char> previous_image;
+    if (logged) {
+        previous_image.assign(frame, frame + page_size());
+    }
+    write(frame);
+
+    // pages written by a logged operation stay pinned until their image is durable in the log
+    bool const staged = logged && this->tree->log->stage(pos, previous_image.data(), frame, page_size());
+    if (!staged) {
+        this->tree->buffer_pool.unpin(pos, true);
+    }
 }
 
 template<typename KeyType, typename RecordType, typename Greater, typename Index>
 auto Page<KeyType, RecordType, Greater, Index>::load(std::streampos pos) -> void {
-    seek(this->tree->b_plus_index_file, pos);
-    read();
+    this->tree->statistics.page_loaded(type());
+
+    if (const char *view = this->tree->storage->view(pos, page_size(), false)) {
+        read(view);
+        return;
+    }
+
+    char *frame = this->tree->buffer_pool.pin(pos, page_size());
+    read(frame);
+    this->tree->buffer_pool.unpin(pos, false);
+}
+
+
+template<TYPES(typename)>
+auto Page<TYPES()>::prefetch(std::streampos pos) -> void {
+    this->tree->buffer_pool.prefetch(pos, page_size());
 }
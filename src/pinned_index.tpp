@@ -0,0 +1,106 @@
+#include "pinned_index.hpp"
+
+
+template<TYPES(typename)>
+PinnedIndex<TYPES()>::PinnedIndex(BPlusTree<TYPES()> *tree)
+        : tree(tree), stride(0), valid(false) {}
+
+
+template<TYPES(typename)>
+auto PinnedIndex<TYPES()>::build() -> void {
+    stride = tree->properties.MAX_INDEX_PAGE_CAPACITY;
+    keys.clear();
+    children.clear();
+    num_keys.clear();
+    first_child.clear();
+    nodes.clear();
+
+    // the queue of pages to visit doubles as the node numbering
+    std::vector<std::int64_t> positions { tree->properties.SEEK_ROOT };
+    IndexPage<TYPES()> index_page(tree);
+
+    for (std::size_t node = 0; node < positions.size(); ++node) {
+        index_page.load(positions[node]);
+        nodes.emplace(positions[node], static_cast<std::int32_t>(node));
+        keys.insert(keys.end(), index_page.keys.begin(), index_page.keys.begin() + stride);
+        children.insert(children.end(), index_page.children.begin(), index_page.children.begin() + stride + 1);
+        num_keys.push_back(index_page.num_keys);
+
+        if (index_page.points_to_leaf) {
+            first_child.push_back(-1);
+        } else {
+            first_child.push_back(static_cast<std::int32_t>(positions.size()));
+            positions.insert(positions.end(), index_page.children.begin(),
+                             index_page.children.begin() + index_page.num_keys + 1);
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto PinnedIndex<TYPES()>::locate(const FieldType &key, bool last) -> LeafLocation<FieldType> {
+    if (!valid.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(build_latch);
+        if (!valid.load(std::memory_order_relaxed)) {
+            build();
+            valid.store(true, std::memory_order_release);
+        }
+    }
+
+    LeafLocation<FieldType> location { emptyPage, std::nullopt, false };
+    std::size_t node = 0;
+    while (true) {
+        const FieldType *node_keys = keys.data() + node * stride;
+        std::size_t const size = num_keys[node];
+        std::size_t const child_pos = last
+                ? KeySearch<FieldType, Compare>::upper_bound(node_keys, size, key, tree->gt)
+                : KeySearch<FieldType, Compare>::lower_bound(node_keys, size, key, tree->gt);
+
+        // separators found deeper in the tree are tighter
+        if (child_pos < size) {
+            location.upper_fence = node_keys[child_pos];
+            location.separator_match = location.separator_match || !tree->gt(node_keys[child_pos], key);
+        }
+
+        if (first_child[node] < 0) {
+            location.seek_page = children[node * (stride + 1) + child_pos];
+            return location;
+        }
+        node = first_child[node] + child_pos;
+    }
+}
+
+
+template<TYPES(typename)>
+auto PinnedIndex<TYPES()>::update(std::streampos pos, IndexPage<TYPES()> &page) -> void {
+    if (!valid.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // nodes pointing to index pages are only patched while their children keep their numbering
+    auto const it = nodes.find(pos);
+    if (it == nodes.end() ||
+        page.points_to_leaf != (first_child[it->second] < 0) ||
+        (!page.points_to_leaf && page.num_keys != num_keys[it->second])) {
+        invalidate();
+        return;
+    }
+
+    std::size_t const node = it->second;
+    std::copy(page.keys.begin(), page.keys.begin() + stride, keys.begin() + node * stride);
+    std::copy(page.children.begin(), page.children.begin() + stride + 1, children.begin() + node * (stride + 1));
+    num_keys[node] = page.num_keys;
+}
+
+
+template<TYPES(typename)>
+auto PinnedIndex<TYPES()>::invalidate() -> void {
+    valid.store(false, std::memory_order_release);
+}
+
+
+template<TYPES(typename)>
+auto PinnedIndex<TYPES()>::memory_usage() const -> std::size_t {
+    return keys.capacity() * sizeof(FieldType) + children.capacity() * sizeof(std::int64_t) +
+           (num_keys.capacity() + first_child.capacity()) * sizeof(std::int32_t);
+}
@@ -9,7 +9,13 @@ Property::Property(std::string directory_path,
                    const std::string &index_file_name,
                    int32_t index_page_capacity,
                    int32_t data_page_capacity,
-                   bool unique)
+                   bool unique,
+                   int32_t buffer_pool_capacity,
+                   StorageBackend storage_backend,
+                   bool durable,
+                   bool pinned_index,
+                   bool compressed_leaves,
+                   bool subtree_counts)
         : DIRECTORY_PATH(std::move(directory_path)),
           INDEX_FILE_NAME(index_file_name + ".tree"),
           METADATA_FILE_NAME(metadata_file_name + ".meta"),
@@ -17,7 +23,16 @@ Property::Property(std::string directory_path,
           MAX_INDEX_PAGE_CAPACITY(index_page_capacity),
           MAX_DATA_PAGE_CAPACITY(data_page_capacity),
           ROOT_STATUS(emptyPage),
-          UNIQUE(unique) {
+          FREE_DATA_PAGE_HEAD(emptyPage),
+          FREE_INDEX_PAGE_HEAD(emptyPage),
+          PAGE_SIZE(0),
+          UNIQUE(unique),
+          COMPRESSED_LEAVES(compressed_leaves),
+          SUBTREE_COUNTS(subtree_counts),
+          BUFFER_POOL_CAPACITY(buffer_pool_capacity),
+          STORAGE_BACKEND(storage_backend),
+          DURABLE(durable),
+          PINNED_INDEX(pinned_index) {
     INDEX_FULL_PATH = DIRECTORY_PATH + INDEX_FILE_NAME;
     METADATA_FULL_PATH = DIRECTORY_PATH + METADATA_FILE_NAME;
     MIN_INDEX_PAGE_CAPACITY = static_cast<std::int32_t>(std::ceil(MAX_INDEX_PAGE_CAPACITY / 2.0)) - 1;
@@ -31,6 +46,21 @@ void Property::load(std::fstream &file) {
     file >> DIRECTORY_PATH >> INDEX_FILE_NAME >> METADATA_FILE_NAME >> SEEK_ROOT
          >> MAX_INDEX_PAGE_CAPACITY >> MAX_DATA_PAGE_CAPACITY >> ROOT_STATUS >> UNIQUE;
 
+    // metadata files written before the free lists and the fixed page size existed end earlier
+    if (!(file >> FREE_DATA_PAGE_HEAD >> FREE_INDEX_PAGE_HEAD)) {
+        FREE_DATA_PAGE_HEAD = emptyPage;
+        FREE_INDEX_PAGE_HEAD = emptyPage;
+    }
+    if (!(file >> PAGE_SIZE)) {
+        PAGE_SIZE = 0;
+    }
+    if (!(file >> COMPRESSED_LEAVES)) {
+        COMPRESSED_LEAVES = false;
+    }
+    if (!(file >> SUBTREE_COUNTS)) {
+        SUBTREE_COUNTS = false;
+    }
+
     INDEX_FULL_PATH = DIRECTORY_PATH + INDEX_FILE_NAME;
     METADATA_FULL_PATH = DIRECTORY_PATH + METADATA_FILE_NAME;
     MIN_INDEX_PAGE_CAPACITY = static_cast<std::int32_t>(std::ceil(MAX_INDEX_PAGE_CAPACITY / 2.0)) - 1;
@@ -42,5 +72,7 @@ void Property::load(std::fstream &file) {
 
 void Property::save(std::fstream &file) const {
     file << DIRECTORY_PATH << "\n" << INDEX_FILE_NAME << "\n" << METADATA_FILE_NAME << "\n" << SEEK_ROOT << "\n"
-         << MAX_INDEX_PAGE_CAPACITY << "\n" << MAX_DATA_PAGE_CAPACITY << "\n" << ROOT_STATUS << "\n" << UNIQUE;
+         << MAX_INDEX_PAGE_CAPACITY << "\n" << MAX_DATA_PAGE_CAPACITY << "\n" << ROOT_STATUS << "\n" << UNIQUE << "\n"
+         << FREE_DATA_PAGE_HEAD << "\n" << FREE_INDEX_PAGE_HEAD << "\n" << PAGE_SIZE << "\n" << COMPRESSED_LEAVES << "\n"
+         << SUBTREE_COUNTS;
 }
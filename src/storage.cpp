@@ -0,0 +1,603 @@
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "storage.hpp"
+#include "error_handler.hpp"
+
+#if defined(B_PLUS_TREE_IO_URING)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+
+Storage::~Storage() = default;
+
+
+auto Storage::view(std::int64_t /*pos*/, std::size_t /*size*/, bool /*writable*/) -> char* {
+    return nullptr;
+}
+
+
+auto Storage::prefetch(std::int64_t /*pos*/, std::size_t /*size*/) -> void {
+}
+
+
+auto Storage::sync() -> void {
+    flush();
+}
+
+
+auto Storage::read_batch(const std::vector<IORequest> &requests) -> void {
+    for (const IORequest &request: requests) {
+        std::size_t const bytes_read = read(request.pos, request.buffer, request.size);
+        std::fill(request.buffer + bytes_read, request.buffer + request.size, 0);
+    }
+}
+
+
+auto Storage::write_batch(const std::vector<IORequest> &requests) -> void {
+    for (const IORequest &request: requests) {
+        write(request.pos, request.buffer, request.size);
+    }
+}
+
+
+StreamStorage::StreamStorage(const std::string &file_name): advice_descriptor(-1) {
+    file.open(file_name, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        throw OpenFileError();
+    }
+#if defined(__unix__)
+    advice_descriptor = ::open(file_name.c_str(), O_RDONLY);
+#endif
+}
+
+
+StreamStorage::~StreamStorage() {
+    file.close();
+#if defined(__unix__)
+    if (advice_descriptor >= 0) {
+        ::close(advice_descriptor);
+    }
+#endif
+}
+
+
+auto StreamStorage::read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t {
+    std::lock_guard<std::mutex> lock(latch);
+    file.clear();
+    file.seekg(pos);
+    file.read(buffer, static_cast<std::streamsize>(size));
+    std::streamsize const bytes_read = std::max<std::streamsize>(file.gcount(), 0);
+    file.clear();
+    return bytes_read;
+}
+
+
+auto StreamStorage::write(std::int64_t pos, const char *buffer, std::size_t size) -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    file.clear();
+    file.seekp(pos);
+    file.write(buffer, static_cast<std::streamsize>(size));
+}
+
+
+auto StreamStorage::prefetch(std::int64_t pos, std::size_t size) -> void {
+#if defined(__unix__)
+    // The advice applies to the page cache of the file, so any descriptor of it will do
+    if (advice_descriptor >= 0) {
+        posix_fadvise(advice_descriptor, pos, static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
+
+auto StreamStorage::size() -> std::int64_t {
+    std::lock_guard<std::mutex> lock(latch);
+    file.clear();
+    file.seekp(0, std::ios::end);
+    return std::max<std::int64_t>(file.tellp(), 0);
+}
+
+
+auto StreamStorage::flush() -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    file.flush();
+}
+
+
+auto StreamStorage::sync() -> void {
+    flush();
+#if defined(__unix__)
+    if (advice_descriptor >= 0 && fsync(advice_descriptor) != 0) {
+        throw IOError();
+    }
+#endif
+}
+
+
+#if defined(__unix__)
+
+PositionalStorage::PositionalStorage(const std::string &file_name) {
+    file_descriptor = ::open(file_name.c_str(), O_RDWR);
+    if (file_descriptor < 0) {
+        throw OpenFileError();
+    }
+}
+
+
+PositionalStorage::~PositionalStorage() {
+    ::close(file_descriptor);
+}
+
+
+auto PositionalStorage::read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t {
+    std::size_t bytes_read = 0;
+    while (bytes_read < size) {
+        ssize_t const result = pread(file_descriptor, buffer + bytes_read, size - bytes_read,
+                                     static_cast<off_t>(pos + static_cast<std::int64_t>(bytes_read)));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0) {
+            throw IOError();
+        }
+        if (result == 0) {
+            break;
+        }
+        bytes_read += result;
+    }
+    return bytes_read;
+}
+
+
+auto PositionalStorage::write(std::int64_t pos, const char *buffer, std::size_t size) -> void {
+    std::size_t bytes_written = 0;
+    while (bytes_written < size) {
+        ssize_t const result = pwrite(file_descriptor, buffer + bytes_written, size - bytes_written,
+                                      static_cast<off_t>(pos + static_cast<std::int64_t>(bytes_written)));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw IOError();
+        }
+        bytes_written += result;
+    }
+}
+
+
+auto PositionalStorage::prefetch(std::int64_t pos, std::size_t size) -> void {
+    posix_fadvise(file_descriptor, pos, static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+}
+
+
+auto PositionalStorage::size() -> std::int64_t {
+    struct stat file_status {};
+    fstat(file_descriptor, &file_status);
+    return file_status.st_size;
+}
+
+
+auto PositionalStorage::flush() -> void {
+    // Every write already reached the OS page cache
+}
+
+
+auto PositionalStorage::sync() -> void {
+    if (fsync(file_descriptor) != 0) {
+        throw IOError();
+    }
+}
+
+
+MmapStorage::MmapStorage(const std::string &file_name): base(nullptr), mapped_size(0) {
+    file_descriptor = ::open(file_name.c_str(), O_RDWR);
+    if (file_descriptor < 0) {
+        throw OpenFileError();
+    }
+
+    void *reservation = mmap(nullptr, MMAP_ADDRESS_RESERVATION, PROT_NONE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reservation == MAP_FAILED) {
+        ::close(file_descriptor);
+        throw OpenFileError();
+    }
+    base = static_cast<char*>(reservation);
+
+    struct stat file_status {};
+    fstat(file_descriptor, &file_status);
+    logical_size = file_status.st_size;
+    reserve(std::max<std::int64_t>(logical_size, 1));
+}
+
+
+MmapStorage::~MmapStorage() {
+    munmap(base, MMAP_ADDRESS_RESERVATION);
+    // drops the unused tail of the last chunk, which only holds zeroes if it cannot be removed
+    if (ftruncate(file_descriptor, logical_size) != 0) {
+        logical_size = mapped_size.load();
+    }
+    ::close(file_descriptor);
+}
+
+
+auto MmapStorage::reserve(std::int64_t min_size) -> void {
+    std::lock_guard<std::mutex> lock(growth_latch);
+    std::int64_t const current_size = mapped_size;
+    if (min_size <= current_size) {
+        return;
+    }
+
+    std::int64_t const new_size = (min_size + MMAP_GROWTH_CHUNK - 1) / MMAP_GROWTH_CHUNK * MMAP_GROWTH_CHUNK;
+    if (new_size > MMAP_ADDRESS_RESERVATION || ftruncate(file_descriptor, new_size) != 0) {
+        throw CreateFileError();
+    }
+
+    // the new chunks replace their part of the reservation, the chunk size keeps the offset page aligned
+    void *mapping = mmap(base + current_size, new_size - current_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, file_descriptor, current_size);
+    if (mapping == MAP_FAILED) {
+        throw OpenFileError();
+    }
+
+    mapped_size = new_size;
+}
+
+
+auto MmapStorage::read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t {
+    std::int64_t const available = std::clamp<std::int64_t>(logical_size - pos, 0, static_cast<std::int64_t>(size));
+    memcpy(buffer, base + pos, available);
+    return available;
+}
+
+
+auto MmapStorage::write(std::int64_t pos, const char *buffer, std::size_t size) -> void {
+    memcpy(view(pos, size, true), buffer, size);
+}
+
+
+auto MmapStorage::view(std::int64_t pos, std::size_t size, bool writable) -> char* {
+    std::int64_t const end = pos + static_cast<std::int64_t>(size);
+    if (writable) {
+        reserve(end);
+        std::int64_t current_size = logical_size;
+        while (current_size < end && !logical_size.compare_exchange_weak(current_size, end)) {
+        }
+    } else if (end > mapped_size) {
+        return nullptr;
+    }
+    return base + pos;
+}
+
+
+auto MmapStorage::prefetch(std::int64_t pos, std::size_t size) -> void {
+    std::int64_t const end = std::min(pos + static_cast<std::int64_t>(size), mapped_size.load());
+    if (pos >= end) {
+        return;
+    }
+
+    // madvise expects an address aligned to the system page
+    std::int64_t const system_page = sysconf(_SC_PAGESIZE);
+    std::int64_t const start = pos / system_page * system_page;
+    madvise(base + start, end - start, MADV_WILLNEED);
+}
+
+
+auto MmapStorage::size() -> std::int64_t {
+    return logical_size;
+}
+
+
+auto MmapStorage::flush() -> void {
+    // Writes to the mapping are already visible through the OS page cache
+}
+
+
+auto MmapStorage::sync() -> void {
+    if (msync(base, mapped_size, MS_SYNC) != 0 || fsync(file_descriptor) != 0) {
+        throw IOError();
+    }
+}
+
+#endif
+
+
+#if defined(B_PLUS_TREE_IO_URING)
+
+// Tag of the completions that belong to read-ahead hints
+constexpr std::uint64_t HINT_TAG = ~0ULL;
+
+
+static auto io_uring_setup(std::uint32_t entries, io_uring_params *params) -> int {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+
+static auto io_uring_enter(int ring_descriptor, std::uint32_t to_submit, std::uint32_t min_complete,
+                           std::uint32_t flags) -> int {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_descriptor, to_submit, min_complete, flags,
+                                    nullptr, 0));
+}
+
+
+UringStorage::UringStorage(const std::string &file_name)
+        : file_descriptor(-1), ring_descriptor(-1),
+          submission_ring(MAP_FAILED), submission_ring_size(0),
+          completion_ring(MAP_FAILED), completion_ring_size(0),
+          submission_entries(MAP_FAILED), submission_entries_size(0),
+          pending_hints(0) {
+    io_uring_params params {};
+    ring_descriptor = io_uring_setup(URING_QUEUE_DEPTH, &params);
+
+    // IORING_OP_READ, IORING_OP_WRITE and IORING_OP_FADVISE came along with IORING_FEAT_RW_CUR_POS
+    if (ring_descriptor < 0 || !(params.features & IORING_FEAT_RW_CUR_POS)) {
+        release_rings();
+        throw OpenFileError();
+    }
+
+    submission_ring_size = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+    completion_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool const single_mapping = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mapping) {
+        submission_ring_size = completion_ring_size = std::max(submission_ring_size, completion_ring_size);
+    }
+
+    submission_ring = mmap(nullptr, submission_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_descriptor, IORING_OFF_SQ_RING);
+    completion_ring = single_mapping ? submission_ring
+            : mmap(nullptr, completion_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_descriptor, IORING_OFF_CQ_RING);
+    submission_entries_size = params.sq_entries * sizeof(io_uring_sqe);
+    submission_entries = mmap(nullptr, submission_entries_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ring_descriptor, IORING_OFF_SQES);
+
+    file_descriptor = ::open(file_name.c_str(), O_RDWR);
+    if (submission_ring == MAP_FAILED || completion_ring == MAP_FAILED || submission_entries == MAP_FAILED ||
+        file_descriptor < 0) {
+        release_rings();
+        throw OpenFileError();
+    }
+
+    char *submission_base = static_cast<char*>(submission_ring);
+    submission_head = reinterpret_cast<std::uint32_t*>(submission_base + params.sq_off.head);
+    submission_tail = reinterpret_cast<std::uint32_t*>(submission_base + params.sq_off.tail);
+    submission_mask = *reinterpret_cast<std::uint32_t*>(submission_base + params.sq_off.ring_mask);
+    submission_entries_count = params.sq_entries;
+    submission_array = reinterpret_cast<std::uint32_t*>(submission_base + params.sq_off.array);
+
+    char *completion_base = static_cast<char*>(completion_ring);
+    completion_head = reinterpret_cast<std::uint32_t*>(completion_base + params.cq_off.head);
+    completion_tail = reinterpret_cast<std::uint32_t*>(completion_base + params.cq_off.tail);
+    completion_mask = *reinterpret_cast<std::uint32_t*>(completion_base + params.cq_off.ring_mask);
+    completions = completion_base + params.cq_off.cqes;
+}
+
+
+UringStorage::~UringStorage() {
+    // hints still in flight are dropped along with the ring
+    release_rings();
+}
+
+
+auto UringStorage::release_rings() -> void {
+    if (submission_entries != MAP_FAILED) {
+        munmap(submission_entries, submission_entries_size);
+    }
+    if (completion_ring != MAP_FAILED && completion_ring != submission_ring) {
+        munmap(completion_ring, completion_ring_size);
+    }
+    if (submission_ring != MAP_FAILED) {
+        munmap(submission_ring, submission_ring_size);
+    }
+    if (ring_descriptor >= 0) {
+        ::close(ring_descriptor);
+    }
+    if (file_descriptor >= 0) {
+        ::close(file_descriptor);
+    }
+}
+
+
+auto UringStorage::enqueue(std::uint8_t opcode, std::int64_t pos, char *buffer, std::size_t size,
+                           std::uint64_t tag) -> void {
+    // the kernel only moves the head, so the tail can be read without synchronization
+    std::uint32_t const tail = *submission_tail;
+    std::uint32_t const index = tail & submission_mask;
+
+    io_uring_sqe &entry = static_cast<io_uring_sqe*>(submission_entries)[index];
+    entry = {};
+    entry.opcode = opcode;
+    entry.fd = file_descriptor;
+    entry.off = pos;
+    entry.addr = reinterpret_cast<std::uint64_t>(buffer);
+    entry.len = static_cast<std::uint32_t>(size);
+    entry.user_data = tag;
+    if (opcode == IORING_OP_FADVISE) {
+        entry.fadvise_advice = POSIX_FADV_WILLNEED;
+    }
+
+    submission_array[index] = index;
+    std::atomic_ref<std::uint32_t>(*submission_tail).store(tail + 1, std::memory_order_release);
+}
+
+
+auto UringStorage::enter(std::uint32_t to_submit, std::uint32_t min_complete) -> void {
+    std::uint32_t const flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+    while (to_submit > 0 || min_complete > 0) {
+        int const result = io_uring_enter(ring_descriptor, to_submit, min_complete, flags);
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            throw IOError();
+        }
+        // the wait is only requested once every entry has been submitted
+        to_submit -= std::min<std::uint32_t>(result, to_submit);
+        if (to_submit == 0) {
+            break;
+        }
+    }
+}
+
+
+auto UringStorage::reap(const std::function<void(std::uint64_t tag, std::int32_t result)> &on_completion)
+        -> std::uint32_t {
+    std::uint32_t head = *completion_head;
+    std::uint32_t const tail = std::atomic_ref<std::uint32_t>(*completion_tail).load(std::memory_order_acquire);
+    std::uint32_t reaped = 0;
+
+    for (; head != tail; ++head) {
+        const io_uring_cqe &completion = static_cast<io_uring_cqe*>(completions)[head & completion_mask];
+        if (completion.user_data == HINT_TAG) {
+            --pending_hints;
+            continue;
+        }
+        on_completion(completion.user_data, completion.res);
+        ++reaped;
+    }
+
+    std::atomic_ref<std::uint32_t>(*completion_head).store(head, std::memory_order_release);
+    return reaped;
+}
+
+
+auto UringStorage::submit(std::uint8_t opcode, const std::vector<IORequest> &requests) -> std::vector<std::size_t> {
+    std::lock_guard<std::mutex> lock(latch);
+    std::vector<std::size_t> transferred(requests.size(), 0);
+    std::vector<std::size_t> outstanding(requests.size());
+    std::iota(outstanding.begin(), outstanding.end(), 0);
+
+    while (!outstanding.empty()) {
+        auto const batch_size = static_cast<std::uint32_t>(
+                std::min<std::size_t>(outstanding.size(), submission_entries_count));
+
+        for (std::uint32_t i = 0; i < batch_size; ++i) {
+            std::size_t const r = outstanding[i];
+            enqueue(opcode, requests[r].pos + static_cast<std::int64_t>(transferred[r]),
+                    requests[r].buffer + transferred[r], requests[r].size - transferred[r], r);
+        }
+        enter(batch_size, batch_size);
+
+        // short transfers are resubmitted, a read returning no bytes has reached the end of the file
+        std::vector<std::size_t> unfinished(outstanding.begin() + batch_size, outstanding.end());
+        bool failed = false;
+        std::uint32_t completed = 0;
+        while (completed < batch_size) {
+            completed += reap([&](std::uint64_t tag, std::int32_t result) {
+                if (result == -EINTR || result == -EAGAIN) {
+                    unfinished.push_back(tag);
+                } else if (result < 0 || (result == 0 && opcode == IORING_OP_WRITE)) {
+                    failed = true;
+                } else if (result > 0) {
+                    transferred[tag] += result;
+                    if (transferred[tag] < requests[tag].size) {
+                        unfinished.push_back(tag);
+                    }
+                }
+            });
+            if (completed < batch_size) {
+                enter(0, 1);
+            }
+        }
+
+        if (failed) {
+            throw IOError();
+        }
+        outstanding = std::move(unfinished);
+    }
+
+    return transferred;
+}
+
+
+auto UringStorage::read(std::int64_t pos, char *buffer, std::size_t size) -> std::size_t {
+    return submit(IORING_OP_READ, { IORequest { pos, buffer, size } })[0];
+}
+
+
+auto UringStorage::write(std::int64_t pos, const char *buffer, std::size_t size) -> void {
+    // the buffer is only read by the kernel
+    submit(IORING_OP_WRITE, { IORequest { pos, const_cast<char*>(buffer), size } });
+}
+
+
+auto UringStorage::read_batch(const std::vector<IORequest> &requests) -> void {
+    std::vector<std::size_t> const bytes_read = submit(IORING_OP_READ, requests);
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        std::fill(requests[i].buffer + bytes_read[i], requests[i].buffer + requests[i].size, 0);
+    }
+}
+
+
+auto UringStorage::write_batch(const std::vector<IORequest> &requests) -> void {
+    submit(IORING_OP_WRITE, requests);
+}
+
+
+auto UringStorage::prefetch(std::int64_t pos, std::size_t size) -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    reap([](std::uint64_t, std::int32_t) {});
+
+    // bounds the hints in flight, so that the completion ring never overflows
+    if (pending_hints >= submission_entries_count) {
+        return;
+    }
+
+    enqueue(IORING_OP_FADVISE, pos, nullptr, size, HINT_TAG);
+    enter(1, 0);
+    ++pending_hints;
+}
+
+
+auto UringStorage::size() -> std::int64_t {
+    struct stat file_status {};
+    fstat(file_descriptor, &file_status);
+    return file_status.st_size;
+}
+
+
+auto UringStorage::flush() -> void {
+    // Completed writes are already in the OS page cache
+}
+
+
+auto UringStorage::sync() -> void {
+    if (fsync(file_descriptor) != 0) {
+        throw IOError();
+    }
+}
+
+#endif
+
+
+auto make_storage(StorageBackend backend, const std::string &file_name) -> std::unique_ptr<Storage> {
+#if defined(__unix__)
+    if (backend == mmapStorage) {
+        return std::make_unique<MmapStorage>(file_name);
+    }
+    if (backend == positionalStorage) {
+        return std::make_unique<PositionalStorage>(file_name);
+    }
+#endif
+#if defined(B_PLUS_TREE_IO_URING)
+    if (backend == uringStorage) {
+        try {
+            return std::make_unique<UringStorage>(file_name);
+        } catch (const OpenFileError &) {
+            // io_uring may be missing from the kernel or forbidden, the stream path is used instead
+        }
+    }
+#endif
+    return std::make_unique<StreamStorage>(file_name);
+}
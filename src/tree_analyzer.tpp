@@ -0,0 +1,374 @@
+#include "tree_analyzer.hpp"
+
+
+template<TYPES(typename)>
+TreeAnalyzer<TYPES()>::TreeAnalyzer(BPlusTree<TYPES()> *tree) : tree(tree) {
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::reach(std::int64_t pos, std::int32_t size, const char *referrer) -> bool {
+    std::int32_t const page_size = report.page_size;
+    bool const inside = pos >= 0 && pos + size <= report.file_size && (page_size == 0 || pos % page_size == 0);
+    if (!inside) {
+        ++report.corrupt_pages;
+        report.report_problem(std::string(referrer) + " points to " + std::to_string(pos) + ", not a page of the file");
+        return false;
+    }
+
+    bool first_time;
+    if (page_size > 0) {
+        auto const slot = static_cast<std::size_t>(pos / page_size);
+        first_time = !reached_slots[slot];
+        reached_slots[slot] = true;
+    } else {
+        first_time = reached_positions.insert(pos).second;
+    }
+    if (!first_time) {
+        ++report.corrupt_pages;
+        report.report_problem(std::string(referrer) + " points to page " + std::to_string(pos) +
+                              ", which is already referenced");
+    }
+    return first_time;
+}
+
+
+template<TYPES(typename)>
+template<typename Visitor>
+auto TreeAnalyzer<TYPES()>::read_in_file_order(const std::vector<PendingPage> &level, std::int32_t size,
+                                               Visitor &&visit) -> void {
+    std::vector<std::size_t> order(level.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&level](std::size_t a, std::size_t b) {
+        return level[a].pos < level[b].pos;
+    });
+
+    std::size_t const batch_pages = std::min(ANALYZER_BATCH_PAGES, level.size());
+    std::vector<char, FrameAllocator<char>> buffer(batch_pages * size);
+    std::vector<IORequest> requests;
+
+    for (std::size_t first = 0; first < order.size(); first += batch_pages) {
+        std::size_t const last = std::min(first + batch_pages, order.size());
+        requests.clear();
+        for (std::size_t i = first; i < last; ++i) {
+            requests.push_back(IORequest { level[order[i]].pos, buffer.data() + (i - first) * size,
+                                           static_cast<std::size_t>(size) });
+        }
+        tree->storage->read_batch(requests);
+
+        for (std::size_t i = first; i < last; ++i) {
+            visit(order[i], buffer.data() + (i - first) * size);
+        }
+    }
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::valid_count(const char *buffer, std::size_t max_capacity) -> bool {
+    // both kinds of pages start with their number of entries
+    std::int32_t count;
+    memcpy((char *) &count, buffer, sizeof(std::int32_t));
+    return count >= 0 && static_cast<std::size_t>(count) <= max_capacity;
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::check_count(const PendingPage &page, std::int64_t records) -> void {
+    // each index page is checked against its parent and its children against it, so every count is verified
+    if (page.count && *page.count != records) {
+        ++report.count_mismatches;
+        report.report_problem("page " + std::to_string(page.pos) + " holds " + std::to_string(records) +
+                              " records while its parent counts " + std::to_string(*page.count));
+    }
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::check_key(const FieldType &key, const PendingPage &page, std::int64_t pos) -> void {
+    // keys of unique trees are strictly above the separator on their left, duplicates may equal it
+    const Compare &gt = tree->gt;
+    bool const below_lower = page.lower_fence &&
+                             (tree->properties.UNIQUE ? !gt(key, *page.lower_fence) : gt(*page.lower_fence, key));
+    bool const above_upper = page.upper_fence && gt(key, *page.upper_fence);
+    if (below_lower || above_upper) {
+        ++report.ordering_violations;
+        report.report_problem("page " + std::to_string(pos) + " holds a key outside the range of its parent");
+    }
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::summarize(PageType type, const std::vector<double> &fills,
+                                      std::int64_t entries) -> LevelReport {
+    LevelReport level { type, static_cast<std::int64_t>(fills.size()), entries, 0, 0, 0 };
+    if (fills.empty()) {
+        return level;
+    }
+    auto const [min_fill, max_fill] = std::minmax_element(fills.begin(), fills.end());
+    level.min_fill = *min_fill;
+    level.max_fill = *max_fill;
+    level.mean_fill = std::accumulate(fills.begin(), fills.end(), 0.0) / static_cast<double>(fills.size());
+    return level;
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::analyze_index_level(const std::vector<PendingPage> &level,
+                                                bool &points_to_leaf) -> std::vector<PendingPage> {
+    IndexPage<TYPES()> index_page(tree);
+    std::int32_t const size = index_page.page_size();
+    const Compare &gt = tree->gt;
+    bool const counted = index_page.counted();
+
+    std::vector<std::vector<PendingPage>> children_of(level.size());
+    std::vector<std::optional<bool>> leaf_parents(level.size());
+    std::vector<double> fills;
+    std::int64_t entries = 0;
+
+    read_in_file_order(level, size, [&](std::size_t i, const char *buffer) {
+        const PendingPage &page = level[i];
+        if (!valid_count(buffer, index_page.max_capacity())) {
+            ++report.corrupt_pages;
+            report.report_problem("index page " + std::to_string(page.pos) + " has an impossible number of keys");
+            return;
+        }
+        index_page.read(buffer);
+        leaf_parents[i] = index_page.points_to_leaf;
+        if (counted) {
+            check_count(page, index_page.subtree_size());
+        }
+        fills.push_back(index_page.occupancy());
+        entries += static_cast<std::int64_t>(index_page.len());
+
+        // duplicates spanning several leaves repeat their separator in non-unique trees
+        auto const len = static_cast<std::int32_t>(index_page.len());
+        for (std::int32_t k = 0; k < len; ++k) {
+            check_key(index_page.keys[k], page, page.pos);
+            if (k == 0) {
+                continue;
+            }
+            bool const out_of_order = tree->properties.UNIQUE ? !gt(index_page.keys[k], index_page.keys[k - 1])
+                                                              : gt(index_page.keys[k - 1], index_page.keys[k]);
+            if (out_of_order) {
+                ++report.ordering_violations;
+                report.report_problem("index page " + std::to_string(page.pos) + " has its keys out of order at " +
+                                      std::to_string(k));
+            }
+        }
+
+        for (std::int32_t c = 0; c <= len; ++c) {
+            PendingPage child { index_page.children[c],
+                                c > 0 ? std::optional<FieldType>(index_page.keys[c - 1]) : page.lower_fence,
+                                c < len ? std::optional<FieldType>(index_page.keys[c]) : page.upper_fence,
+                                counted ? std::optional<std::int64_t>(index_page.counts[c]) : std::nullopt };
+            children_of[i].push_back(std::move(child));
+        }
+    });
+
+    report.levels.push_back(summarize(indexPage, fills, entries));
+
+    // every page of a level must agree on the kind of the level below
+    std::optional<bool> level_points_to_leaf;
+    std::vector<PendingPage> next_level;
+    for (std::size_t i = 0; i < level.size(); ++i) {
+        if (!leaf_parents[i]) {
+            continue;
+        }
+        if (!level_points_to_leaf) {
+            level_points_to_leaf = leaf_parents[i];
+        }
+        if (*leaf_parents[i] != *level_points_to_leaf) {
+            ++report.corrupt_pages;
+            report.report_problem("index page " + std::to_string(level[i].pos) +
+                                  " is not at the depth of the other pages of its level");
+            continue;
+        }
+        for (PendingPage &child: children_of[i]) {
+            next_level.push_back(std::move(child));
+        }
+    }
+    points_to_leaf = level_points_to_leaf.value_or(true);
+
+    // pages are only read once, so a page referenced twice (e.g. a cycle) is not walked again
+    std::int32_t const child_size = points_to_leaf ? DataPage<TYPES()>(tree).page_size() : size;
+    std::vector<PendingPage> reachable;
+    for (PendingPage &child: next_level) {
+        if (reach(child.pos, child_size, "an index page")) {
+            reachable.push_back(std::move(child));
+        }
+    }
+    return reachable;
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::analyze_leaves(const std::vector<PendingPage> &leaves) -> void {
+    DataPage<TYPES()> data_page(tree);
+    std::int32_t const size = data_page.page_size();
+    const Compare &gt = tree->gt;
+    bool const unique = tree->properties.UNIQUE;
+
+    std::vector<std::optional<FieldType>> first_keys(leaves.size());
+    std::vector<std::optional<FieldType>> last_keys(leaves.size());
+    std::vector<double> fills;
+    std::int64_t entries = 0;
+
+    read_in_file_order(leaves, size, [&](std::size_t i, const char *buffer) {
+        const PendingPage &page = leaves[i];
+        if (!valid_count(buffer, data_page.max_capacity())) {
+            ++report.corrupt_pages;
+            report.report_problem("data page " + std::to_string(page.pos) + " has an impossible number of records");
+            return;
+        }
+        data_page.read(buffer);
+        check_count(page, static_cast<std::int64_t>(data_page.len()));
+        fills.push_back(data_page.occupancy());
+        entries += static_cast<std::int64_t>(data_page.len());
+
+        auto const len = static_cast<std::int32_t>(data_page.len());
+        for (std::int32_t r = 0; r < len; ++r) {
+            check_key(data_page.keys[r], page, page.pos);
+            if (r == 0) {
+                continue;
+            }
+            bool const descending = gt(data_page.keys[r - 1], data_page.keys[r]);
+            bool const duplicated = unique && !descending && !gt(data_page.keys[r], data_page.keys[r - 1]);
+            if (descending || duplicated) {
+                ++report.ordering_violations;
+                report.report_problem("data page " + std::to_string(page.pos) + " has its records " +
+                                      (descending ? "out of order" : "duplicated in a unique tree") + " at " +
+                                      std::to_string(r));
+            }
+        }
+        if (len > 0) {
+            first_keys[i] = data_page.keys[0];
+            last_keys[i] = data_page.keys[len - 1];
+        }
+
+        // the leaf chain must follow the order given by the index pages
+        std::int64_t const no_leaf = static_cast<std::int64_t>(emptyPage);
+        std::int64_t const expected_prev = i > 0 ? static_cast<std::int64_t>(leaves[i - 1].pos) : no_leaf;
+        std::int64_t const expected_next = i + 1 < leaves.size() ? static_cast<std::int64_t>(leaves[i + 1].pos) : no_leaf;
+        if (data_page.prev_leaf != expected_prev || data_page.next_leaf != expected_next) {
+            ++report.link_violations;
+            report.report_problem("data page " + std::to_string(page.pos) + " links to " +
+                                  std::to_string(data_page.prev_leaf) + " and " + std::to_string(data_page.next_leaf) +
+                                  " instead of " + std::to_string(expected_prev) + " and " +
+                                  std::to_string(expected_next));
+        }
+    });
+
+    report.levels.push_back(summarize(dataPage, fills, entries));
+
+    // the greatest key of a leaf may only be followed by greater keys, or equal ones in non-unique trees
+    std::optional<FieldType> previous_key;
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+        if (!first_keys[i]) {
+            continue;
+        }
+        if (previous_key && (unique ? !gt(*first_keys[i], *previous_key) : gt(*previous_key, *first_keys[i]))) {
+            ++report.ordering_violations;
+            report.report_problem("data page " + std::to_string(leaves[i].pos) +
+                                  " starts below the end of the previous leaf");
+        }
+        previous_key = last_keys[i];
+    }
+
+    // a scan moves from each leaf to the next one, ideally the following slot of the file
+    std::int64_t total_distance = 0;
+    for (std::size_t i = 1; i < leaves.size(); ++i) {
+        std::int64_t const distance = (leaves[i].pos - leaves[i - 1].pos) / size;
+        ++report.leaf_steps;
+        report.sequential_leaf_steps += distance == 1;
+        report.backward_leaf_steps += distance < 0;
+        total_distance += std::abs(distance);
+    }
+    if (report.leaf_steps > 0) {
+        report.mean_leaf_distance = static_cast<double>(total_distance) / static_cast<double>(report.leaf_steps);
+    }
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::count_free_pages() -> void {
+    // released data pages are linked through their next leaf pointer, index pages through their first child
+    DataPage<TYPES()> data_page(tree);
+    IndexPage<TYPES()> index_page(tree);
+    std::int32_t const size = std::max(data_page.page_size(), index_page.page_size());
+    std::vector<char, FrameAllocator<char>> buffer(size);
+
+    for (std::int64_t pos = tree->properties.FREE_DATA_PAGE_HEAD; pos != emptyPage; pos = data_page.next_leaf) {
+        if (!reach(pos, data_page.page_size(), "the free list of data pages")) {
+            break;
+        }
+        tree->storage->read(pos, buffer.data(), data_page.page_size());
+        if (!valid_count(buffer.data(), data_page.max_capacity())) {
+            ++report.corrupt_pages;
+            report.report_problem("free data page " + std::to_string(pos) + " has an impossible header");
+            break;
+        }
+        data_page.read(buffer.data());
+        ++report.free_pages;
+    }
+
+    for (std::int64_t pos = tree->properties.FREE_INDEX_PAGE_HEAD; pos != emptyPage; pos = index_page.children[0]) {
+        if (!reach(pos, index_page.page_size(), "the free list of index pages")) {
+            break;
+        }
+        tree->storage->read(pos, buffer.data(), index_page.page_size());
+        if (!valid_count(buffer.data(), index_page.max_capacity())) {
+            ++report.corrupt_pages;
+            report.report_problem("free index page " + std::to_string(pos) + " has an impossible header");
+            break;
+        }
+        index_page.read(buffer.data());
+        ++report.free_pages;
+    }
+}
+
+
+template<TYPES(typename)>
+auto TreeAnalyzer<TYPES()>::analyze() -> TreeReport {
+    std::unique_lock<std::shared_mutex> tree_lock(tree->tree_latch);
+    // the file is read around the pool, so it must hold every page first
+    tree->buffer_pool.flush();
+
+    report = TreeReport();
+    report.file_size = tree->storage->size();
+    report.page_size = tree->properties.PAGE_SIZE;
+    report.pages_accounted = report.page_size > 0;
+    reached_slots.assign(report.pages_accounted ? report.file_size / report.page_size : 0, false);
+    reached_positions.clear();
+
+    auto const root_type = static_cast<PageType>(tree->properties.ROOT_STATUS);
+    if (root_type != emptyPage) {
+        std::vector<PendingPage> level;
+        std::int32_t const root_size = root_type == dataPage ? DataPage<TYPES()>(tree).page_size()
+                                                             : IndexPage<TYPES()>(tree).page_size();
+        if (reach(tree->properties.SEEK_ROOT, root_size, "the metadata")) {
+            level.push_back(PendingPage { tree->properties.SEEK_ROOT, std::nullopt, std::nullopt, std::nullopt });
+        }
+
+        bool points_to_leaf = root_type == dataPage;
+        if (!points_to_leaf) {
+            while (!level.empty()) {
+                level = analyze_index_level(level, points_to_leaf);
+                if (points_to_leaf) {
+                    break;
+                }
+            }
+        }
+        analyze_leaves(level);
+    }
+
+    count_free_pages();
+
+    if (report.pages_accounted) {
+        for (std::size_t slot = 0; slot < reached_slots.size(); ++slot) {
+            if (!reached_slots[slot]) {
+                ++report.orphaned_pages;
+            }
+        }
+    }
+    return report;
+}
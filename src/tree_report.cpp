@@ -0,0 +1,69 @@
+#include <iomanip>
+
+#include "tree_report.hpp"
+
+
+auto TreeReport::report_problem(std::string description) -> void {
+    if (problems.size() < MAX_REPORTED_PROBLEMS) {
+        problems.push_back(std::move(description));
+    }
+}
+
+
+auto TreeReport::consistent() const -> bool {
+    return ordering_violations == 0 && link_violations == 0 && corrupt_pages == 0 && count_mismatches == 0;
+}
+
+
+auto TreeReport::should_compact() const -> bool {
+    if (!levels.empty() && levels.back().pages > 1 && levels.back().mean_fill < COMPACTION_FILL) {
+        return true;
+    }
+    if (leaf_steps > 0 &&
+        static_cast<double>(sequential_leaf_steps) < COMPACTION_SEQUENTIAL_LEAVES * static_cast<double>(leaf_steps)) {
+        return true;
+    }
+    std::int64_t const unused_bytes = (free_pages + orphaned_pages) * page_size;
+    return file_size > 0 && static_cast<double>(unused_bytes) > COMPACTION_UNUSED_PAGES * static_cast<double>(file_size);
+}
+
+
+auto operator << (std::ostream &out, const TreeReport &report) -> std::ostream& {
+    out << "file " << report.file_size << " bytes";
+    if (report.page_size > 0) {
+        out << ", " << report.file_size / report.page_size << " pages of " << report.page_size << " bytes";
+    }
+    out << "\n";
+
+    out << std::fixed << std::setprecision(1);
+    for (std::size_t depth = 0; depth < report.levels.size(); ++depth) {
+        const LevelReport &level = report.levels[depth];
+        out << "level " << depth << (level.type == dataPage ? "  data " : "  index") << std::setw(12)
+            << level.pages << " pages " << std::setw(14) << level.entries << " entries  fill min "
+            << 100 * level.min_fill << "% mean " << 100 * level.mean_fill << "% max " << 100 * level.max_fill << "%\n";
+    }
+
+    out << "free pages " << report.free_pages << ", orphaned pages ";
+    if (report.pages_accounted) {
+        out << report.orphaned_pages << "\n";
+    } else {
+        out << "unknown (pages of different sizes)\n";
+    }
+
+    if (report.leaf_steps > 0) {
+        auto const steps = static_cast<double>(report.leaf_steps);
+        out << "leaf order: " << 100 * static_cast<double>(report.sequential_leaf_steps) / steps
+            << "% of the leaves follow the previous one, " << 100 * static_cast<double>(report.backward_leaf_steps) / steps
+            << "% go backwards, " << std::setprecision(2) << report.mean_leaf_distance << " pages apart on average\n";
+    }
+
+    out << "ordering violations " << report.ordering_violations << ", broken leaf links " << report.link_violations
+        << ", corrupt pages " << report.corrupt_pages << ", count mismatches " << report.count_mismatches << "\n";
+    for (const std::string &problem: report.problems) {
+        out << "  " << problem << "\n";
+    }
+
+    out << (report.consistent() ? "consistent" : "INCONSISTENT")
+        << (report.should_compact() ? ", compaction advised" : "") << "\n";
+    return out;
+}
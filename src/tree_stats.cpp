@@ -0,0 +1,197 @@
+#include <bit>
+#include <cmath>
+#include <iomanip>
+
+#include "tree_stats.hpp"
+
+
+auto operation_name(TreeOperation operation) -> const char* {
+    switch (operation) {
+        case insertOperation:     return "insert";
+        case removeOperation:     return "remove";
+        case insertManyOperation: return "insert_many";
+        case removeManyOperation: return "remove_many";
+        case searchOperation:     return "search";
+        case searchManyOperation: return "search_many";
+        case aboveOperation:      return "above";
+        case belowOperation:      return "below";
+        case betweenOperation:    return "between";
+        case aggregateOperation:  return "aggregate";
+        case rankOperation:       return "rank";
+        case bulkLoadOperation:   return "bulk_load";
+        case compactOperation:    return "compact";
+        default:                  return "unknown";
+    }
+}
+
+
+LatencyHistogram::LatencyHistogram() : buckets(), total_nanoseconds(0) {
+}
+
+
+auto LatencyHistogram::bucket_of(std::uint64_t nanoseconds) -> std::size_t {
+    if (nanoseconds < LATENCY_SUB_BUCKETS) {
+        return nanoseconds;
+    }
+    // the two bits following the most significant one pick the sub-bucket
+    auto const msb = static_cast<std::size_t>(std::bit_width(nanoseconds)) - 1;
+    return LATENCY_SUB_BUCKETS * (msb - 1) + ((nanoseconds >> (msb - 2)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+
+auto LatencyHistogram::bucket_limit(std::size_t bucket) -> std::uint64_t {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    std::size_t const msb = bucket / LATENCY_SUB_BUCKETS + 1;
+    std::uint64_t const width = std::uint64_t(1) << (msb - 2);
+    return (LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) * width + width - 1;
+}
+
+
+auto LatencyHistogram::record(std::uint64_t nanoseconds) -> void {
+    buckets[bucket_of(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+
+auto LatencyHistogram::summary() const -> LatencySummary {
+    std::array<std::uint64_t, LATENCY_BUCKETS> counts {};
+    LatencySummary summary {};
+    for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        summary.count += counts[i];
+        if (counts[i] != 0) {
+            summary.max = bucket_limit(i);
+        }
+    }
+    summary.total_nanoseconds = total_nanoseconds.load(std::memory_order_relaxed);
+
+    auto const percentile = [&](double p) -> std::uint64_t {
+        auto const rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(summary.count)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank && seen != 0) {
+                return bucket_limit(i);
+            }
+        }
+        return 0;
+    };
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    return summary;
+}
+
+
+auto operator << (std::ostream &out, const TreeStats &stats) -> std::ostream& {
+    out << "height " << stats.height << ", file " << stats.file_size << " bytes";
+    if (stats.data_pages > 0) {
+        out << ", " << stats.data_pages << " data pages " << std::fixed << std::setprecision(1)
+            << 100 * stats.data_page_fill << "% full, " << stats.index_pages << " index pages "
+            << 100 * stats.index_page_fill << "% full";
+    }
+    out << "\n"
+        << "pages  data " << stats.data_page_loads << " loads " << stats.data_page_saves << " saves, index "
+        << stats.index_page_loads << " loads " << stats.index_page_saves << " saves\n"
+        << "pool   " << stats.buffer_pool.hits << " hits " << stats.buffer_pool.misses << " misses "
+        << stats.buffer_pool.evictions << " evictions " << stats.buffer_pool.write_backs << " write backs "
+        << stats.buffer_pool.prefetches << " prefetches\n"
+        << "shape  " << stats.splits << " splits " << stats.merges << " merges " << stats.borrows << " borrows "
+        << stats.root_changes << " root changes\n";
+
+    for (std::size_t i = 0; i < TREE_OPERATIONS; ++i) {
+        const LatencySummary &latency = stats.latencies[i];
+        if (latency.count == 0) {
+            continue;
+        }
+        out << std::left << std::setw(12) << operation_name(static_cast<TreeOperation>(i)) << std::right
+            << latency.count << " ops, ns mean " << latency.total_nanoseconds / latency.count
+            << " p50 " << latency.p50 << " p90 " << latency.p90 << " p99 " << latency.p99
+            << " p99.9 " << latency.p999 << " max " << latency.max << "\n";
+    }
+    return out;
+}
+
+
+TreeStatistics::TreeStatistics() : page_loads(), page_saves(), events(), latencies() {
+}
+
+
+auto TreeStatistics::page_loaded(PageType type) -> void {
+    page_loads[type == dataPage].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto TreeStatistics::page_saved(PageType type) -> void {
+    page_saves[type == dataPage].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto TreeStatistics::record(TreeEvent event) -> void {
+    events[event].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+auto TreeStatistics::record(TreeOperation operation, std::chrono::nanoseconds elapsed) -> void {
+    latencies[operation].record(static_cast<std::uint64_t>(std::max<std::int64_t>(elapsed.count(), 0)));
+}
+
+
+auto TreeStatistics::snapshot(TreeStats &stats) const -> void {
+    stats.data_page_loads = page_loads[1].load(std::memory_order_relaxed);
+    stats.data_page_saves = page_saves[1].load(std::memory_order_relaxed);
+    stats.index_page_loads = page_loads[0].load(std::memory_order_relaxed);
+    stats.index_page_saves = page_saves[0].load(std::memory_order_relaxed);
+    stats.splits = events[pageSplit].load(std::memory_order_relaxed);
+    stats.merges = events[pageMerge].load(std::memory_order_relaxed);
+    stats.borrows = events[pageBorrow].load(std::memory_order_relaxed);
+    stats.root_changes = events[rootChange].load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < TREE_OPERATIONS; ++i) {
+        stats.latencies[i] = latencies[i].summary();
+    }
+}
+
+
+OperationTimer::OperationTimer(TreeStatistics &statistics, TreeOperation operation)
+        : statistics(statistics), operation(operation), start(std::chrono::steady_clock::now()) {
+}
+
+
+OperationTimer::~OperationTimer() {
+    statistics.record(operation, std::chrono::steady_clock::now() - start);
+}
+
+
+StatsReporter::~StatsReporter() {
+    stop();
+}
+
+
+auto StatsReporter::start(std::chrono::milliseconds period, std::function<void()> report) -> void {
+    stop();
+    stopping = false;
+    worker = std::thread([this, period, report = std::move(report)] {
+        std::unique_lock<std::mutex> lock(latch);
+        while (!wake.wait_for(lock, period, [this] { return stopping; })) {
+            // the report may take a while, e.g. waiting for a writer, so it does not hold the latch
+            lock.unlock();
+            report();
+            lock.lock();
+        }
+    });
+}
+
+
+auto StatsReporter::stop() -> void {
+    {
+        std::lock_guard<std::mutex> lock(latch);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
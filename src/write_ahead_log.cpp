@@ -0,0 +1,342 @@
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "write_ahead_log.hpp"
+#include "error_handler.hpp"
+
+
+// Kinds of log records
+enum LogRecordType : std::uint32_t {
+    pageImageRecord = 1,  // payload: the image of the page stored at `pos`
+    commitRecord    = 2   // payload: the metadata of the tree once the operation is applied
+};
+
+
+struct LogRecordHeader {
+    std::uint32_t checksum;
+    std::uint32_t type;
+    std::int64_t pos;
+    std::uint64_t size;
+};
+
+
+// FNV-1a over the header fields following the checksum and the payload, a torn record never matches it
+static auto record_checksum(const LogRecordHeader &header, const char *payload) -> std::uint32_t {
+    std::uint32_t hash = 2166136261U;
+    auto const mix = [&hash](const char *bytes, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<std::uint8_t>(bytes[i])) * 16777619U;
+        }
+    };
+    mix(reinterpret_cast<const char*>(&header.type), sizeof(header) - sizeof(header.checksum));
+    mix(payload, header.size);
+    return hash;
+}
+
+
+static auto write_all(int file_descriptor, const char *buffer, std::size_t size) -> void {
+    while (size > 0) {
+        ssize_t const result = ::write(file_descriptor, buffer, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw IOError();
+        }
+        buffer += result;
+        size -= result;
+    }
+}
+
+
+WriteAheadLog::WriteAheadLog(const std::string &file_name)
+        : appended_lsn(0), durable_lsn(0), syncing(false), failed(false) {
+    file_descriptor = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (file_descriptor < 0) {
+        throw OpenFileError();
+    }
+
+    struct stat file_status {};
+    fstat(file_descriptor, &file_status);
+    appended_lsn = durable_lsn = file_status.st_size;
+}
+
+
+WriteAheadLog::~WriteAheadLog() {
+    ::close(file_descriptor);
+}
+
+
+auto WriteAheadLog::append_record(std::uint32_t type, std::int64_t pos, const char *payload, std::size_t size) -> void {
+    LogRecordHeader header { 0, type, pos, size };
+    header.checksum = record_checksum(header, payload);
+
+    auto const *header_bytes = reinterpret_cast<const char*>(&header);
+    pending.insert(pending.end(), header_bytes, header_bytes + sizeof(header));
+    pending.insert(pending.end(), payload, payload + size);
+    appended_lsn += sizeof(header) + size;
+}
+
+
+auto WriteAheadLog::begin() -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    staged[std::this_thread::get_id()].clear();
+}
+
+
+auto WriteAheadLog::stage(std::int64_t pos, const char *previous_image, const char *image,
+                          std::size_t size) -> bool {
+    std::lock_guard<std::mutex> lock(latch);
+    auto iter = staged.find(std::this_thread::get_id());
+    if (iter == staged.end()) {
+        return false;
+    }
+
+    // only the last image of a page written several times by the operation matters
+    std::vector<StagedPage> &pages = iter->second;
+    auto page = std::find_if(pages.begin(), pages.end(), [pos](const StagedPage &staged_page) {
+        return staged_page.pos == pos;
+    });
+    if (page != pages.end()) {
+        page->image.assign(image, image + size);
+        return false;
+    }
+
+    pages.push_back(StagedPage { pos, std::vector<char>(previous_image, previous_image + size),
+                                 std::vector<char>(image, image + size) });
+    return true;
+}
+
+
+auto WriteAheadLog::append(const LoggedMetadata &metadata, std::vector<std::int64_t> &positions) -> std::uint64_t {
+    std::lock_guard<std::mutex> lock(latch);
+    auto node = staged.extract(std::this_thread::get_id());
+    if (node.empty() || node.mapped().empty()) {
+        return 0;
+    }
+
+    for (const StagedPage &page: node.mapped()) {
+        append_record(pageImageRecord, page.pos, page.image.data(), page.image.size());
+        positions.push_back(page.pos);
+    }
+    append_record(commitRecord, 0, reinterpret_cast<const char*>(metadata.data()), sizeof(metadata));
+    return appended_lsn;
+}
+
+
+auto WriteAheadLog::wait_durable(std::uint64_t lsn) -> void {
+    std::unique_lock<std::mutex> lock(latch);
+
+    // group commit: a single thread at a time writes and syncs everything appended so far
+    while (durable_lsn < lsn) {
+        if (failed) {
+            throw IOError();
+        }
+        if (syncing) {
+            synced.wait(lock);
+            continue;
+        }
+
+        syncing = true;
+        std::vector<char> batch;
+        batch.swap(pending);
+        std::uint64_t const batch_lsn = appended_lsn;
+        lock.unlock();
+
+        bool written = true;
+        try {
+            write_all(file_descriptor, batch.data(), batch.size());
+            written = fdatasync(file_descriptor) == 0;
+        } catch (const IOError &) {
+            written = false;
+        }
+
+        lock.lock();
+        syncing = false;
+        failed = !written;
+        synced.notify_all();
+        if (!failed) {
+            durable_lsn = batch_lsn;
+        }
+    }
+}
+
+
+auto WriteAheadLog::commit(const LoggedMetadata &metadata, std::vector<std::int64_t> &positions) -> void {
+    wait_durable(append(metadata, positions));
+}
+
+
+auto WriteAheadLog::abort() -> std::vector<StagedPage> {
+    std::lock_guard<std::mutex> lock(latch);
+    auto node = staged.extract(std::this_thread::get_id());
+    return node.empty() ? std::vector<StagedPage>() : std::move(node.mapped());
+}
+
+
+auto WriteAheadLog::replay(Storage &storage, const std::function<void(const LoggedMetadata&)> &restore) -> bool {
+    std::vector<char> content(size());
+    std::size_t bytes_read = 0;
+    while (bytes_read < content.size()) {
+        ssize_t const result = pread(file_descriptor, content.data() + bytes_read, content.size() - bytes_read,
+                                     static_cast<off_t>(bytes_read));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            break;
+        }
+        bytes_read += result;
+    }
+
+    // the images of an operation are applied once its commit record is found, a torn tail is ignored
+    std::vector<IORequest> operation_pages;
+    std::size_t offset = 0;
+    bool replayed = false;
+    while (offset + sizeof(LogRecordHeader) <= bytes_read) {
+        LogRecordHeader header {};
+        memcpy(&header, content.data() + offset, sizeof(header));
+        const char *payload = content.data() + offset + sizeof(header);
+        if (header.size > bytes_read - offset - sizeof(header) || header.checksum != record_checksum(header, payload)) {
+            break;
+        }
+
+        if (header.type == pageImageRecord) {
+            operation_pages.push_back(IORequest { header.pos, const_cast<char*>(payload), header.size });
+        } else if (header.type == commitRecord && header.size == sizeof(LoggedMetadata)) {
+            storage.write_batch(operation_pages);
+            operation_pages.clear();
+
+            LoggedMetadata metadata {};
+            memcpy(metadata.data(), payload, sizeof(metadata));
+            restore(metadata);
+            replayed = true;
+        } else {
+            break;
+        }
+        offset += sizeof(header) + header.size;
+    }
+
+    storage.sync();
+    return replayed;
+}
+
+
+auto WriteAheadLog::truncate() -> void {
+    std::lock_guard<std::mutex> lock(latch);
+    if (ftruncate(file_descriptor, 0) != 0 || fsync(file_descriptor) != 0) {
+        throw IOError();
+    }
+    pending.clear();
+    appended_lsn = durable_lsn = 0;
+}
+
+
+auto WriteAheadLog::size() -> std::uint64_t {
+    std::lock_guard<std::mutex> lock(latch);
+    return appended_lsn;
+}
+
+
+auto WriteAheadLog::staged_pages() -> std::size_t {
+    std::lock_guard<std::mutex> lock(latch);
+    auto iter = staged.find(std::this_thread::get_id());
+    return (iter == staged.end()) ? 0 : iter->second.size();
+}
+
+
+LoggedOperation::LoggedOperation(WriteAheadLog *log, BufferPool *buffer_pool)
+        : log(log), buffer_pool(buffer_pool), finished(false), commit_lsn(0) {
+    if (log) {
+        log->begin();
+    }
+}
+
+
+LoggedOperation::~LoggedOperation() {
+    if (!log) {
+        return;
+    }
+
+    // the operation failed halfway, its pages get their previous content back and are never logged. They are
+    // still pinned by the operation, so the frames written are the ones holding them.
+    if (!finished) {
+        for (const WriteAheadLog::StagedPage &page: log->abort()) {
+            char *frame = buffer_pool->pin(page.pos, page.previous_image.size(), false);
+            std::copy(page.previous_image.begin(), page.previous_image.end(), frame);
+            buffer_pool->unpin(page.pos, false);
+            buffer_pool->unpin(page.pos, false);
+        }
+    }
+
+    // appended but never committed, the pages are only released once their records are durable
+    if (!positions.empty()) {
+        try {
+            log->wait_durable(commit_lsn);
+        } catch (const IOError &) {
+        }
+        release();
+    }
+}
+
+
+auto LoggedOperation::release() -> void {
+    for (std::int64_t pos: positions) {
+        buffer_pool->unpin(pos, true);
+    }
+    positions.clear();
+}
+
+
+auto LoggedOperation::append(const LoggedMetadata &metadata) -> void {
+    if (!log) {
+        return;
+    }
+
+    finished = true;
+    commit_lsn = log->append(metadata, positions);
+}
+
+
+auto LoggedOperation::commit() -> void {
+    if (!log) {
+        return;
+    }
+
+    try {
+        log->wait_durable(commit_lsn);
+    } catch (const IOError &) {
+        release();
+        throw;
+    }
+    release();
+}
+
+
+auto LoggedOperation::commit(const LoggedMetadata &metadata) -> void {
+    append(metadata);
+    commit();
+}
+
+
+auto LoggedOperation::pending() -> std::size_t {
+    return log ? log->staged_pages() : 0;
+}
+
+
+auto sync_file(const std::string &file_name) -> void {
+    int const file_descriptor = ::open(file_name.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        throw OpenFileError();
+    }
+    int const result = fsync(file_descriptor);
+    ::close(file_descriptor);
+    if (result != 0) {
+        throw IOError();
+    }
+}
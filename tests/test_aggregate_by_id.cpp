@@ -0,0 +1,178 @@
+#include <cassert>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record, std::greater<std::int32_t>, key_of<&Record::id>>;
+
+// Small pages, so that ranges span several leaves on a tree of a few levels
+std::int32_t const INDEX_PAGE_CAPACITY = 6;
+std::int32_t const DATA_PAGE_CAPACITY = 6;
+
+
+// Sums of 32-bit values are widened, floating point ones are summed as doubles
+static_assert(std::is_same_v<aggregate_sum_t<std::int32_t>, std::int64_t>);
+static_assert(std::is_same_v<aggregate_sum_t<std::uint16_t>, std::uint64_t>);
+static_assert(std::is_same_v<aggregate_sum_t<float>, double>);
+
+
+struct TreeVariant {
+    std::string name;
+    StorageBackend backend;
+    bool unique;
+    bool pinned_index;
+    bool compressed_leaves;
+};
+
+
+auto make_property(const TreeVariant &variant) -> Property {
+    std::string const file_name = "aggregate_by_id_" + variant.name;
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, variant.unique, DEFAULT_BUFFER_POOL_CAPACITY, variant.backend, false,
+                            variant.pinned_index, variant.compressed_leaves);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+// Aggregates over random ranges, with bounds that are not always keys of the tree and may fall outside of it
+void check_aggregates(RecordTree &tree, const std::multiset<std::int32_t> &model, const int number_of_records,
+                      std::mt19937 &twister) {
+    std::uniform_int_distribution<std::int32_t> random_key(-1, number_of_records + 2);
+
+    for (int i = 0; i < 50; ++i) {
+        std::int32_t lower_bound = random_key(twister);
+        std::int32_t upper_bound = random_key(twister);
+        if (upper_bound < lower_bound) {
+            std::swap(lower_bound, upper_bound);
+        }
+        // a range of a single key, and the whole tree, as well
+        if (i % 10 == 0) {
+            upper_bound = lower_bound;
+        } else if (i % 10 == 1) {
+            lower_bound = std::numeric_limits<std::int32_t>::min();
+            upper_bound = std::numeric_limits<std::int32_t>::max();
+        }
+
+        std::vector<std::int32_t> const keys(model.lower_bound(lower_bound), model.upper_bound(upper_bound));
+        std::int64_t expected_sum = 0;
+        std::optional<std::int32_t> least_age;
+        std::optional<std::int32_t> greatest_age;
+        for (std::int32_t const key: keys) {
+            expected_sum += key % 97;
+            least_age = std::min(least_age.value_or(key % 97), key % 97);
+            greatest_age = std::max(greatest_age.value_or(key % 97), key % 97);
+        }
+
+        assert(tree.count_between(lower_bound, upper_bound) == keys.size());
+        assert(tree.sum_between(lower_bound, upper_bound, &Record::age) == expected_sum);
+        assert(tree.sum_between(lower_bound, upper_bound, [](const Record &record) { return record.id; }) ==
+               std::accumulate(keys.begin(), keys.end(), std::int64_t { 0 }));
+        assert(tree.min_between(lower_bound, upper_bound, &Record::age) == least_age);
+        assert(tree.max_between(lower_bound, upper_bound, &Record::age) == greatest_age);
+
+        // the sum of the largest 32-bit values only fits in the widened type
+        std::int64_t const widened = tree.sum_between(lower_bound, upper_bound, [](const Record &) {
+            return std::numeric_limits<std::int32_t>::max();
+        });
+        assert(widened == static_cast<std::int64_t>(keys.size()) * std::numeric_limits<std::int32_t>::max());
+
+        std::optional<Record> const least = tree.min_between(lower_bound, upper_bound);
+        std::optional<Record> const greatest = tree.max_between(lower_bound, upper_bound);
+        assert(least.has_value() == !keys.empty() && greatest.has_value() == !keys.empty());
+        if (!keys.empty()) {
+            assert(least->id == keys.front() && least->age == keys.front() % 97);
+            assert(greatest->id == keys.back() && greatest->age == keys.back() % 97);
+        }
+
+        // an inverted range is empty
+        if (upper_bound < std::numeric_limits<std::int32_t>::max()) {
+            assert(tree.count_between(upper_bound + 1, lower_bound) == 0);
+            assert(tree.sum_between(upper_bound + 1, lower_bound, &Record::age) == 0);
+            assert(!tree.min_between(upper_bound + 1, lower_bound).has_value());
+            assert(!tree.max_between(upper_bound + 1, lower_bound, &Record::age).has_value());
+        }
+    }
+}
+
+
+void aggregate_test(const TreeVariant &variant, const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property(variant);
+
+    // keys of non-unique trees repeat within and across leaves
+    std::vector<std::int32_t> keys(number_of_records);
+    std::iota(keys.begin(), keys.end(), 1);
+    if (!variant.unique) {
+        for (std::int32_t &key: keys) {
+            key = 1 + static_cast<std::int32_t>(twister() % std::max(number_of_records / 4, 1));
+        }
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    std::multiset<std::int32_t> model;
+
+    {
+        RecordTree tree(property, key_of<&Record::id>{});
+        check_aggregates(tree, model, number_of_records, twister);
+
+        for (std::int32_t const key: keys) {
+            Record record(key, "a", key % 97);
+            tree.insert(record);
+            model.insert(key);
+        }
+        check_aggregates(tree, model, number_of_records, twister);
+
+        // removals leave sparse leaves, some of them merged with their neighbours
+        for (int i = 0; i < 2 * number_of_records / 3; ++i) {
+            tree.remove(keys[i]);
+            model.erase(model.find(keys[i]));
+        }
+        check_aggregates(tree, model, number_of_records, twister);
+
+        // aggregates are timed on their own, not as the range searches they resemble
+        TreeStats const stats = tree.stats();
+        assert(stats.latencies[aggregateOperation].count > 0 && stats.latencies[betweenOperation].count == 0);
+    }
+
+    RecordTree tree(property, key_of<&Record::id>{});
+    check_aggregates(tree, model, number_of_records, twister);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    TreeVariant const variants[] = {
+        { "stream",     streamStorage,     true,  false, false },
+        { "positional", positionalStorage, true,  false, false },
+        { "mmap",       mmapStorage,       true,  false, false },
+        { "non_unique", positionalStorage, false, false, false },
+        { "pinned",     positionalStorage, true,  true,  false },
+        { "compressed", positionalStorage, false, false, true  }
+    };
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        for (const TreeVariant &variant: variants) {
+            aggregate_test(variant, NUMBER_OF_RECORDS, twister);
+            std::cout << "Aggregate test passed for " << variant.name << " index #" << TEST << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
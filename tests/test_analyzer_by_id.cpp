@@ -0,0 +1,202 @@
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <random>
+#include <set>
+
+#include "tree_analyzer.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const INDEX_PAGE_CAPACITY = 8;
+std::int32_t const DATA_PAGE_CAPACITY = 16;
+
+// Bytes before the records of a data page: their number and the links to both neighbours
+std::size_t const DATA_PAGE_HEADER = sizeof(std::int32_t) + 2 * sizeof(std::int64_t);
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_record(std::int32_t key) -> Record {
+    return Record(key, "r" + std::to_string(key), 7 * key + 3);
+}
+
+
+auto open_property(const std::string &file_name) -> Property {
+    return Property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY, DATA_PAGE_CAPACITY,
+                    true);
+}
+
+
+auto read_file(const std::string &path) -> std::vector<char> {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+void write_file(const std::string &path, const std::vector<char> &bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+
+// Offset of the record of `key` in the file, found by its age and name, which no other record shares
+auto record_offset(const std::vector<char> &bytes, std::int32_t key) -> std::size_t {
+    Record const record = make_record(key);
+    std::string pattern(reinterpret_cast<const char *>(&record.age), sizeof(record.age));
+    pattern.append(record.name, std::strlen(record.name) + 1);
+    auto const found = std::search(bytes.begin(), bytes.end(), pattern.begin(), pattern.end());
+    assert(found != bytes.end());
+    return static_cast<std::size_t>(found - bytes.begin()) - offsetof(Record, age);
+}
+
+
+auto analyze(const Property &property) -> TreeReport {
+    RecordTree tree(property, get_indexed_field);
+    TreeAnalyzer analyzer(&tree);
+    return analyzer.analyze();
+}
+
+
+// Every page of the file is reached from the root or a free list, and the leaves hold every record
+void check_healthy(const TreeReport &report, const std::set<std::int32_t> &model) {
+    assert(report.consistent());
+    assert(report.problems.empty());
+    assert(report.pages_accounted && report.orphaned_pages == 0);
+    std::int64_t pages = report.free_pages;
+    if (report.levels.empty()) {
+        assert(model.empty() && pages * report.page_size == report.file_size);
+        return;
+    }
+    assert(report.levels.back().type == dataPage);
+    assert(report.levels.front().pages == 1);
+    assert(report.levels.back().entries == static_cast<std::int64_t>(model.size()));
+
+    for (const LevelReport &level: report.levels) {
+        assert(level.min_fill <= level.mean_fill && level.mean_fill <= level.max_fill && level.max_fill <= 1);
+        pages += level.pages;
+    }
+    assert(pages * report.page_size == report.file_size);
+    assert(report.leaf_steps == report.levels.back().pages - 1);
+}
+
+
+// Damage to a page is reported however it is reached, and the report tells its kind apart
+template<typename Corruption>
+auto corrupted_report(const Property &property, const std::vector<char> &original, Corruption corrupt) -> TreeReport {
+    std::vector<char> bytes = original;
+    corrupt(bytes);
+    write_file(property.INDEX_FULL_PATH, bytes);
+    TreeReport report = analyze(property);
+    write_file(property.INDEX_FULL_PATH, original);
+    assert(!report.consistent() && !report.problems.empty());
+    return report;
+}
+
+
+void analyzer_test(const int number_of_records, std::mt19937 &twister) {
+    std::string const name = "analyzer_by_id";
+    Property const property = open_property(name);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+
+    std::vector<std::int32_t> keys(number_of_records);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), twister);
+    std::set<std::int32_t> model;
+    {
+        RecordTree tree(property, get_indexed_field);
+        TreeAnalyzer empty(&tree);
+        TreeReport const report = empty.analyze();
+        assert(report.consistent() && report.levels.empty() && report.leaf_steps == 0);
+
+        for (std::int32_t const key: keys) {
+            Record record = make_record(key);
+            tree.insert(record);
+            model.insert(key);
+        }
+        // released pages go to the free lists, they are neither reachable nor orphaned
+        for (std::size_t i = 0; i < keys.size(); i += 3) {
+            tree.remove(keys[i]);
+            model.erase(keys[i]);
+        }
+    }
+    check_healthy(analyze(property), model);
+
+    {
+        RecordTree tree(property, get_indexed_field);
+        tree.compact();
+    }
+    TreeReport const compacted = analyze(property);
+    check_healthy(compacted, model);
+    assert(compacted.free_pages == 0 && compacted.backward_leaf_steps == 0);
+    assert(compacted.sequential_leaf_steps == compacted.leaf_steps);
+    assert(!compacted.should_compact());
+
+    if (model.size() < 2) {
+        return;
+    }
+    std::vector<char> const original = read_file(property.INDEX_FULL_PATH);
+    auto const page_size = static_cast<std::size_t>(compacted.page_size);
+
+    // a key in the middle of its leaf or first of a later one, so that a smaller key breaks the order either way
+    std::int32_t const key = *std::next(model.begin(), static_cast<std::ptrdiff_t>(model.size() / 2));
+    std::size_t const offset = record_offset(original, key);
+    std::size_t const leaf = offset / page_size * page_size;
+    assert((offset - leaf - DATA_PAGE_HEADER) % sizeof(Record) == 0);
+
+    TreeReport report = corrupted_report(property, original, [&](std::vector<char> &bytes) {
+        std::int32_t const smallest = -5;
+        std::memcpy(bytes.data() + offset, &smallest, sizeof(smallest));
+    });
+    assert(report.ordering_violations > 0 && report.corrupt_pages == 0 && report.link_violations == 0);
+
+    report = corrupted_report(property, original, [&](std::vector<char> &bytes) {
+        auto const itself = static_cast<std::int64_t>(leaf);
+        std::memcpy(bytes.data() + leaf + sizeof(std::int32_t), &itself, sizeof(itself));
+    });
+    assert(report.link_violations > 0 && report.ordering_violations == 0);
+
+    // after a compaction every page is reachable, an impossible count is found wherever it lies
+    std::vector<std::size_t> slots(original.size() / page_size);
+    std::iota(slots.begin(), slots.end(), 0);
+    std::shuffle(slots.begin(), slots.end(), twister);
+    slots.resize(std::min<std::size_t>(slots.size(), 24));
+    for (std::size_t const slot: slots) {
+        for (std::int32_t const count: { -1, std::max(INDEX_PAGE_CAPACITY, DATA_PAGE_CAPACITY) + 1 }) {
+            report = corrupted_report(property, original, [&](std::vector<char> &bytes) {
+                std::memcpy(bytes.data() + slot * page_size, &count, sizeof(count));
+            });
+            assert(report.corrupt_pages > 0);
+        }
+    }
+    check_healthy(analyze(property), model);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        analyzer_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "Analyzer test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, bool unique, std::int32_t buffer_pool_capacity = 256,
+                   bool durable = false) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY,
+                            unique, buffer_pool_capacity, streamStorage, durable);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH + WAL_FILE_EXTENSION);
+    return property;
+}
+
+
+auto make_records(const std::vector<std::int32_t> &keys) -> std::vector<Record> {
+    std::vector<Record> records;
+    for (std::int32_t const key: keys) {
+        records.emplace_back(key, "b", key % 97);
+    }
+    return records;
+}
+
+
+auto shuffled_keys(std::int32_t first, std::int32_t last, std::int32_t step, std::mt19937 &twister)
+        -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = first; key <= last; key += step) {
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    return keys;
+}
+
+
+// The tree holds exactly the keys of the model, through the leaf chain and through searches
+void check_contents(RecordTree &tree, const std::multiset<std::int32_t> &model, std::int32_t max_key) {
+    std::vector<Record> const ascending = tree.above(-1);
+    assert(ascending.size() == model.size());
+    assert(std::equal(ascending.begin(), ascending.end(), model.begin(),
+                      [](const Record &record, std::int32_t key) { return record.id == key; }));
+
+    for (std::int32_t key = 0; key <= max_key + 1; ++key) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(recovered.size() == model.count(key));
+        assert(std::all_of(recovered.begin(), recovered.end(), [key](const Record &record) {
+            return record.age == key % 97;
+        }));
+    }
+}
+
+
+void batches_test(const int number_of_records, std::mt19937 &twister) {
+    RecordTree tree(make_property("batch_by_id", true), get_indexed_field);
+    std::multiset<std::int32_t> model;
+
+    // empty batches change nothing, on an empty tree as well
+    std::vector<Record> const none;
+    tree.insert_many(none.begin(), none.end());
+    std::vector<std::int32_t> const no_keys;
+    tree.remove_many(no_keys.begin(), no_keys.end());
+    check_contents(tree, model, number_of_records);
+
+    // a single record creates the root leaf, a leaf's worth of them fills it up to its split
+    for (std::int32_t const size: { 1, SMALL_CAPACITY - 2, SMALL_CAPACITY - 1, SMALL_CAPACITY }) {
+        std::vector<std::int32_t> const keys = shuffled_keys(1, size, 1, twister);
+        std::vector<Record> const records = make_records(keys);
+        tree.insert_many(records.begin(), records.end());
+        model.insert(keys.begin(), keys.end());
+        check_contents(tree, model, number_of_records);
+
+        tree.remove_many(keys.begin(), keys.end());
+        model.clear();
+        check_contents(tree, model, number_of_records);
+    }
+
+    // odd keys first, then the even ones fall between them on every leaf
+    std::vector<std::int32_t> const odd = shuffled_keys(1, number_of_records, 2, twister);
+    std::vector<Record> const odd_records = make_records(odd);
+    tree.insert_many(odd_records.begin(), odd_records.end());
+    model.insert(odd.begin(), odd.end());
+    check_contents(tree, model, number_of_records);
+
+    std::vector<std::int32_t> const even = shuffled_keys(2, number_of_records, 2, twister);
+    std::vector<Record> const even_records = make_records(even);
+    tree.insert_many(even_records.begin(), even_records.end());
+    model.insert(even.begin(), even.end());
+    check_contents(tree, model, number_of_records);
+
+    // removing every third key leaves leaves below their minimum, which are merged
+    std::vector<std::int32_t> const thirds = shuffled_keys(3, number_of_records, 3, twister);
+    tree.remove_many(thirds.begin(), thirds.end());
+    for (std::int32_t const key: thirds) {
+        model.erase(key);
+    }
+    check_contents(tree, model, number_of_records);
+
+    // the whole tree at once
+    std::vector<std::int32_t> const rest(model.begin(), model.end());
+    tree.remove_many(rest.begin(), rest.end());
+    model.clear();
+    check_contents(tree, model, number_of_records);
+}
+
+
+// A batch with a key missing from the tree, or repeated more times than the tree holds it, removes nothing
+void rejected_removes_test(const int number_of_records, std::mt19937 &twister) {
+    RecordTree tree(make_property("batch_by_id_rejected", false), get_indexed_field);
+    std::multiset<std::int32_t> model;
+
+    std::vector<std::int32_t> keys = shuffled_keys(1, number_of_records, 1, twister);
+    keys.insert(keys.end(), keys.begin(), keys.begin() + number_of_records / 2);
+    std::vector<Record> const records = make_records(keys);
+    tree.insert_many(records.begin(), records.end());
+    model.insert(keys.begin(), keys.end());
+    check_contents(tree, model, number_of_records);
+
+    std::int32_t const duplicated = keys.front();
+    std::int32_t const single = keys[number_of_records - 1];
+    std::vector<std::vector<std::int32_t>> const rejected = {
+            { 1, 2, number_of_records + 1 },
+            { 0 },
+            { duplicated, duplicated, duplicated },
+            { single, 3, single },
+    };
+    for (const std::vector<std::int32_t> &batch: rejected) {
+        bool thrown = false;
+        try {
+            tree.remove_many(batch.begin(), batch.end());
+        } catch (const KeyNotFound &) {
+            thrown = true;
+        }
+        assert(thrown);
+        check_contents(tree, model, number_of_records);
+    }
+
+    // each occurrence removes one record
+    std::vector<std::int32_t> const twice = { duplicated, duplicated, single };
+    tree.remove_many(twice.begin(), twice.end());
+    for (std::int32_t const key: twice) {
+        model.erase(model.find(key));
+    }
+    check_contents(tree, model, number_of_records);
+}
+
+
+// Durable batches staging more pages than the pool holds are logged in several operations
+void durable_batches_test(const int number_of_records, std::mt19937 &twister) {
+    std::multiset<std::int32_t> model;
+    Property const property = make_property("batch_by_id_durable", true, 64, true);
+    {
+        RecordTree tree(property, get_indexed_field);
+        std::vector<std::int32_t> const keys = shuffled_keys(1, number_of_records, 1, twister);
+        std::vector<Record> const records = make_records(keys);
+        tree.insert_many(records.begin(), records.end());
+        model.insert(keys.begin(), keys.end());
+
+        std::vector<std::int32_t> const removed = shuffled_keys(1, number_of_records, 2, twister);
+        tree.remove_many(removed.begin(), removed.end());
+        for (std::int32_t const key: removed) {
+            model.erase(key);
+        }
+        check_contents(tree, model, number_of_records);
+    }
+
+    RecordTree tree(property, get_indexed_field);
+    check_contents(tree, model, number_of_records);
+
+    // a pool unable to hold the pages of a single change is refused
+    bool thrown = false;
+    try {
+        RecordTree small(make_property("batch_by_id_small_pool", true, 2, true), get_indexed_field);
+    } catch (const BufferPoolTooSmall &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        batches_test(NUMBER_OF_RECORDS, twister);
+        rejected_removes_test(NUMBER_OF_RECORDS, twister);
+        durable_batches_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "Batch test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "bench_workloads.hpp"
+
+
+// Ranks drawn by the benchmark stay within the keys, repeat for the same seed and favour a few hot keys
+void zipfian_test(const int number_of_records, std::mt19937 &twister) {
+    auto const items = static_cast<std::uint64_t>(number_of_records);
+    ZipfianGenerator const zipfian(items);
+    std::mt19937_64 engine(twister());
+    std::mt19937_64 replay = engine;
+
+    std::size_t const draws = 20 * items;
+    std::vector<std::size_t> frequencies(items, 0);
+    for (std::size_t i = 0; i < draws; ++i) {
+        std::uint64_t const key = zipfian(engine);
+        assert(key < items);
+        assert(zipfian(replay) == key);
+        ++frequencies[key];
+    }
+
+    // the hottest key takes about 1 / zeta(items) of the draws, far above the 1 / items of a uniform choice
+    std::vector<std::size_t> sorted = frequencies;
+    std::sort(sorted.begin(), sorted.end(), std::greater<>());
+    assert(sorted[0] > draws / 20);
+    assert(sorted[0] > sorted[1] && sorted[1] > sorted[items / 2]);
+
+    // a single key is always drawn
+    ZipfianGenerator const single(1);
+    for (int i = 0; i < 100; ++i) {
+        assert(single(engine) == 0);
+    }
+}
+
+
+// Percentiles of known latencies are exact, never decrease with `p` and stay within the values
+void nearest_rank_test(std::mt19937 &twister) {
+    assert(nearest_rank({}, 0.5) == 0.0);
+    assert(nearest_rank({ 7.0 }, 0.0) == 7.0 && nearest_rank({ 7.0 }, 0.999) == 7.0);
+
+    std::vector<double> hundred;
+    for (int i = 1; i <= 100; ++i) {
+        hundred.push_back(i);
+    }
+    assert(nearest_rank(hundred, 0.0) == 1.0);
+    assert(nearest_rank(hundred, 0.50) == 50.0);
+    assert(nearest_rank(hundred, 0.90) == 90.0);
+    assert(nearest_rank(hundred, 0.99) == 99.0);
+    assert(nearest_rank(hundred, 0.999) == 100.0);
+    assert(nearest_rank(hundred, 1.0) == 100.0);
+
+    std::vector<double> latencies(1 + twister() % 2000);
+    for (double &latency: latencies) {
+        latency = std::uniform_real_distribution<double>(0.0, 1.0)(twister);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double previous = latencies.front();
+    for (double const p: { 0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0 }) {
+        double const value = nearest_rank(latencies, p);
+        assert(previous <= value && value <= latencies.back());
+        previous = value;
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        zipfian_test(std::max(NUMBER_OF_RECORDS, 2), twister);
+        nearest_rank_test(twister);
+        std::cout << "Bench workloads test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
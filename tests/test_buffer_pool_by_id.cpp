@@ -0,0 +1,247 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+std::size_t const PAGE_BYTES = 64;
+
+
+auto generate_random_vector(const int number_of_records) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> arr(number_of_records);
+    for (std::int32_t i = 0; i < number_of_records; ++i) {
+        arr[i] = i + 1;
+    }
+
+    std::random_device random_device;
+    std::mt19937 twister(random_device());
+    std::shuffle(arr.begin(), arr.end(), twister);
+    return arr;
+}
+
+
+// Empty file cached by the pool, the assertions read it directly once the storage is flushed
+auto open_file(const std::string &path) -> std::unique_ptr<Storage> {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path, std::ios::trunc).close();
+    return make_storage(streamStorage, path);
+}
+
+
+// First byte of the page stored at `pos`, as found in the file
+auto stored_byte(const std::string &path, std::int64_t pos) -> char {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(pos);
+    char byte = 0;
+    file.read(&byte, 1);
+    return byte;
+}
+
+
+// Appends a page filled with `byte` through the pool and leaves it dirty
+auto append_page(BufferPool &pool, char byte) -> std::int64_t {
+    std::int64_t const pos = pool.allocate(PAGE_BYTES);
+    char *frame = pool.pin(pos, PAGE_BYTES, false);
+    std::memset(frame, byte, PAGE_BYTES);
+    pool.unpin(pos, true);
+    return pos;
+}
+
+
+void counters_test(const std::string &path) {
+    std::unique_ptr<Storage> storage = open_file(path);
+    BufferPool pool(4);
+    pool.attach(storage.get());
+
+    // new pages are appended one after the other, without reading the file
+    for (int i = 0; i < 4; ++i) {
+        assert(append_page(pool, static_cast<char>('a' + i)) == i * static_cast<std::int64_t>(PAGE_BYTES));
+    }
+    BufferPoolStats stats = pool.stats();
+    assert(stats.misses == 4 && stats.hits == 0 && stats.evictions == 0 && stats.write_backs == 0);
+
+    // a resident page is a hit and its frame keeps the last bytes written to it
+    assert(pool.pin(PAGE_BYTES, PAGE_BYTES)[0] == 'b');
+    pool.unpin(PAGE_BYTES, false);
+    assert(pool.stats().hits == 1 && pool.stats().misses == 4);
+
+    // a fifth page evicts a dirty one, the other dirty frames reach the file in the same batch
+    append_page(pool, 'e');
+    stats = pool.stats();
+    assert(stats.evictions == 1 && stats.write_backs == 4);
+    storage->flush();
+    assert(stored_byte(path, 0) == 'a');
+
+    // the evicted page is read back from the file
+    assert(pool.pin(0, PAGE_BYTES)[0] == 'a');
+    pool.unpin(0, false);
+    assert(pool.stats().misses == 6);
+
+    pool.flush();
+    storage->flush();
+    for (int i = 0; i < 5; ++i) {
+        assert(stored_byte(path, i * static_cast<std::int64_t>(PAGE_BYTES)) == 'a' + i);
+    }
+}
+
+
+void pinned_frames_test(const std::string &path) {
+    std::unique_ptr<Storage> storage = open_file(path);
+    BufferPool pool(2);
+    pool.attach(storage.get());
+    std::int64_t const first = append_page(pool, 'a');
+    std::int64_t const second = append_page(pool, 'b');
+
+    // pinned frames are never evicted
+    char *first_frame = pool.pin(first, PAGE_BYTES);
+    pool.pin(second, PAGE_BYTES);
+    bool exhausted = false;
+    try {
+        pool.pin(append_page(pool, 'c'), PAGE_BYTES);
+    } catch (const BufferPoolExhausted &) {
+        exhausted = true;
+    }
+    assert(exhausted);
+
+    // nor resized under the pointer handed out for them
+    bool in_use = false;
+    try {
+        pool.pin(first, 2 * PAGE_BYTES);
+    } catch (const FrameInUse &) {
+        in_use = true;
+    }
+    assert(in_use);
+
+    // once unpinned, the frame is written back before it is read with the new size
+    pool.unpin(second, false);
+    pool.flush();
+    first_frame[0] = 'A';
+    pool.unpin(first, true);
+    char *frame = pool.pin(first, 2 * PAGE_BYTES);
+    assert(frame[0] == 'A' && frame[PAGE_BYTES] == 'b');
+    pool.unpin(first, false);
+}
+
+
+void clear_test(const std::string &path) {
+    std::unique_ptr<Storage> storage = open_file(path);
+    BufferPool pool(4);
+    pool.attach(storage.get());
+    std::int64_t const pos = append_page(pool, 'z');
+
+    // dropping the frames does not lose the dirty ones
+    pool.clear();
+    storage->flush();
+    assert(stored_byte(path, pos) == 'z');
+    assert(pool.pin(pos, PAGE_BYTES)[0] == 'z');
+    pool.unpin(pos, false);
+}
+
+
+// Batched reads bring in the missing pages only, and never take more than half of the pool
+void fetch_batch_test(const std::string &path) {
+    std::unique_ptr<Storage> storage = open_file(path);
+    std::vector<std::int64_t> positions;
+    {
+        BufferPool writer(4);
+        writer.attach(storage.get());
+        for (int i = 0; i < 6; ++i) {
+            positions.push_back(append_page(writer, static_cast<char>('a' + i)));
+        }
+        writer.flush();
+    }
+
+    BufferPool pool(8);
+    pool.attach(storage.get());
+    assert(pool.pin(positions[1], PAGE_BYTES)[0] == 'b');
+    pool.unpin(positions[1], false);
+
+    pool.fetch_batch(positions, PAGE_BYTES);
+    BufferPoolStats const stats = pool.stats();
+    assert(stats.misses == 5 && stats.evictions == 0);
+
+    // the pages of the batch are resident and unpinned
+    for (int i = 0; i < 5; ++i) {
+        assert(pool.pin(positions[i], PAGE_BYTES)[0] == 'a' + i);
+        pool.unpin(positions[i], false);
+    }
+    assert(pool.stats().hits == stats.hits + 5 && pool.stats().misses == 5);
+    assert(pool.pin(positions[5], PAGE_BYTES)[0] == 'f');
+    pool.unpin(positions[5], false);
+    assert(pool.stats().misses == 6);
+
+    // an empty batch reads nothing
+    pool.fetch_batch({}, PAGE_BYTES);
+    assert(pool.stats().misses == 6);
+}
+
+
+void tree_test(const int number_of_records, const int test) {
+    std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+        return record.id;
+    };
+
+    // a pool holding a couple of pages evicts on almost every access
+    for (std::int32_t const buffer_pool_capacity: { 2, 1024 }) {
+        std::string const file_name = "buffer_pool_by_id_" + std::to_string(buffer_pool_capacity) + "_" +
+                                      std::to_string(test);
+        std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+        Property const property(
+                "./index/record/",
+                "metadata_" + file_name,
+                file_name,
+                get_expected_index_page_capacity<std::int32_t>(),
+                get_expected_data_page_capacity<Record>(),
+                true,
+                buffer_pool_capacity
+        );
+        BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+
+        for (std::int32_t const key: generate_random_vector(number_of_records)) {
+            Record record(key, "p", key % 97);
+            tree.insert(record);
+        }
+
+        BufferPoolStats const loaded = tree.buffer_pool_stats();
+        for (std::int32_t key = 1; key <= number_of_records; ++key) {
+            std::vector<Record> const recovered = tree.search(key);
+            assert(recovered.size() == 1 && recovered.front().age == key % 97);
+        }
+        BufferPoolStats const searched = tree.buffer_pool_stats();
+
+        if (buffer_pool_capacity == 2) {
+            assert(searched.evictions > loaded.evictions);
+        } else {
+            // the whole tree is resident, searches never read the file
+            assert(searched.misses == loaded.misses && searched.hits > loaded.hits);
+            assert(searched.evictions == 0);
+        }
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+    std::string const path = "./index/record/buffer_pool_by_id.tree";
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        counters_test(path);
+        pinned_frames_test(path);
+        clear_test(path);
+        fetch_batch_test(path);
+        tree_test(NUMBER_OF_RECORDS, TEST);
+        std::cout << "Buffer pool test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
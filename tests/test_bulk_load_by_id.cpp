@@ -0,0 +1,184 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, std::int32_t capacity, bool unique) -> Property {
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    return Property(
+            "./index/record/",
+            "metadata_" + file_name,
+            file_name,
+            capacity == 0 ? get_expected_index_page_capacity<std::int32_t>() : capacity,
+            capacity == 0 ? get_expected_data_page_capacity<Record>() : capacity,
+            unique
+    );
+}
+
+
+// Records with the keys 1..number_of_records, each one repeated `copies` times, in order
+auto sorted_records(const int number_of_records, const int copies) -> std::vector<Record> {
+    std::vector<Record> records;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        for (int copy = 0; copy < copies; ++copy) {
+            records.emplace_back(key, "b", key % 97);
+        }
+    }
+    return records;
+}
+
+
+// Every key in [1, number_of_records] is found `copies` times, in order from both ends of the leaf chain
+void check_contents(RecordTree &tree, const int number_of_records, const int copies) {
+    assert(tree.search(0).empty());
+    assert(tree.search(number_of_records + 1).empty());
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(static_cast<int>(recovered.size()) == copies);
+        for (const Record &record: recovered) {
+            assert(record.id == key && record.age == key % 97);
+        }
+    }
+
+    std::vector<Record> const ascending = tree.above(0);
+    std::vector<Record> const descending = tree.below(number_of_records + 1);
+    assert(static_cast<int>(ascending.size()) == number_of_records * copies);
+    assert(ascending.size() == descending.size());
+    for (std::size_t i = 0; i < ascending.size(); ++i) {
+        assert(ascending[i].id == static_cast<std::int32_t>(i) / copies + 1);
+        assert(descending[descending.size() - 1 - i].id == ascending[i].id);
+    }
+}
+
+
+// Loads exactly `number_of_records` keys, which exercises the empty input, a single record, a root leaf
+// at its capacity and the rebalancing of a short last leaf
+void sizes_test(const int test) {
+    for (double const fill_factor: { 0.5, 0.75, 1.0 }) {
+        for (int const number_of_records: { 0, 1, SMALL_CAPACITY - 1, SMALL_CAPACITY, SMALL_CAPACITY + 1,
+                                            SMALL_CAPACITY * SMALL_CAPACITY, SMALL_CAPACITY * SMALL_CAPACITY + 1 }) {
+            Property const property = make_property("bulk_load_by_id_sizes_" + std::to_string(test),
+                                                    SMALL_CAPACITY, true);
+            std::vector<Record> records = sorted_records(number_of_records, 1);
+            {
+                RecordTree tree(property, get_indexed_field);
+                tree.bulk_load(records.begin(), records.end(), fill_factor);
+                check_contents(tree, number_of_records, 1);
+            }
+
+            // the loaded pages take regular inserts and removes once reopened
+            RecordTree tree(property, get_indexed_field);
+            check_contents(tree, number_of_records, 1);
+            for (std::int32_t key = number_of_records + 1; key <= 2 * number_of_records; ++key) {
+                Record record(key, "i", key % 97);
+                tree.insert(record);
+            }
+            check_contents(tree, 2 * number_of_records, 1);
+            for (std::int32_t key = 2 * number_of_records; key > 0; --key) {
+                tree.remove(key);
+            }
+            assert(tree.above(0).empty());
+        }
+    }
+}
+
+
+void duplicates_test(const int number_of_records, const int test) {
+    std::vector<Record> records = sorted_records(number_of_records, 3);
+    RecordTree tree(make_property("bulk_load_by_id_duplicates_" + std::to_string(test), SMALL_CAPACITY, false),
+                    get_indexed_field);
+    tree.bulk_load(records.begin(), records.end(), 1.0);
+    check_contents(tree, number_of_records, 3);
+}
+
+
+void rejections_test(const int number_of_records, const int test) {
+    std::vector<Record> records = sorted_records(number_of_records, 1);
+    RecordTree tree(make_property("bulk_load_by_id_rejections_" + std::to_string(test), SMALL_CAPACITY, true),
+                    get_indexed_field);
+
+    // the input must be sorted, a rejected batch leaves the tree empty
+    std::vector<Record> unsorted(records);
+    std::swap(unsorted[unsorted.size() / 2], unsorted.back());
+    bool rejected = false;
+    try {
+        tree.bulk_load(unsorted.begin(), unsorted.end());
+    } catch (const UnsortedInput &) {
+        rejected = true;
+    }
+    assert(rejected);
+    assert(tree.above(0).empty());
+
+    // only an empty tree is bulk loaded
+    tree.bulk_load(records.begin(), records.end());
+    rejected = false;
+    try {
+        tree.bulk_load(records.begin(), records.end());
+    } catch (const NotEmptyIndex &) {
+        rejected = true;
+    }
+    assert(rejected);
+    check_contents(tree, number_of_records, 1);
+}
+
+
+// Full leaves take fewer pages than the ones left behind by random inserts
+void fill_factor_test(const int number_of_records, const int test) {
+    std::string const loaded_name = "bulk_load_by_id_loaded_" + std::to_string(test);
+    std::string const inserted_name = "bulk_load_by_id_inserted_" + std::to_string(test);
+    std::vector<Record> records = sorted_records(number_of_records, 1);
+    {
+        RecordTree loaded(make_property(loaded_name, SMALL_CAPACITY * 4, true), get_indexed_field);
+        loaded.bulk_load(records.begin(), records.end(), 1.0);
+
+        RecordTree inserted(make_property(inserted_name, SMALL_CAPACITY * 4, true), get_indexed_field);
+        std::shuffle(records.begin(), records.end(), std::mt19937(test));
+        for (Record &record: records) {
+            inserted.insert(record);
+        }
+    }
+
+    assert(std::filesystem::file_size("./index/record/" + loaded_name + ".tree") <
+           std::filesystem::file_size("./index/record/" + inserted_name + ".tree"));
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        sizes_test(TEST);
+        duplicates_test(NUMBER_OF_RECORDS, TEST);
+        rejections_test(NUMBER_OF_RECORDS, TEST);
+        fill_factor_test(NUMBER_OF_RECORDS, TEST);
+
+        // the default capacities build a shallow tree with wide pages
+        std::vector<Record> records = sorted_records(NUMBER_OF_RECORDS, 1);
+        RecordTree tree(make_property("bulk_load_by_id_" + std::to_string(TEST), 0, true), get_indexed_field);
+        tree.bulk_load(records.begin(), records.end());
+        check_contents(tree, NUMBER_OF_RECORDS, 1);
+        std::cout << "Bulk load test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
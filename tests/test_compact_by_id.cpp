@@ -0,0 +1,251 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name) -> Property {
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    return Property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY, true);
+}
+
+
+auto file_size(RecordTree &tree, const Property &property) -> std::uintmax_t {
+    tree.flush();
+    return std::filesystem::file_size(property.INDEX_FULL_PATH);
+}
+
+
+auto shuffled_keys(std::int32_t first, std::int32_t last, std::mt19937 &twister) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = first; key <= last; ++key) {
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    return keys;
+}
+
+
+void insert_keys(RecordTree &tree, std::set<std::int32_t> &model, const std::vector<std::int32_t> &keys) {
+    for (std::int32_t const key: keys) {
+        Record record(key, "c", key % 97);
+        tree.insert(record);
+        model.insert(key);
+    }
+}
+
+
+void remove_keys(RecordTree &tree, std::set<std::int32_t> &model, const std::vector<std::int32_t> &keys) {
+    for (std::int32_t const key: keys) {
+        tree.remove(key);
+        model.erase(key);
+    }
+}
+
+
+// The tree holds exactly the keys of the model, reachable by search and in order through the leaf chain
+void check_contents(RecordTree &tree, const std::set<std::int32_t> &model, std::int32_t max_key) {
+    for (std::int32_t key = 0; key <= max_key + 1; ++key) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(recovered.size() == model.count(key));
+        assert(recovered.empty() || recovered.front().age == key % 97);
+    }
+
+    std::vector<Record> const ascending = tree.above(0);
+    assert(ascending.size() == model.size());
+    assert(std::equal(ascending.begin(), ascending.end(), model.begin(),
+                      [](const Record &record, std::int32_t key) { return record.id == key; }));
+    assert(tree.below(max_key + 1).size() == model.size());
+}
+
+
+// Pages released by merges are taken again by splits before the file grows
+void free_list_test(const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property("compact_by_id_free_list");
+    RecordTree tree(property, get_indexed_field);
+    std::set<std::int32_t> model;
+
+    insert_keys(tree, model, shuffled_keys(1, number_of_records, twister));
+    std::vector<std::int32_t> removed = shuffled_keys(1, number_of_records, twister);
+    removed.resize(3 * number_of_records / 4);
+    remove_keys(tree, model, removed);
+    check_contents(tree, model, number_of_records);
+
+    std::uintmax_t const size = file_size(tree, property);
+    insert_keys(tree, model, std::vector<std::int32_t>(removed.begin(), removed.begin() + number_of_records / 8));
+    assert(file_size(tree, property) == size);
+    check_contents(tree, model, number_of_records);
+}
+
+
+// A tree emptied by removes keeps its pages in the free lists, inserts and bulk loads take them back
+void emptied_tree_test(const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property("compact_by_id_emptied");
+    RecordTree tree(property, get_indexed_field);
+    std::set<std::int32_t> model;
+
+    insert_keys(tree, model, shuffled_keys(1, number_of_records, twister));
+    remove_keys(tree, model, shuffled_keys(1, number_of_records, twister));
+    check_contents(tree, model, number_of_records);
+    std::uintmax_t const size = file_size(tree, property);
+
+    // the root leaf of the next insert is a released page
+    insert_keys(tree, model, { 1 });
+    assert(file_size(tree, property) == size);
+    remove_keys(tree, model, { 1 });
+
+    // full leaves need fewer pages than the ones left by random inserts
+    std::vector<Record> records;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        records.emplace_back(key, "c", key % 97);
+        model.insert(key);
+    }
+    tree.bulk_load(records.begin(), records.end(), 1.0);
+    assert(file_size(tree, property) == size);
+    check_contents(tree, model, number_of_records);
+}
+
+
+void compact_test(const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property("compact_by_id");
+    std::set<std::int32_t> model;
+
+    {
+        RecordTree tree(property, get_indexed_field);
+
+        // an empty tree compacts into an empty file
+        tree.compact();
+        assert(file_size(tree, property) == 0);
+        check_contents(tree, model, number_of_records);
+
+        insert_keys(tree, model, shuffled_keys(1, number_of_records, twister));
+        std::vector<std::int32_t> removed = shuffled_keys(1, number_of_records, twister);
+        removed.resize(3 * number_of_records / 4);
+        remove_keys(tree, model, removed);
+
+        std::uintmax_t const size = file_size(tree, property);
+        tree.compact(std::uniform_real_distribution<double>(0.5, 1.0)(twister));
+        assert(file_size(tree, property) < size);
+        assert(!std::filesystem::exists(property.INDEX_FULL_PATH + COMPACT_FILE_EXTENSION));
+        assert(!std::filesystem::exists(property.METADATA_FULL_PATH + COMPACT_FILE_EXTENSION));
+        check_contents(tree, model, number_of_records);
+
+        // the compacted tree takes regular inserts and removes
+        insert_keys(tree, model, std::vector<std::int32_t>(removed.begin(), removed.begin() + number_of_records / 4));
+        std::vector<std::int32_t> present(model.begin(), model.end());
+        std::shuffle(present.begin(), present.end(), twister);
+        present.resize(present.size() / 2);
+        remove_keys(tree, model, present);
+        check_contents(tree, model, number_of_records);
+    }
+
+    RecordTree tree(property, get_indexed_field);
+    check_contents(tree, model, number_of_records);
+
+    // a tree emptied by removes compacts into an empty file as well
+    remove_keys(tree, model, std::vector<std::int32_t>(model.begin(), model.end()));
+    tree.compact();
+    assert(file_size(tree, property) == 0);
+    check_contents(tree, model, number_of_records);
+}
+
+
+// Leaves the files of a compaction interrupted at each step, then checks that opening the tree completes it or
+// rolls it back
+void interrupted_compact_test(const int number_of_records, std::mt19937 &twister) {
+    namespace fs = std::filesystem;
+    Property const property = make_property("interrupted_compact_by_id");
+    std::string const index_path = property.INDEX_FULL_PATH;
+    std::string const metadata_path = property.METADATA_FULL_PATH;
+    std::set<std::int32_t> model;
+
+    {
+        RecordTree tree(property, get_indexed_field);
+        insert_keys(tree, model, shuffled_keys(1, number_of_records, twister));
+        std::vector<std::int32_t> removed = shuffled_keys(1, number_of_records, twister);
+        removed.resize(number_of_records / 2);
+        remove_keys(tree, model, removed);
+    }
+    auto const copy = [](const std::string &from, const std::string &to) {
+        fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+    };
+    copy(index_path, index_path + ".old");
+    copy(metadata_path, metadata_path + ".old");
+    {
+        RecordTree tree(property, get_indexed_field);
+        tree.compact();
+    }
+    copy(index_path, index_path + ".new");
+    copy(metadata_path, metadata_path + ".new");
+
+    auto const reopen = [&](const std::string &expected_index) {
+        {
+            RecordTree tree(property, get_indexed_field);
+            check_contents(tree, model, number_of_records);
+        }
+        assert(fs::file_size(index_path) == fs::file_size(expected_index));
+        assert(!fs::exists(index_path + COMPACT_FILE_EXTENSION));
+        assert(!fs::exists(metadata_path + COMPACT_FILE_EXTENSION));
+    };
+
+    // the new tree is complete but its metadata is not in place yet
+    copy(index_path + ".old", index_path);
+    copy(metadata_path + ".old", metadata_path);
+    copy(index_path + ".new", index_path + COMPACT_FILE_EXTENSION);
+    reopen(index_path + ".old");
+
+    // the metadata of the new tree is in place, nothing was renamed
+    copy(index_path + ".old", index_path);
+    copy(metadata_path + ".old", metadata_path);
+    copy(index_path + ".new", index_path + COMPACT_FILE_EXTENSION);
+    copy(metadata_path + ".new", metadata_path + COMPACT_FILE_EXTENSION);
+    reopen(index_path + ".new");
+
+    // the index file was renamed
+    copy(index_path + ".new", index_path);
+    copy(metadata_path + ".old", metadata_path);
+    copy(metadata_path + ".new", metadata_path + COMPACT_FILE_EXTENSION);
+    reopen(index_path + ".new");
+
+    for (const std::string &path: { index_path, metadata_path }) {
+        fs::remove(path + ".old");
+        fs::remove(path + ".new");
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        free_list_test(NUMBER_OF_RECORDS, twister);
+        emptied_tree_test(NUMBER_OF_RECORDS, twister);
+        compact_test(NUMBER_OF_RECORDS, twister);
+        interrupted_compact_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "Compact test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
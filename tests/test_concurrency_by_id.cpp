@@ -0,0 +1,170 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+// Small pages, so that concurrent writers split, borrow from and merge the leaves they share
+std::int32_t const INDEX_PAGE_CAPACITY = 6;
+std::int32_t const DATA_PAGE_CAPACITY = 6;
+
+// Width of the key ranges scanned by the workers
+std::int32_t const SCAN_WIDTH = 40;
+
+
+auto get_indexed_field(Record &record) -> std::int32_t {
+    return record.id;
+}
+
+
+// Each worker writes the keys congruent to its id modulo the number of workers, so the keys of all workers
+// interleave on the same leaves. The records of its own keys only change through the worker, which checks them
+// against its model while it reads every key of the tree.
+void run_worker(BPlusTree<std::int32_t, Record> &tree, const int worker, const int number_of_workers,
+                const int number_of_operations, const std::int32_t key_space, std::set<std::int32_t> &model) {
+    std::mt19937 twister(worker + 1);
+    std::int32_t const own_keys = key_space / number_of_workers;
+
+    for (int i = 0; i < number_of_operations; ++i) {
+        std::int32_t const key = static_cast<std::int32_t>(twister() % own_keys) * number_of_workers + worker + 1;
+        unsigned const operation = twister() % 12;
+
+        if (operation < 6) {
+            // toggles the key
+            if (model.count(key) > 0) {
+                tree.remove(key);
+                model.erase(key);
+            } else {
+                Record record {key, "u", worker};
+                tree.insert(record);
+                model.insert(key);
+            }
+        } else if (operation < 8) {
+            std::vector<Record> const recovered = tree.search(key);
+            assert(recovered.size() == model.count(key));
+        } else if (operation < 10) {
+            std::int32_t const upper_bound = key + SCAN_WIDTH;
+            std::vector<Record> const recovered = tree.between(key, upper_bound);
+            assert(std::is_sorted(recovered.begin(), recovered.end(), [](const Record &a, const Record &b) {
+                return a.id < b.id;
+            }));
+
+            std::vector<std::int32_t> found;
+            for (const Record &record: recovered) {
+                assert(key <= record.id && record.id <= upper_bound);
+                if ((record.id - 1) % number_of_workers == worker) {
+                    found.push_back(record.id);
+                }
+            }
+            std::vector<std::int32_t> const expected(model.lower_bound(key), model.upper_bound(upper_bound));
+            assert(found == expected);
+        } else {
+            // a scan that writes inside its loop holds no latch between two steps, and still visits each of the
+            // worker keys once, while the other workers change the leaves around them
+            std::int32_t const upper_bound = key + SCAN_WIDTH;
+            std::vector<std::int32_t> found;
+            for (Record &record: tree.scan_between(key, upper_bound)) {
+                if ((record.id - 1) % number_of_workers == worker) {
+                    found.push_back(record.id);
+                    tree.remove(record.id);
+                }
+            }
+            std::vector<std::int32_t> const expected(model.lower_bound(key), model.upper_bound(upper_bound));
+            assert(found == expected);
+            for (std::int32_t const removed: found) {
+                Record record {removed, "u", worker};
+                tree.insert(record);
+            }
+        }
+    }
+}
+
+
+auto collect_keys(BPlusTree<std::int32_t, Record> &tree, const std::int32_t key_space) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (const Record &record: tree.between(1, key_space)) {
+        keys.push_back(record.id);
+    }
+    return keys;
+}
+
+
+void test_concurrency(const Property &property, const int number_of_workers, const int number_of_operations) {
+    BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+    std::int32_t const key_space = number_of_workers * std::max(number_of_operations / 4, 1);
+
+    std::vector<std::set<std::int32_t>> models(number_of_workers);
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < number_of_workers; ++worker) {
+        workers.emplace_back(run_worker, std::ref(tree), worker, number_of_workers, number_of_operations,
+                             key_space, std::ref(models[worker]));
+    }
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    std::set<std::int32_t> model;
+    for (const std::set<std::int32_t> &worker_model: models) {
+        model.insert(worker_model.begin(), worker_model.end());
+    }
+
+    std::vector<std::int32_t> const expected(model.begin(), model.end());
+    assert(collect_keys(tree, key_space) == expected);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 4) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_WORKERS = atoi(argv[2]);
+    int const NUMBER_OF_OPERATIONS = atoi(argv[3]);
+    bool const unique = true;
+    std::string const path = "./index/record/";
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        // every backend serves reads and writes of several threads at once. The log of durable trees is also
+        // appended concurrently by the writers of a leaf, and the pinned index is read by writers locating their
+        // leaf while splits and merges rebuild it.
+        std::vector<std::tuple<std::string, StorageBackend, bool, bool>> const variants = {
+                { "stream", streamStorage, false, false },
+                { "mmap", mmapStorage, false, false },
+                { "uring", uringStorage, false, false },
+                { "positional", positionalStorage, false, false },
+                { "durable", positionalStorage, true, false },
+                { "pinned", positionalStorage, false, true },
+        };
+        for (const auto &[variant, backend, durable, pinned_index]: variants) {
+            std::string const index_file_name = "concurrent_index_by_id_" + variant + "_" + std::to_string(TEST);
+            Property const property(
+                    path,
+                    "metadata_" + index_file_name,
+                    index_file_name,
+                    INDEX_PAGE_CAPACITY,
+                    DATA_PAGE_CAPACITY,
+                    unique,
+                    256,
+                    backend,
+                    durable,
+                    pinned_index
+            );
+            std::filesystem::remove(property.METADATA_FULL_PATH);
+            std::filesystem::remove(property.INDEX_FULL_PATH);
+            std::filesystem::remove(property.INDEX_FULL_PATH + WAL_FILE_EXTENSION);
+
+            test_concurrency(property, NUMBER_OF_WORKERS, NUMBER_OF_OPERATIONS);
+            std::cout << "Concurrency test passed for " << variant << " index #" << TEST << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, bool unique) -> Property {
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    return Property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY, unique);
+}
+
+
+void insert_keys(RecordTree &tree, std::multiset<std::int32_t> &model, std::vector<std::int32_t> keys,
+                 std::mt19937 &twister) {
+    std::shuffle(keys.begin(), keys.end(), twister);
+    for (std::int32_t const key: keys) {
+        Record record(key, "s", key % 97);
+        tree.insert(record);
+        model.insert(key);
+    }
+}
+
+
+// Keys visited by a cursor through its iterator
+auto drain(Cursor<std::int32_t, Record, std::greater<std::int32_t>, std::function<std::int32_t(Record &)>> cursor)
+        -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (Record &record: cursor) {
+        keys.push_back(record.id);
+    }
+    return keys;
+}
+
+
+// The first `limit` keys of `keys`
+auto limited(std::vector<std::int32_t> keys, const std::size_t limit) -> std::vector<std::int32_t> {
+    keys.resize(std::min(keys.size(), limit));
+    return keys;
+}
+
+
+auto reversed(std::vector<std::int32_t> keys) -> std::vector<std::int32_t> {
+    std::reverse(keys.begin(), keys.end());
+    return keys;
+}
+
+
+// Every bound from before the first key to past the last one, with limits from none to more than the records
+void check_cursors(RecordTree &tree, const std::multiset<std::int32_t> &model, const std::int32_t max_key) {
+    std::vector<std::int32_t> const ascending(model.begin(), model.end());
+    std::size_t const limits[] = { 0, 1, 7, ascending.size(), ascending.size() + 3, NO_LIMIT };
+
+    for (std::size_t const limit: limits) {
+        assert(drain(tree.scan(forwardScan, limit)) == limited(ascending, limit));
+        assert(drain(tree.scan(backwardScan, limit)) == limited(reversed(ascending), limit));
+    }
+
+    for (std::int32_t bound = -1; bound <= max_key + 1; ++bound) {
+        std::vector<std::int32_t> const above(model.lower_bound(bound), model.end());
+        std::vector<std::int32_t> const below = reversed({ model.begin(), model.upper_bound(bound) });
+        std::vector<std::int32_t> const single(model.lower_bound(bound), model.upper_bound(bound));
+        std::vector<std::int32_t> const range(model.lower_bound(bound), model.upper_bound(bound + 5));
+        std::size_t const limit = limits[(bound + 1) % std::size(limits)];
+
+        assert(drain(tree.scan_above(bound, limit)) == limited(above, limit));
+        assert(drain(tree.scan_below(bound, limit)) == limited(below, limit));
+        assert(drain(tree.scan_between(bound, bound)) == single);
+        assert(drain(tree.scan_between(bound, bound + 5, limit)) == limited(range, limit));
+        // an inverted range is empty
+        assert(drain(tree.scan_between(bound + 1, bound)).empty());
+    }
+
+    // cursors are also stepped by hand
+    std::vector<std::int32_t> stepped;
+    for (auto cursor = tree.scan_below(max_key / 2); cursor.valid(); cursor.next()) {
+        stepped.push_back(cursor.record().id);
+    }
+    assert(stepped == reversed({ model.begin(), model.upper_bound(max_key / 2) }));
+}
+
+
+void ranges_test(const int number_of_records, const bool unique, std::mt19937 &twister) {
+    RecordTree tree(make_property(std::string("cursor_by_id_") + (unique ? "unique" : "duplicates"), unique),
+                    get_indexed_field);
+    std::multiset<std::int32_t> model;
+    check_cursors(tree, model, number_of_records);
+
+    // without unique keys every key is inserted three times, so runs of equal keys cross leaves
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; key += 2) {
+        keys.insert(keys.end(), unique ? 1 : 3, key);
+    }
+    insert_keys(tree, model, keys, twister);
+    check_cursors(tree, model, number_of_records);
+
+    // removals leave sparse leaves and move the leaf links
+    for (std::int32_t key = 1; key <= number_of_records; key += 6) {
+        tree.remove(key);
+        model.erase(model.find(key));
+    }
+    check_cursors(tree, model, number_of_records);
+}
+
+
+// Scans that modify the tree on every step still visit each record that is not removed exactly once
+void modified_scans_test(const int number_of_records, std::mt19937 &twister) {
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.push_back(key);
+    }
+
+    for (ScanDirection const direction: { forwardScan, backwardScan }) {
+        RecordTree tree(make_property("cursor_by_id_modified", true), get_indexed_field);
+        std::multiset<std::int32_t> model;
+        insert_keys(tree, model, keys, twister);
+
+        // every record visited is removed, merges release the leaves behind the cursor
+        std::vector<std::int32_t> visited;
+        for (Record &record: tree.scan(direction)) {
+            visited.push_back(record.id);
+            tree.remove(record.id);
+        }
+        assert(visited == (direction == forwardScan ? keys : reversed(keys)));
+        assert(drain(tree.scan()).empty());
+
+        // records inserted ahead of the cursor are visited, the ones inserted behind it are not
+        model.clear();
+        insert_keys(tree, model, keys, twister);
+        visited.clear();
+        for (Record &record: tree.scan(direction)) {
+            visited.push_back(record.id);
+            std::int32_t const offset = (direction == forwardScan) ? number_of_records : -number_of_records;
+            if (record.id >= 1 && record.id <= number_of_records) {
+                Record ahead(record.id + offset, "a", 0);
+                Record behind(record.id - offset, "b", 0);
+                tree.insert(ahead);
+                tree.insert(behind);
+            }
+        }
+        std::vector<std::int32_t> expected = keys;
+        for (std::int32_t const key: keys) {
+            expected.push_back(key + (direction == forwardScan ? number_of_records : -number_of_records));
+        }
+        std::sort(expected.begin(), expected.end());
+        if (direction == backwardScan) {
+            std::reverse(expected.begin(), expected.end());
+        }
+        assert(visited == expected);
+    }
+}
+
+
+// A scan whose remaining records are all removed in one step ends right away
+void truncated_scan_test(const int number_of_records, std::mt19937 &twister) {
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.push_back(key);
+    }
+
+    for (ScanDirection const direction: { forwardScan, backwardScan }) {
+        RecordTree tree(make_property("cursor_by_id_truncated", true), get_indexed_field);
+        std::multiset<std::int32_t> model;
+        insert_keys(tree, model, keys, twister);
+
+        std::vector<std::int32_t> visited;
+        for (Record &record: tree.scan(direction)) {
+            visited.push_back(record.id);
+            if (visited.size() == 3) {
+                for (std::int32_t const key: keys) {
+                    if (key != record.id) {
+                        tree.remove(key);
+                    }
+                }
+            }
+        }
+        assert(visited.size() == std::min<std::size_t>(3, keys.size()));
+        assert(drain(tree.scan()).size() == std::min<std::size_t>(1, keys.size()));
+    }
+}
+
+
+// Duplicates already returned are skipped when the scan is located again
+void modified_duplicates_test(const int number_of_records, std::mt19937 &twister) {
+    RecordTree tree(make_property("cursor_by_id_modified_duplicates", false), get_indexed_field);
+    std::multiset<std::int32_t> model;
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.insert(keys.end(), 3, key);
+    }
+    insert_keys(tree, model, keys, twister);
+
+    std::vector<std::int32_t> visited;
+    for (Record &record: tree.scan_above(1)) {
+        visited.push_back(record.id);
+        // a record inserted far behind the cursor makes it locate the scan again on every step
+        Record behind(-static_cast<std::int32_t>(visited.size()), "b", 0);
+        tree.insert(behind);
+    }
+    std::sort(keys.begin(), keys.end());
+    assert(visited == keys);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        ranges_test(NUMBER_OF_RECORDS, true, twister);
+        ranges_test(NUMBER_OF_RECORDS, false, twister);
+        modified_scans_test(NUMBER_OF_RECORDS, twister);
+        truncated_scan_test(NUMBER_OF_RECORDS, twister);
+        modified_duplicates_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "Cursor test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
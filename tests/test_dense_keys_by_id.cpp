@@ -0,0 +1,143 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+// Record indexed by a float, whose leaves are searched by the vectorized KeySearch
+struct Measurement {
+    std::int32_t id;
+    float value;
+};
+
+
+// Pages small enough to split, borrow and merge often, and pages spanning several vectorized search windows
+std::int32_t const CAPACITIES[] = { 4, static_cast<std::int32_t>(3 * SIMD_SEARCH_WINDOW + 5) };
+
+
+auto make_property(const std::string &file_name, std::int32_t data_capacity) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, 4, data_capacity, false);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+// Every bound search of the leaves, through the key array of each page they cross, matches the model
+template<typename Tree, typename FieldType, typename Record>
+void check_bounds(Tree &tree, const std::multiset<FieldType> &model, const std::vector<FieldType> &probes,
+                  FieldType Record::*field) {
+    auto const keys_of = [field](const std::vector<Record> &records) {
+        std::vector<FieldType> keys;
+        for (const Record &record: records) {
+            keys.push_back(record.*field);
+        }
+        return keys;
+    };
+
+    assert(keys_of(tree.above(probes.front())) == std::vector<FieldType>(model.begin(), model.end()));
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+        FieldType const &probe = probes[i];
+        assert(keys_of(tree.search(probe)) ==
+               std::vector<FieldType>(model.lower_bound(probe), model.upper_bound(probe)));
+        // open ranges read most of the leaves, a few of them are enough
+        if (i % 64 == 0 || i + 1 == probes.size()) {
+            assert(keys_of(tree.above(probe)) == std::vector<FieldType>(model.lower_bound(probe), model.end()));
+            std::vector<FieldType> below(model.begin(), model.upper_bound(probe));
+            std::reverse(below.begin(), below.end());
+            assert(keys_of(tree.below(probe)) == below);
+        }
+    }
+}
+
+
+// Every mutation of a leaf (insert, removal, split, borrow, merge, bulk load and reading it back from the
+// file) keeps the key array of the page in step with its records
+template<typename FieldType, typename Record>
+void dense_keys_test(const std::string &name, const std::vector<FieldType> &values, FieldType Record::*field,
+                     std::int32_t data_capacity, std::mt19937 &twister) {
+    Property const property = make_property(name + "_" + std::to_string(data_capacity), data_capacity);
+    std::multiset<FieldType> model;
+    std::vector<FieldType> probes(values.begin(), values.end());
+    std::sort(probes.begin(), probes.end());
+    probes.insert(probes.begin(), probes.front() - 1);
+    probes.push_back(probes.back() + 1);
+
+    std::vector<Record> records;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        Record record {};
+        record.id = static_cast<std::int32_t>(i);
+        record.*field = values[i];
+        records.push_back(record);
+    }
+
+    {
+        BPlusTree tree(property, field);
+        check_bounds(tree, model, probes, field);
+        std::shuffle(records.begin(), records.end(), twister);
+        for (Record &record: records) {
+            tree.insert(record);
+            model.insert(record.*field);
+        }
+        check_bounds(tree, model, probes, field);
+
+        for (std::size_t i = 0; i < records.size() / 2; ++i) {
+            tree.remove(records[i].*field);
+            model.erase(model.find(records[i].*field));
+        }
+        check_bounds(tree, model, probes, field);
+    }
+
+    // the keys are extracted again when the pages are read from the file
+    {
+        BPlusTree tree(property, field);
+        check_bounds(tree, model, probes, field);
+        tree.compact();
+        check_bounds(tree, model, probes, field);
+    }
+
+    Property const loaded_property = make_property(name + "_loaded_" + std::to_string(data_capacity),
+                                                   data_capacity);
+    BPlusTree tree(loaded_property, field);
+    std::sort(records.begin(), records.end(), [field](const Record &a, const Record &b) {
+        return a.*field < b.*field;
+    });
+    tree.bulk_load(records.begin(), records.end());
+    check_bounds(tree, std::multiset<FieldType>(values.begin(), values.end()), probes, field);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        // keys are repeated, so runs of equal keys cross leaves, and negative ones precede the rest
+        std::uniform_int_distribution<std::int32_t> distribution(-NUMBER_OF_RECORDS / 4, NUMBER_OF_RECORDS / 4);
+        std::vector<std::int32_t> ids;
+        std::vector<float> values;
+        for (int i = 0; i < NUMBER_OF_RECORDS; ++i) {
+            ids.push_back(distribution(twister));
+            values.push_back(static_cast<float>(distribution(twister)) / 4);
+        }
+
+        for (std::int32_t const data_capacity: CAPACITIES) {
+            dense_keys_test("dense_keys_by_id", ids, &Record::id, data_capacity, twister);
+            dense_keys_test("dense_keys_by_value", values, &Measurement::value, data_capacity, twister);
+        }
+        std::cout << "Dense keys test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
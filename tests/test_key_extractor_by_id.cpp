@@ -0,0 +1,137 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+auto get_indexed_field(Record &record) -> std::int32_t {
+    return record.id;
+}
+
+
+// Extractors are checked when the tree is instantiated
+static_assert(KeyExtractor<key_of<&Record::id>, Record, std::int32_t>);
+static_assert(KeyExtractor<decltype(&Record::id), Record, std::int32_t>);
+static_assert(KeyExtractor<decltype(&get_indexed_field), Record, std::int32_t>);
+static_assert(KeyExtractor<std::function<std::int32_t(Record &)>, Record, std::int32_t>);
+static_assert(KeyExtractor<key_of<&Record::id>, Record, std::int64_t>);
+static_assert(!KeyExtractor<key_of<&Record::id>, Record, std::string>);
+static_assert(!KeyExtractor<decltype(&get_indexed_field), std::string, std::int32_t>);
+
+
+auto make_property(const std::string &file_name, bool unique) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY,
+                            unique);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+// Inserts the records in random order, removes half of them and compacts the tree, checking every lookup
+// against a model after each step. `order` sorts the keys as the leaves of the tree hold them.
+template<typename Tree, typename KeyOf, typename Order>
+void check_extractor(Tree &tree, const std::vector<Record> &records, KeyOf key_of_record, Order order,
+                     std::mt19937 &twister) {
+    std::multiset<std::int32_t, Order> model(order);
+    auto const check = [&] {
+        std::vector<std::int32_t> scanned;
+        for (Record &record: tree.scan()) {
+            scanned.push_back(key_of_record(record));
+        }
+        assert(std::equal(scanned.begin(), scanned.end(), model.begin(), model.end()));
+
+        for (const Record &record: records) {
+            std::int32_t const key = key_of_record(record);
+            std::vector<Record> const located = tree.search(key);
+            assert(located.size() == model.count(key));
+            assert(std::all_of(located.begin(), located.end(), [&](Record found) {
+                return key_of_record(found) == key;
+            }));
+        }
+    };
+
+    std::vector<Record> shuffled = records;
+    std::shuffle(shuffled.begin(), shuffled.end(), twister);
+    for (Record &record: shuffled) {
+        tree.insert(record);
+        model.insert(key_of_record(record));
+    }
+    check();
+
+    for (std::size_t i = 0; i < shuffled.size() / 2; ++i) {
+        std::int32_t const key = key_of_record(shuffled[i]);
+        tree.remove(key);
+        model.erase(model.find(key));
+    }
+    check();
+
+    tree.compact();
+    check();
+}
+
+
+void key_extractor_test(const int number_of_records, std::mt19937 &twister) {
+    std::vector<Record> records;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        records.emplace_back(key, "k", key % 97);
+    }
+    auto const by_id = [](const Record &record) { return record.id; };
+    std::less<std::int32_t> const ascending;
+
+    // the key and record types are deduced from the extractor
+    BPlusTree key_of_tree(make_property("key_extractor_by_id_key_of", true), key_of<&Record::id>{});
+    static_assert(std::is_same_v<decltype(key_of_tree), BPlusTree<std::int32_t, Record, std::greater<std::int32_t>,
+                                                                  key_of<&Record::id>>>);
+    check_extractor(key_of_tree, records, by_id, ascending, twister);
+
+    BPlusTree member_tree(make_property("key_extractor_by_id_member", true), &Record::id);
+    check_extractor(member_tree, records, by_id, ascending, twister);
+
+    BPlusTree function_tree(make_property("key_extractor_by_id_function", true), &get_indexed_field);
+    check_extractor(function_tree, records, by_id, ascending, twister);
+
+    // the default std::function extractor keeps working as before
+    BPlusTree<std::int32_t, Record> wrapped_tree(make_property("key_extractor_by_id_wrapped", true),
+                                                 get_indexed_field);
+    check_extractor(wrapped_tree, records, by_id, ascending, twister);
+
+    // lambdas may compute the key and carry state, which compact() hands to the rebuilt tree
+    std::int32_t const offset = 1000;
+    auto const shifted = [offset](Record &record) { return record.age + offset; };
+    BPlusTree shifted_tree(make_property("key_extractor_by_id_shifted", false), shifted);
+    check_extractor(shifted_tree, records, [offset](const Record &record) { return record.age + offset; },
+                    ascending, twister);
+
+    // the comparator is deduced along with the extractor, a reversed one keeps the leaves in descending order
+    BPlusTree reversed_tree(make_property("key_extractor_by_id_reversed", true), key_of<&Record::id>{},
+                            std::less<std::int32_t>());
+    check_extractor(reversed_tree, records, by_id, std::greater<std::int32_t>(), twister);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        key_extractor_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "Key extractor test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
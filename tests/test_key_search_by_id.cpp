@@ -0,0 +1,173 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+std::size_t const MAX_KEYS = 3 * SIMD_SEARCH_WINDOW + 5;
+
+
+// Sorted keys in the tree order of `gt`, with runs of duplicates
+template<typename FieldType, typename Compare>
+auto generate_sorted_keys(std::size_t size, std::mt19937 &twister) -> std::vector<FieldType> {
+    std::uniform_int_distribution<int> distribution(-static_cast<int>(size), static_cast<int>(size));
+    std::vector<FieldType> keys(size);
+    for (FieldType &key: keys) {
+        key = static_cast<FieldType>(distribution(twister));
+    }
+
+    Compare gt;
+    std::sort(keys.begin(), keys.end(), [&gt](const FieldType &a, const FieldType &b) { return gt(b, a); });
+    return keys;
+}
+
+
+// Checks both bounds of the strategy against the standard algorithms for every size and every needle,
+// including needles before the first key and after the last one
+template<typename FieldType, typename Compare>
+void bounds_test(std::mt19937 &twister) {
+    Compare gt;
+    auto const precedes = [&gt](const FieldType &element, const FieldType &key) { return gt(key, element); };
+    auto const follows = [&gt](const FieldType &key, const FieldType &element) { return gt(element, key); };
+
+    for (std::size_t size = 0; size <= MAX_KEYS; ++size) {
+        std::vector<FieldType> const keys = generate_sorted_keys<FieldType, Compare>(size, twister);
+        for (int needle = -static_cast<int>(size) - 1; needle <= static_cast<int>(size) + 1; ++needle) {
+            auto const key = static_cast<FieldType>(needle);
+            auto const expected_lower = static_cast<std::size_t>(
+                    std::lower_bound(keys.begin(), keys.end(), key, precedes) - keys.begin());
+            auto const expected_upper = static_cast<std::size_t>(
+                    std::upper_bound(keys.begin(), keys.end(), key, follows) - keys.begin());
+
+            assert((KeySearch<FieldType, Compare>::lower_bound(keys.data(), size, key, gt)) == expected_lower);
+            assert((KeySearch<FieldType, Compare>::upper_bound(keys.data(), size, key, gt)) == expected_upper);
+            assert(branchless_lower_bound(keys.data(), size, key, gt, std::identity()) == expected_lower);
+            assert(branchless_upper_bound(keys.data(), size, key, gt, std::identity()) == expected_upper);
+        }
+    }
+}
+
+
+// The record bounds go through the search field, which always takes the scalar path
+void projection_test(std::mt19937 &twister) {
+    std::greater<std::int32_t> gt;
+    auto const get_indexed_field = [](const Record &record) { return record.id; };
+
+    for (std::size_t size = 0; size <= MAX_KEYS; ++size) {
+        std::vector<std::int32_t> const keys = generate_sorted_keys<std::int32_t, std::greater<>>(size, twister);
+        std::vector<Record> records;
+        for (std::int32_t const key: keys) {
+            records.emplace_back(key, "p", key % 97);
+        }
+
+        for (std::int32_t key = -static_cast<std::int32_t>(size) - 1; key <= static_cast<std::int32_t>(size) + 1; ++key) {
+            auto const expected_lower = static_cast<std::size_t>(
+                    std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+            auto const expected_upper = static_cast<std::size_t>(
+                    std::upper_bound(keys.begin(), keys.end(), key) - keys.begin());
+            assert((KeySearch<std::int32_t, std::greater<std::int32_t>>::lower_bound(
+                    records.data(), size, key, gt, get_indexed_field)) == expected_lower);
+            assert((KeySearch<std::int32_t, std::greater<std::int32_t>>::upper_bound(
+                    records.data(), size, key, gt, get_indexed_field)) == expected_upper);
+        }
+    }
+}
+
+
+#if defined(B_PLUS_TREE_SIMD_SEARCH)
+// The vector counts must agree with a plain loop, also on the tail that does not fill a register
+template<typename FieldType, typename Compare>
+void count_preceding_test(std::mt19937 &twister) {
+    Compare gt;
+    for (std::size_t size = 0; size <= SIMD_SEARCH_WINDOW; ++size) {
+        std::vector<FieldType> const keys = generate_sorted_keys<FieldType, Compare>(size, twister);
+        for (int needle = -static_cast<int>(size) - 1; needle <= static_cast<int>(size) + 1; ++needle) {
+            auto const key = static_cast<FieldType>(needle);
+            auto const expected = static_cast<std::size_t>(
+                    std::count_if(keys.begin(), keys.end(), [&](const FieldType &k) { return gt(key, k); }));
+            assert((KeySearch<FieldType, Compare>::count_preceding(keys.data(), size, key)) == expected);
+        }
+    }
+}
+#endif
+
+
+// Trees search through the strategy in both orders, and duplicates may straddle a split
+template<typename Compare>
+void tree_test(const int number_of_records, const int test, const std::string &order) {
+    std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+        return record.id;
+    };
+
+    std::string const file_name = "key_search_by_id_" + order + "_" + std::to_string(test);
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    Property const property(
+            "./index/record/",
+            "metadata_" + file_name,
+            file_name,
+            get_expected_index_page_capacity<std::int32_t>(),
+            get_expected_data_page_capacity<Record>(),
+            false
+    );
+    BPlusTree<std::int32_t, Record, Compare> tree(property, get_indexed_field);
+
+    // every key is inserted three times, so runs of equal keys cross page boundaries
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.insert(keys.end(), 3, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(test));
+    for (std::int32_t const key: keys) {
+        Record record(key, "p", key % 97);
+        tree.insert(record);
+    }
+
+    assert(tree.search(0).empty());
+    assert(tree.search(number_of_records + 1).empty());
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(recovered.size() == 3);
+        for (const Record &record: recovered) {
+            assert(record.id == key);
+        }
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        bounds_test<std::int32_t, std::greater<std::int32_t>>(twister);
+        bounds_test<std::int32_t, std::less<std::int32_t>>(twister);
+        bounds_test<std::int64_t, std::greater<std::int64_t>>(twister);
+        bounds_test<std::int64_t, std::less<std::int64_t>>(twister);
+        bounds_test<float, std::greater<float>>(twister);
+        bounds_test<double, std::less<double>>(twister);
+        bounds_test<std::int16_t, std::greater<std::int16_t>>(twister);
+        projection_test(twister);
+#if defined(B_PLUS_TREE_SIMD_SEARCH)
+        count_preceding_test<std::int32_t, std::greater<std::int32_t>>(twister);
+        count_preceding_test<std::int64_t, std::less<std::int64_t>>(twister);
+        count_preceding_test<float, std::less<float>>(twister);
+        count_preceding_test<double, std::greater<double>>(twister);
+#endif
+
+        tree_test<std::greater<std::int32_t>>(NUMBER_OF_RECORDS, TEST, "ascending");
+        tree_test<std::less<std::int32_t>>(NUMBER_OF_RECORDS, TEST, "descending");
+        std::cout << "Key search test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "leaf_codec.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const INDEX_PAGE_CAPACITY = 16;
+std::int32_t const DATA_PAGE_CAPACITY = 256;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+// Encodes `record` against `previous` and decodes it back, the three sizes agree and are bounded by the record
+void check_round_trip(const std::vector<char> &record, const std::vector<char> *previous) {
+    std::size_t const size = record.size();
+    const char *previous_bytes = previous ? previous->data() : nullptr;
+    std::vector<char> encoded(size + DELTA_OVERHEAD + 1, '\x5a');
+
+    std::int32_t const expected = delta_size(record.data(), previous_bytes, size);
+    assert(expected <= static_cast<std::int32_t>(size) + DELTA_OVERHEAD);
+    assert(encode_delta(record.data(), previous_bytes, size, encoded.data()) == expected);
+    // nothing is written past the encoding
+    assert(encoded[expected] == '\x5a');
+
+    std::vector<char> decoded(size);
+    assert(decode_delta(encoded.data(), previous_bytes, size, decoded.data()) == expected);
+    assert(decoded == record);
+}
+
+
+// Records equal to their neighbour, differing in a single byte, in long runs of bytes or in every byte, of sizes
+// from a single byte to longer than the run lengths a control byte holds
+void codec_test(std::mt19937 &twister) {
+    for (std::size_t const size: { 1, 2, 15, 16, 17, 40, 300 }) {
+        std::vector<char> zeros(size, 0);
+        std::vector<char> random_bytes(size);
+        for (char &byte: random_bytes) {
+            byte = static_cast<char>(twister());
+        }
+
+        check_round_trip(zeros, nullptr);
+        check_round_trip(random_bytes, nullptr);
+        check_round_trip(random_bytes, &random_bytes);
+        check_round_trip(random_bytes, &zeros);
+        check_round_trip(zeros, &random_bytes);
+
+        // equal records shrink to a tag and a control byte, with the length of the run of zeros
+        assert(delta_size(random_bytes.data(), random_bytes.data(), size) <= 4);
+
+        for (int round = 0; round < 200; ++round) {
+            std::vector<char> changed = random_bytes;
+            std::size_t const first = twister() % size;
+            std::size_t const last = std::min(size, first + 1 + twister() % (size - first));
+            for (std::size_t i = first; i < last; i += 1 + twister() % 3) {
+                changed[i] = static_cast<char>(twister());
+            }
+            check_round_trip(changed, &random_bytes);
+        }
+    }
+}
+
+
+auto make_property(const std::string &file_name, bool unique, bool compressed) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, unique, DEFAULT_BUFFER_POOL_CAPACITY, streamStorage, false, false,
+                            compressed);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+void check_contents(RecordTree &tree, const std::multiset<std::int32_t> &model, const int max_key) {
+    std::vector<Record> const ascending = tree.above(-1);
+    assert(ascending.size() == model.size());
+    assert(std::equal(ascending.begin(), ascending.end(), model.begin(), [](const Record &record, std::int32_t key) {
+        return record.id == key;
+    }));
+    for (std::int32_t key = -1; key <= max_key + 1; ++key) {
+        std::vector<Record> const located = tree.search(key);
+        assert(located.size() == model.count(key));
+        for (const Record &record: located) {
+            assert(record.age == key % 97 && std::string(record.name) == "c" + std::to_string(key % 1000));
+        }
+    }
+}
+
+
+// Compressed leaves split, borrow and merge by bytes, and a remove that makes its neighbour grow may split a page
+void compressed_tree_test(const int number_of_records, const bool unique, std::mt19937 &twister) {
+    std::string const name = std::string("leaf_codec_by_id_") + (unique ? "unique" : "duplicates");
+    Property const property = make_property(name, unique, true);
+    std::multiset<std::int32_t> model;
+
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 0; key < number_of_records; ++key) {
+        keys.insert(keys.end(), unique ? 1 : 2, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    {
+        RecordTree tree(property, get_indexed_field);
+        check_contents(tree, model, number_of_records);
+        for (std::int32_t const key: keys) {
+            Record record(key, "c" + std::to_string(key % 1000), key % 97);
+            tree.insert(record);
+            model.insert(key);
+        }
+        check_contents(tree, model, number_of_records);
+
+        // every other key leaves gaps the neighbouring records are encoded across
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] % 2 == 0) {
+                tree.remove(keys[i]);
+                model.erase(model.find(keys[i]));
+            }
+        }
+        check_contents(tree, model, number_of_records);
+    }
+
+    // the option is stored with the metadata, the pages are decoded when read back
+    RecordTree tree(Property("./index/record/", "metadata_" + name, name, INDEX_PAGE_CAPACITY, DATA_PAGE_CAPACITY,
+                             unique), get_indexed_field);
+    check_contents(tree, model, number_of_records);
+    tree.compact();
+    check_contents(tree, model, number_of_records);
+}
+
+
+// Bulk loads of dense keys take less space than with plain leaves
+void bulk_load_test(const int number_of_records) {
+    std::vector<Record> records;
+    for (std::int32_t key = 0; key < number_of_records; ++key) {
+        records.emplace_back(key, "c" + std::to_string(key % 1000), key % 97);
+    }
+
+    std::multiset<std::int32_t> model;
+    for (const Record &record: records) {
+        model.insert(record.id);
+    }
+
+    std::uintmax_t sizes[2];
+    for (bool const compressed: { false, true }) {
+        Property const property = make_property(std::string("leaf_codec_by_id_loaded_") +
+                                                (compressed ? "compressed" : "plain"), true, compressed);
+        RecordTree tree(property, get_indexed_field);
+        tree.bulk_load(records.begin(), records.end());
+        tree.flush();
+        check_contents(tree, model, number_of_records);
+        sizes[compressed] = std::filesystem::file_size(property.INDEX_FULL_PATH);
+    }
+    if (number_of_records >= 1000) {
+        assert(sizes[true] < sizes[false]);
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        codec_test(twister);
+        compressed_tree_test(NUMBER_OF_RECORDS, true, twister);
+        compressed_tree_test(NUMBER_OF_RECORDS, false, twister);
+        bulk_load_test(NUMBER_OF_RECORDS);
+        std::cout << "Leaf codec test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, std::int32_t index_capacity,
+                   std::int32_t data_capacity) -> Property {
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    return Property("./index/record/", "metadata_" + file_name, file_name, index_capacity, data_capacity, true);
+}
+
+
+// Metadata as persisted in the metadata file of the tree
+auto stored_property(const Property &property) -> Property {
+    Property stored = property;
+    std::fstream file(property.METADATA_FULL_PATH, std::ios::in);
+    stored.load(file);
+    return stored;
+}
+
+
+auto insert_shuffled(RecordTree &tree, const int number_of_records, const int test) -> void {
+    std::vector<std::int32_t> keys(number_of_records);
+    for (std::int32_t i = 0; i < number_of_records; ++i) {
+        keys[i] = i + 1;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(test));
+    for (std::int32_t const key: keys) {
+        Record record(key, "l", key % 97);
+        tree.insert(record);
+    }
+}
+
+
+auto check_contents(RecordTree &tree, const int number_of_records) -> void {
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(recovered.size() == 1 && recovered.front().age == key % 97);
+    }
+    assert(static_cast<int>(tree.above(0).size()) == number_of_records);
+}
+
+
+// Every page of a new tree takes the same number of whole blocks, whatever its type and capacity
+void padded_pages_test(const int number_of_records, const int test) {
+    auto const block_size = static_cast<std::int64_t>(get_buffer_size());
+
+    for (const auto &[index_capacity, data_capacity]: { std::pair(get_expected_index_page_capacity<std::int32_t>(),
+                                                                  get_expected_data_page_capacity<Record>()),
+                                                        std::pair(4, 4),
+                                                        std::pair(1000, 7) }) {
+        Property const property = make_property("page_layout_by_id_" + std::to_string(test), index_capacity,
+                                                data_capacity);
+        {
+            RecordTree tree(property, get_indexed_field);
+            insert_shuffled(tree, number_of_records, test);
+            for (std::int32_t key = 1; key <= number_of_records; key += 3) {
+                tree.remove(key);
+            }
+        }
+
+        std::int64_t const page_size = stored_property(property).PAGE_SIZE;
+        assert(page_size > 0 && page_size % block_size == 0);
+        if (index_capacity == get_expected_index_page_capacity<std::int32_t>()) {
+            // the default capacities fill exactly one block
+            assert(page_size == block_size);
+        }
+        assert(static_cast<std::int64_t>(std::filesystem::file_size(property.INDEX_FULL_PATH)) % page_size == 0);
+
+        RecordTree tree(property, get_indexed_field);
+        for (std::int32_t key = 1; key <= number_of_records; ++key) {
+            assert(tree.search(key).size() == (key % 3 == 1 ? 0U : 1U));
+        }
+    }
+}
+
+
+// Trees created before pages were padded keep their packed layout until they are compacted
+void packed_layout_test(const int number_of_records, const int test) {
+    Property const property = make_property("page_layout_by_id_packed_" + std::to_string(test), 4, 4);
+    {
+        RecordTree tree(property, get_indexed_field);
+    }
+
+    // keeps the metadata file up to the free list heads, as written by older versions
+    {
+        std::ifstream written(property.METADATA_FULL_PATH);
+        std::string content;
+        std::string line;
+        for (int lines = 0; lines < 10 && std::getline(written, line); ++lines) {
+            content += line + "\n";
+        }
+        written.close();
+        std::ofstream(property.METADATA_FULL_PATH, std::ios::trunc) << content;
+    }
+
+    {
+        RecordTree tree(property, get_indexed_field);
+        insert_shuffled(tree, number_of_records, test);
+        check_contents(tree, number_of_records);
+    }
+    assert(stored_property(property).PAGE_SIZE == 0);
+    std::uintmax_t const packed_size = std::filesystem::file_size(property.INDEX_FULL_PATH);
+
+    RecordTree tree(property, get_indexed_field);
+    check_contents(tree, number_of_records);
+    tree.compact();
+    tree.flush();
+
+    std::int64_t const page_size = stored_property(property).PAGE_SIZE;
+    assert(page_size > 0);
+    assert(static_cast<std::int64_t>(std::filesystem::file_size(property.INDEX_FULL_PATH)) % page_size == 0);
+    assert(std::filesystem::file_size(property.INDEX_FULL_PATH) != packed_size);
+    check_contents(tree, number_of_records);
+}
+
+
+// Frames handed out by the pool start at a block boundary
+void frame_alignment_test(const std::string &path) {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path, std::ios::trunc).close();
+    std::unique_ptr<Storage> storage = make_storage(streamStorage, path);
+    BufferPool pool(8);
+    pool.attach(storage.get());
+
+    for (std::size_t const size: { std::size_t { 1 }, std::size_t { 100 }, FRAME_ALIGNMENT, 3 * FRAME_ALIGNMENT }) {
+        std::int64_t const pos = pool.allocate(size);
+        char *frame = pool.pin(pos, size, false);
+        assert(reinterpret_cast<std::uintptr_t>(frame) % FRAME_ALIGNMENT == 0);
+        pool.unpin(pos, true);
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        padded_pages_test(NUMBER_OF_RECORDS, TEST);
+        packed_layout_test(NUMBER_OF_RECORDS, TEST);
+        frame_alignment_test("./index/record/page_layout_by_id_frames.tree");
+        std::cout << "Page layout test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, bool unique) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY,
+                            unique, 256, streamStorage, false, true);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+auto ids(const std::vector<Record> &records) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (const Record &record: records) {
+        keys.push_back(record.id);
+    }
+    return keys;
+}
+
+
+// Every lookup routed through the resident index matches the model, for each key of the tree and the ones
+// around it
+void check_lookups(RecordTree &tree, const std::multiset<std::int32_t> &model, const std::int32_t max_key) {
+    std::vector<std::int32_t> probes;
+    for (std::int32_t key = -1; key <= max_key + 1; ++key) {
+        std::vector<std::int32_t> const matches(model.lower_bound(key), model.upper_bound(key));
+        assert(ids(tree.search(key)) == matches);
+        probes.push_back(key);
+    }
+
+    std::vector<std::vector<Record>> const located = tree.search_many(probes);
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+        assert(located[i].size() == model.count(probes[i]));
+    }
+
+    for (std::int32_t bound = -1; bound <= max_key + 1; bound += 7) {
+        assert(ids(tree.above(bound)) == std::vector<std::int32_t>(model.lower_bound(bound), model.end()));
+        std::vector<std::int32_t> below(model.begin(), model.upper_bound(bound));
+        std::reverse(below.begin(), below.end());
+        assert(ids(tree.below(bound)) == below);
+        assert(ids(tree.between(bound, bound + 9))
+               == std::vector<std::int32_t>(model.lower_bound(bound), model.upper_bound(bound + 9)));
+    }
+}
+
+
+void pinned_index_test(const int number_of_records, const bool unique, std::mt19937 &twister) {
+    std::string const file_name = std::string("pinned_index_by_id_") + (unique ? "unique" : "duplicates");
+    Property const property = make_property(file_name, unique);
+    std::multiset<std::int32_t> model;
+
+    // without unique keys every key is inserted three times, so runs of equal keys cross leaves and separators
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.insert(keys.end(), unique ? 1 : 3, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    {
+        RecordTree tree(property, get_indexed_field);
+        check_lookups(tree, model, number_of_records);
+
+        // the root leaf, then the first index page and every split after it
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            Record record(keys[i], "p", keys[i] % 97);
+            tree.insert(record);
+            model.insert(keys[i]);
+            if (i == SMALL_CAPACITY - 1 || i == SMALL_CAPACITY || i == keys.size() / 4) {
+                check_lookups(tree, model, number_of_records);
+            }
+        }
+        check_lookups(tree, model, number_of_records);
+
+        // merges shrink the index levels, the keys equal to a separator are removed through the index pages
+        std::shuffle(keys.begin(), keys.end(), twister);
+        for (std::size_t i = 0; i < keys.size() / 2; ++i) {
+            tree.remove(keys[i]);
+            model.erase(model.find(keys[i]));
+        }
+        check_lookups(tree, model, number_of_records);
+    }
+
+    // the copy is built again from the file, and after the pages are moved by a compaction
+    RecordTree tree(property, get_indexed_field);
+    check_lookups(tree, model, number_of_records);
+    tree.compact();
+    check_lookups(tree, model, number_of_records);
+
+    // down to a single leaf, then to an empty tree
+    for (std::size_t i = keys.size() / 2; i + 1 < keys.size(); ++i) {
+        tree.remove(keys[i]);
+        model.erase(model.find(keys[i]));
+    }
+    check_lookups(tree, model, number_of_records);
+    tree.remove(keys.back());
+    model.clear();
+    check_lookups(tree, model, number_of_records);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        pinned_index_test(NUMBER_OF_RECORDS, true, twister);
+        pinned_index_test(NUMBER_OF_RECORDS, false, twister);
+        std::cout << "Pinned index test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
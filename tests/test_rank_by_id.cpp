@@ -0,0 +1,272 @@
+#include <cassert>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+
+#include "tree_analyzer.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record, std::greater<std::int32_t>, key_of<&Record::id>>;
+
+// Small pages, so that a few thousand records split, borrow from and merge pages on several levels
+std::int32_t const INDEX_PAGE_CAPACITY = 6;
+std::int32_t const DATA_PAGE_CAPACITY = 6;
+
+
+struct TreeVariant {
+    std::string name;
+    StorageBackend backend;
+    bool unique;
+    bool durable;
+    bool pinned_index;
+    bool compressed_leaves;
+};
+
+
+auto make_property(const TreeVariant &variant, const std::string &name, bool subtree_counts) -> Property {
+    std::string const file_name = name + "_" + variant.name;
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, variant.unique, DEFAULT_BUFFER_POOL_CAPACITY, variant.backend,
+                            variant.durable, variant.pinned_index, variant.compressed_leaves, subtree_counts);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH + WAL_FILE_EXTENSION);
+    return property;
+}
+
+
+auto make_record(std::int32_t key) -> Record {
+    return Record(key, "r", key % 97);
+}
+
+
+template<typename Scan>
+auto drain(Scan &&cursor) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> keys;
+    for (Record &record: cursor) {
+        keys.push_back(record.id);
+    }
+    return keys;
+}
+
+
+// Sampled records are in key order and hold keys of the range
+void check_sample(const std::vector<Record> &sampled, const std::multiset<std::int32_t> &model,
+                  const std::int32_t lower_bound, const std::int32_t upper_bound, const std::size_t count) {
+    bool const empty_range = model.lower_bound(lower_bound) == model.upper_bound(upper_bound);
+    assert(sampled.size() == (empty_range ? 0 : count));
+    for (std::size_t i = 0; i < sampled.size(); ++i) {
+        assert(model.contains(sampled[i].id) && sampled[i].age == sampled[i].id % 97);
+        assert(lower_bound <= sampled[i].id && sampled[i].id <= upper_bound);
+        assert(i == 0 || sampled[i - 1].id <= sampled[i].id);
+    }
+}
+
+
+// Order statistics of a tree keeping subtree counts, with keys and ranks that may fall outside of it. The
+// analyzer checks every count against the pages below it.
+void check_ranks(RecordTree &tree, const std::multiset<std::int32_t> &model, const int number_of_records,
+                 std::mt19937 &twister) {
+    std::vector<std::int32_t> const ascending(model.begin(), model.end());
+    std::uniform_int_distribution<std::int32_t> random_key(-1, number_of_records + 2);
+    std::uniform_int_distribution<std::size_t> random_rank(0, ascending.size() + 2);
+    assert(tree.size() == ascending.size());
+
+    for (int i = 0; i < 50; ++i) {
+        std::int32_t const key = random_key(twister);
+        auto const rank = static_cast<std::size_t>(std::distance(model.begin(), model.lower_bound(key)));
+        assert(tree.rank(key) == rank);
+
+        std::size_t const position = random_rank(twister);
+        std::optional<Record> const selected = tree.select(position);
+        assert(selected.has_value() == (position < ascending.size()));
+        if (selected) {
+            assert(selected->id == ascending[position] && selected->age == ascending[position] % 97);
+            // select is the inverse of rank on the first record of each key
+            assert(tree.rank(selected->id) <= position);
+        }
+
+        std::size_t const limits[] = { 0, 1, 7, NO_LIMIT };
+        std::size_t const limit = limits[twister() % std::size(limits)];
+        std::size_t const first = std::min(position, ascending.size());
+        std::size_t const last = std::min(ascending.size(), first + std::min(limit, ascending.size()));
+        assert(drain(tree.scan_from(position, limit)) ==
+               std::vector<std::int32_t>(ascending.begin() + first, ascending.begin() + last));
+
+        std::int32_t lower_bound = random_key(twister);
+        std::int32_t upper_bound = random_key(twister);
+        if (upper_bound < lower_bound) {
+            std::swap(lower_bound, upper_bound);
+        }
+        std::size_t const count = twister() % 20;
+        check_sample(tree.sample_between(lower_bound, upper_bound, count, twister), model, lower_bound,
+                     upper_bound, count);
+        // an inverted range is empty
+        assert(tree.sample_between(upper_bound + 1, lower_bound, count, twister).empty());
+    }
+
+    std::size_t const count = 2 * ascending.size();
+    check_sample(tree.sample(count, twister), model, std::numeric_limits<std::int32_t>::min(),
+                 std::numeric_limits<std::int32_t>::max(), count);
+
+    TreeReport const report = TreeAnalyzer(&tree).analyze();
+    assert(report.consistent() && report.count_mismatches == 0);
+}
+
+
+// A scan from an offset released the tree between records, so writes made meanwhile are seen past its last key
+void check_offset_scan_with_writes(RecordTree &tree, std::multiset<std::int32_t> &model, const int number_of_records) {
+    if (model.size() < 8) {
+        return;
+    }
+    auto cursor = tree.scan_from(model.size() / 4);
+    std::vector<std::int32_t> scanned;
+    for (int i = 0; i < 3; ++i) {
+        scanned.push_back(cursor.record().id);
+        cursor.next();
+    }
+
+    // the record under the cursor was already read, a key after it goes and one past every key comes
+    assert(cursor.record().id == *model.upper_bound(scanned.back()));
+    std::int32_t const removed = *model.upper_bound(cursor.record().id);
+    tree.remove(removed);
+    model.erase(model.find(removed));
+    Record record = make_record(number_of_records + 1);
+    tree.insert(record);
+    model.insert(record.id);
+
+    for (; cursor.valid(); cursor.next()) {
+        scanned.push_back(cursor.record().id);
+    }
+    auto const start = std::next(model.begin(), static_cast<std::ptrdiff_t>(model.size() / 4));
+    assert(scanned == std::vector<std::int32_t>(start, model.end()));
+}
+
+
+void rank_test(const TreeVariant &variant, const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property(variant, "rank_by_id", true);
+
+    // keys of non-unique trees repeat within and across leaves
+    std::vector<std::int32_t> keys(number_of_records);
+    std::iota(keys.begin(), keys.end(), 1);
+    if (!variant.unique) {
+        for (std::int32_t &key: keys) {
+            key = 1 + static_cast<std::int32_t>(twister() % std::max(number_of_records / 4, 1));
+        }
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    std::multiset<std::int32_t> model;
+
+    {
+        RecordTree tree(property, key_of<&Record::id>{});
+        check_ranks(tree, model, number_of_records, twister);
+
+        // half of the records one by one, the other half in a batch filling the leaves in place
+        std::size_t const half = keys.size() / 2;
+        for (std::size_t i = 0; i < half; ++i) {
+            Record record = make_record(keys[i]);
+            tree.insert(record);
+            model.insert(keys[i]);
+        }
+        std::vector<Record> batch;
+        for (std::size_t i = half; i < keys.size(); ++i) {
+            batch.push_back(make_record(keys[i]));
+            model.insert(keys[i]);
+        }
+        tree.insert_many(batch.begin(), batch.end());
+        check_ranks(tree, model, number_of_records, twister);
+
+        // merges and borrows move records, and their counts, between subtrees
+        std::shuffle(keys.begin(), keys.end(), twister);
+        std::size_t const removed = 2 * keys.size() / 3;
+        for (std::size_t i = 0; i < removed / 2; ++i) {
+            tree.remove(keys[i]);
+            model.erase(model.find(keys[i]));
+        }
+        tree.remove_many(keys.begin() + static_cast<std::ptrdiff_t>(removed / 2),
+                         keys.begin() + static_cast<std::ptrdiff_t>(removed));
+        for (std::size_t i = removed / 2; i < removed; ++i) {
+            model.erase(model.find(keys[i]));
+        }
+        check_ranks(tree, model, number_of_records, twister);
+        if (variant.unique) {
+            check_offset_scan_with_writes(tree, model, number_of_records);
+        }
+    }
+
+    // counts are stored in the index pages, and rebuilt by a compaction
+    RecordTree tree(property, key_of<&Record::id>{});
+    check_ranks(tree, model, number_of_records, twister);
+    tree.compact();
+    check_ranks(tree, model, number_of_records, twister);
+
+    std::vector<Record> sorted;
+    for (std::int32_t const key: model) {
+        sorted.push_back(make_record(key));
+    }
+    RecordTree loaded(make_property(variant, "rank_by_id_loaded", true), key_of<&Record::id>{});
+    loaded.bulk_load(sorted.begin(), sorted.end());
+    check_ranks(loaded, model, number_of_records, twister);
+}
+
+
+// Trees without subtree counts reject every order statistic
+void uncounted_test(const TreeVariant &variant, std::mt19937 &twister) {
+    RecordTree tree(make_property(variant, "uncounted_by_id", false), key_of<&Record::id>{});
+    Record record = make_record(1);
+    tree.insert(record);
+
+    auto const rejected = [](auto operation) {
+        try {
+            operation();
+        } catch (const UncountedTree &) {
+            return true;
+        }
+        return false;
+    };
+    assert(rejected([&] { tree.size(); }));
+    assert(rejected([&] { tree.rank(1); }));
+    assert(rejected([&] { tree.select(0); }));
+    assert(rejected([&] { tree.scan_from(0); }));
+    assert(rejected([&] { tree.sample(1, twister); }));
+    assert(rejected([&] { tree.sample_between(0, 2, 1, twister); }));
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    TreeVariant const variants[] = {
+        { "stream",      streamStorage,     true,  false, false, false },
+        { "positional",  positionalStorage, true,  false, false, false },
+        { "mmap",        mmapStorage,       true,  false, false, false },
+        { "non_unique",  positionalStorage, false, false, false, false },
+        { "durable",     positionalStorage, true,  true,  false, false },
+        { "pinned",      positionalStorage, true,  false, true,  false },
+        { "compressed",  positionalStorage, true,  false, false, true  },
+        { "all_options", mmapStorage,       false, true,  true,  true  }
+    };
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        for (const TreeVariant &variant: variants) {
+            rank_test(variant, NUMBER_OF_RECORDS, twister);
+            uncounted_test(variant, twister);
+            std::cout << "Rank test passed for " << variant.name << " index #" << TEST << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <cassert>
+#include <iostream>
+#include <filesystem>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+// Leaves loaded at fill factor 1 hold one record less than their capacity
+std::int32_t const DATA_CAPACITY = 4;
+std::int32_t const RECORDS_PER_LEAF = DATA_CAPACITY - 1;
+std::int32_t const INDEX_CAPACITY = 64;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+// Bulk loads the keys 1..number_of_records, so that every leaf holds RECORDS_PER_LEAF records
+auto make_tree(const std::string &file_name, const int number_of_records, std::int32_t buffer_pool_capacity,
+               StorageBackend backend) -> std::unique_ptr<RecordTree> {
+    std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_CAPACITY, DATA_CAPACITY,
+                            true, buffer_pool_capacity, backend);
+    auto tree = std::make_unique<RecordTree>(property, get_indexed_field);
+
+    std::vector<Record> records;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        records.emplace_back(key, "r", key % 97);
+    }
+    tree->bulk_load(records.begin(), records.end(), 1.0);
+    return tree;
+}
+
+
+// Scans through `cursor`, checks that it visits `first`, `first + step`, ... `last`, and returns how many
+// prefetches it issued
+template<typename Scan>
+auto prefetches_of(RecordTree &tree, Scan cursor, std::int32_t first, std::int32_t last) -> std::uint64_t {
+    std::uint64_t const before = tree.buffer_pool_stats().prefetches;
+    std::int32_t const step = (first <= last) ? 1 : -1;
+    std::int32_t expected = first;
+    for (Record &record: cursor) {
+        assert(record.id == expected);
+        expected += step;
+    }
+    assert(expected == last + step);
+    return tree.buffer_pool_stats().prefetches - before;
+}
+
+
+void read_ahead_test(const int number_of_records, const int test, StorageBackend backend) {
+    std::int32_t const leaves = (number_of_records + RECORDS_PER_LEAF - 1) / RECORDS_PER_LEAF;
+    std::unique_ptr<RecordTree> tree = make_tree("read_ahead_by_id_" + std::to_string(test), number_of_records,
+                                                 2, backend);
+
+    // a scan that only steps into the second leaf never reads ahead
+    assert(prefetches_of(*tree, tree->scan(forwardScan, RECORDS_PER_LEAF), 1, RECORDS_PER_LEAF) == 0);
+    assert(prefetches_of(*tree, tree->scan_between(1, RECORDS_PER_LEAF + 1), 1, RECORDS_PER_LEAF + 1) == 0);
+
+    // long scans request each of the following leaves once, in both directions
+    std::uint64_t const forward = prefetches_of(*tree, tree->scan(forwardScan), 1, number_of_records);
+    std::uint64_t const backward = prefetches_of(*tree, tree->scan(backwardScan), number_of_records, 1);
+    if (leaves > READ_AHEAD_TRIGGER + 1) {
+        assert(forward > 0 && backward > 0);
+    }
+    assert(forward <= static_cast<std::uint64_t>(leaves) && backward <= static_cast<std::uint64_t>(leaves));
+
+    // siblings past the scan bounds are not requested, at most the leaf holding the bound is
+    std::int32_t const first = number_of_records / 3;
+    std::int32_t const last = std::min(first + 10 * RECORDS_PER_LEAF, number_of_records);
+    std::uint64_t const bounded = prefetches_of(*tree, tree->scan_between(first, last), first, last);
+    assert(bounded <= static_cast<std::uint64_t>((last - first) / RECORDS_PER_LEAF + 2));
+}
+
+
+// Leaves already held by the pool are not requested again
+void resident_pages_test(const int number_of_records, const int test) {
+    std::unique_ptr<RecordTree> tree = make_tree("read_ahead_by_id_resident_" + std::to_string(test),
+                                                 number_of_records, 4 * number_of_records, streamStorage);
+    prefetches_of(*tree, tree->scan(forwardScan), 1, number_of_records);
+    assert(prefetches_of(*tree, tree->scan(forwardScan), 1, number_of_records) == 0);
+    assert(prefetches_of(*tree, tree->scan(backwardScan), number_of_records, 1) == 0);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        read_ahead_test(NUMBER_OF_RECORDS, TEST, streamStorage);
+#if defined(__unix__)
+        read_ahead_test(NUMBER_OF_RECORDS, TEST, mmapStorage);
+#endif
+        resident_pages_test(NUMBER_OF_RECORDS, TEST);
+        std::cout << "Read ahead test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
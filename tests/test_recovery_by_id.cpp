@@ -0,0 +1,314 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+// Small pages, so that the logged operations also split and merge pages
+std::int32_t const INDEX_PAGE_CAPACITY = 8;
+std::int32_t const DATA_PAGE_CAPACITY = 8;
+
+
+auto generate_random_vector(const int number_of_records) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> arr(number_of_records);
+
+    // Fill the array with numbers from 1 to N
+    for (std::int32_t i = 0; i < number_of_records; ++i) {
+        arr[i] = i + 1;
+    }
+
+    // Shuffle the array to make it unordered
+    std::random_device random_device;
+    std::mt19937 twister(random_device());
+    std::shuffle(arr.begin(), arr.end(), twister);
+
+    return arr;
+}
+
+
+auto get_indexed_field(Record &record) -> std::int32_t {
+    return record.id;
+}
+
+
+struct InjectedFailure : public std::runtime_error {
+    InjectedFailure(): std::runtime_error("Failure injected in the middle of an operation") {}
+};
+
+// Keys extracted before the next extraction throws, negative when no failure is armed
+int extractions_before_failure = -1;
+
+auto get_failing_indexed_field(Record &record) -> std::int32_t {
+    if (extractions_before_failure == 0) {
+        extractions_before_failure = -1;
+        throw InjectedFailure();
+    }
+    if (extractions_before_failure > 0) {
+        --extractions_before_failure;
+    }
+    return record.id;
+}
+
+
+// A fresh durable tree, without the files left by a previous run
+auto make_property(const std::string &path, const std::string &name, std::int32_t pool_capacity = 256,
+                   bool pinned_index = false) -> Property {
+    Property const property(path, "metadata_" + name, name, INDEX_PAGE_CAPACITY, DATA_PAGE_CAPACITY, true,
+                            pool_capacity, positionalStorage, true, pinned_index);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH + WAL_FILE_EXTENSION);
+    return property;
+}
+
+
+// Runs `writer` on a durable tree in a child process, which then exits without flushing or closing the tree.
+// Every operation the writer completed before exiting has been acknowledged to it.
+template<typename Writer>
+void crash_after(const Property &property, Writer writer,
+                 std::function<std::int32_t(Record &)> const &search_field = get_indexed_field) {
+    pid_t const child = fork();
+    assert(child >= 0);
+
+    if (child == 0) {
+        auto *tree = new BPlusTree<std::int32_t, Record>(property, search_field);
+        writer(*tree);
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+
+void check_contents(BPlusTree<std::int32_t, Record> &tree, const std::vector<std::int32_t> &present,
+                    const std::vector<std::int32_t> &absent, const int number_of_records) {
+    for (std::int32_t const key: present) {
+        std::vector<Record> const recovered = tree.search(key);
+        assert(recovered.size() == 1);
+        assert(recovered[0].id == key);
+    }
+    for (std::int32_t const key: absent) {
+        assert(tree.search(key).empty());
+    }
+
+    std::vector<Record> const recovered = tree.between(1, number_of_records);
+    assert(recovered.size() == present.size());
+    assert(std::is_sorted(recovered.begin(), recovered.end(), [](const Record &a, const Record &b) {
+        return a.id < b.id;
+    }));
+}
+
+
+// Inserts every key and removes a quarter of them, then crashes
+void test_acknowledged(const Property &property, const int number_of_records) {
+    std::vector<std::int32_t> const keys = generate_random_vector(number_of_records);
+    int const n_remove = number_of_records / 4;
+
+    crash_after(property, [&](BPlusTree<std::int32_t, Record> &tree) {
+        for (std::int32_t const key: keys) {
+            Record record {key, "u", 0};
+            tree.insert(record);
+        }
+        for (int i = 0; i < n_remove; ++i) {
+            tree.remove(keys[i]);
+        }
+    });
+
+    BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+    check_contents(tree,
+                   std::vector<std::int32_t>(keys.begin() + n_remove, keys.end()),
+                   std::vector<std::int32_t>(keys.begin(), keys.begin() + n_remove),
+                   number_of_records);
+}
+
+
+// Crashes after every insert, then cuts the log in the middle of its last commit record and appends garbage to
+// it, as a crash while writing the record would. Only the last insert may be lost. The pool must hold the whole
+// tree, so that the pages of that insert never reached the index file, as they would not before its commit.
+void test_torn_tail(const Property &property, const int number_of_records) {
+    std::vector<std::int32_t> const keys = generate_random_vector(number_of_records);
+
+    crash_after(property, [&](BPlusTree<std::int32_t, Record> &tree) {
+        for (std::int32_t const key: keys) {
+            Record record {key, "u", 0};
+            tree.insert(record);
+        }
+    });
+
+    std::string const log_path = property.INDEX_FULL_PATH + WAL_FILE_EXTENSION;
+    std::uintmax_t const log_size = std::filesystem::file_size(log_path);
+    assert(log_size > 16);
+    std::filesystem::resize_file(log_path, log_size - 16);
+    {
+        std::ofstream log_file(log_path, std::ios::binary | std::ios::app);
+        std::string const garbage(100, '\x5a');
+        log_file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+
+    BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+    std::int32_t const last_key = keys.back();
+    std::vector<std::int32_t> present(keys.begin(), keys.end() - 1);
+    if (!tree.search(last_key).empty()) {
+        present.push_back(last_key);
+    }
+    check_contents(tree, present, {}, number_of_records);
+
+    // the log is usable again once replayed
+    Record record {number_of_records + 1, "u", 0};
+    tree.insert(record);
+    assert(tree.search(number_of_records + 1).size() == 1);
+}
+
+
+// Commits half of the keys, checkpoints them into the index file and commits the rest before crashing
+void test_checkpoint(const Property &property, const int number_of_records) {
+    std::vector<std::int32_t> const keys = generate_random_vector(number_of_records);
+    int const half = number_of_records / 2;
+    std::string const log_path = property.INDEX_FULL_PATH + WAL_FILE_EXTENSION;
+
+    crash_after(property, [&](BPlusTree<std::int32_t, Record> &tree) {
+        for (int i = 0; i < half; ++i) {
+            Record record {keys[i], "u", 0};
+            tree.insert(record);
+        }
+        tree.flush();
+        if (std::filesystem::file_size(log_path) != 0) {
+            _exit(EXIT_FAILURE);
+        }
+
+        for (int i = half; i < number_of_records; ++i) {
+            Record record {keys[i], "u", 0};
+            tree.insert(record);
+        }
+        for (int i = 0; i < half; i += 2) {
+            tree.remove(keys[i]);
+        }
+    });
+
+    std::vector<std::int32_t> present;
+    std::vector<std::int32_t> absent;
+    for (int i = 0; i < number_of_records; ++i) {
+        (i < half && i % 2 == 0 ? absent : present).push_back(keys[i]);
+    }
+
+    BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+    check_contents(tree, present, absent, number_of_records);
+}
+
+
+// Inserts every key and removes half of them, with a failure armed at a random point of most operations, so
+// that some of them throw while splitting or merging pages. A failed operation must leave neither its pages nor
+// the metadata behind. Returns the keys present in the end; the failures depend only on `seed`.
+auto apply_with_failures(BPlusTree<std::int32_t, Record> &tree, const std::vector<std::int32_t> &keys,
+                         const unsigned seed) -> std::set<std::int32_t> {
+    std::mt19937 twister(seed);
+    std::set<std::int32_t> model;
+    auto const fails = [&](auto operation) {
+        extractions_before_failure = static_cast<int>(twister() % 48);
+        bool failed = false;
+        try {
+            operation();
+        } catch (const InjectedFailure &) {
+            failed = true;
+        }
+        extractions_before_failure = -1;
+        return failed;
+    };
+
+    for (std::int32_t const key: keys) {
+        Record record {key, "f", 0};
+        if (!fails([&] { tree.insert(record); })) {
+            model.insert(key);
+        }
+        assert(tree.search(key).size() == model.count(key));
+    }
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+        if (model.count(keys[i]) > 0 && !fails([&] { tree.remove(keys[i]); })) {
+            model.erase(keys[i]);
+        }
+        assert(tree.search(keys[i]).size() == model.count(keys[i]));
+    }
+    return model;
+}
+
+
+// With a pinned index, the index pages put back by a failed operation also have to drop its resident copy
+void test_failed_operations(const std::string &path, const std::string &suffix, const int number_of_records,
+                            const bool pinned_index) {
+    std::vector<std::int32_t> const keys = generate_random_vector(number_of_records);
+    unsigned const seed = std::random_device()();
+    auto const check = [&](BPlusTree<std::int32_t, Record> &tree, const std::set<std::int32_t> &model) {
+        std::vector<std::int32_t> absent;
+        for (std::int32_t const key: keys) {
+            if (model.count(key) == 0) {
+                absent.push_back(key);
+            }
+        }
+        check_contents(tree, std::vector<std::int32_t>(model.begin(), model.end()), absent, number_of_records);
+    };
+
+    // in memory, then once the tree is closed and opened again
+    std::string const name = (pinned_index ? "failed_pinned" : "failed") + suffix;
+    Property const property = make_property(path, name, 256, pinned_index);
+    std::set<std::int32_t> model;
+    {
+        BPlusTree<std::int32_t, Record> tree(property, get_failing_indexed_field);
+        model = apply_with_failures(tree, keys, seed);
+        assert(!model.empty() && model.size() < keys.size());
+        check(tree, model);
+    }
+    {
+        BPlusTree<std::int32_t, Record> tree(property, get_indexed_field);
+        check(tree, model);
+    }
+
+    // the same operations, recovered from the log after a crash
+    Property const crashed_property = make_property(path, name + "_crashed", 256, pinned_index);
+    crash_after(crashed_property, [&](BPlusTree<std::int32_t, Record> &tree) {
+        apply_with_failures(tree, keys, seed);
+    }, get_failing_indexed_field);
+    BPlusTree<std::int32_t, Record> tree(crashed_property, get_indexed_field);
+    check(tree, model);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+    std::string const path = "./index/record/";
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::string const suffix = "_index_by_id_" + std::to_string(TEST);
+
+        test_acknowledged(make_property(path, "acknowledged" + suffix), NUMBER_OF_RECORDS);
+        std::cout << "Acknowledged operations recovered for index #" << TEST << std::endl;
+
+        test_torn_tail(make_property(path, "torn" + suffix, NUMBER_OF_RECORDS + 256), NUMBER_OF_RECORDS);
+        std::cout << "Torn log tail recovered for index #" << TEST << std::endl;
+
+        test_checkpoint(make_property(path, "checkpoint" + suffix), NUMBER_OF_RECORDS);
+        std::cout << "Checkpointed operations recovered for index #" << TEST << std::endl;
+
+        test_failed_operations(path, suffix, NUMBER_OF_RECORDS, false);
+        std::cout << "Failed operations rolled back for index #" << TEST << std::endl;
+
+        test_failed_operations(path, suffix, NUMBER_OF_RECORDS, true);
+        std::cout << "Failed operations rolled back for pinned index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
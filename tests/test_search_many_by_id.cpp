@@ -0,0 +1,117 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const SMALL_CAPACITY = 4;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+auto make_property(const std::string &file_name, bool unique, std::int32_t buffer_pool_capacity = 256) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, SMALL_CAPACITY, SMALL_CAPACITY,
+                            unique, buffer_pool_capacity);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+// Probes in random order, with keys missing from the tree, keys outside of it and repeated probes
+void check_search_many(RecordTree &tree, const std::multiset<std::int32_t> &model, const int number_of_records,
+                       std::mt19937 &twister) {
+    std::uniform_int_distribution<std::int32_t> random_key(-2, number_of_records + 2);
+
+    std::size_t const batch_sizes[] = { 0, 1, 2, 17, static_cast<std::size_t>(number_of_records / 2) };
+    for (std::size_t const batch_size: batch_sizes) {
+        std::vector<std::int32_t> probes;
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            probes.push_back(random_key(twister));
+            if (i > 0 && twister() % 5 == 0) {
+                probes.push_back(probes[twister() % probes.size()]);
+            }
+        }
+
+        std::vector<std::vector<Record>> const located = tree.search_many(probes);
+        assert(located.size() == probes.size());
+        for (std::size_t i = 0; i < probes.size(); ++i) {
+            assert(located[i].size() == model.count(probes[i]));
+            for (const Record &record: located[i]) {
+                assert(record.id == probes[i] && record.age == probes[i] % 97);
+            }
+        }
+    }
+
+    // the smallest and the largest keys sit at both ends of the leaf chain
+    if (!model.empty()) {
+        std::vector<std::int32_t> const ends = { *model.rbegin(), *model.begin(), *model.rbegin() + 1 };
+        std::vector<std::vector<Record>> const located = tree.search_many(ends);
+        assert(located[0].size() == model.count(*model.rbegin()));
+        assert(located[1].size() == model.count(*model.begin()));
+        assert(located[2].empty());
+    }
+}
+
+
+void search_many_test(const int number_of_records, const bool unique, std::mt19937 &twister) {
+    // a pool smaller than the batches leaves part of each level to be read on demand
+    RecordTree tree(make_property(std::string("search_many_by_id_") + (unique ? "unique" : "duplicates"), unique, 8),
+                    get_indexed_field);
+    std::multiset<std::int32_t> model;
+    check_search_many(tree, model, number_of_records, twister);
+
+    // without unique keys every key is inserted three times, so runs of equal keys cross leaves
+    std::vector<std::int32_t> keys;
+    for (std::int32_t key = 1; key <= number_of_records; ++key) {
+        keys.insert(keys.end(), unique ? 1 : 3, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), twister);
+    for (std::int32_t const key: keys) {
+        Record record(key, "m", key % 97);
+        tree.insert(record);
+        model.insert(key);
+        // the batch descends a tree of a single leaf as well
+        if (model.size() == 3) {
+            check_search_many(tree, model, number_of_records, twister);
+        }
+    }
+    check_search_many(tree, model, number_of_records, twister);
+
+    std::shuffle(keys.begin(), keys.end(), twister);
+    for (std::size_t i = 0; i < keys.size() / 2; ++i) {
+        tree.remove(keys[i]);
+        model.erase(model.find(keys[i]));
+    }
+    check_search_many(tree, model, number_of_records, twister);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        search_many_test(NUMBER_OF_RECORDS, true, twister);
+        search_many_test(NUMBER_OF_RECORDS, false, twister);
+        std::cout << "Search many test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
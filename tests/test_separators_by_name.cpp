@@ -0,0 +1,148 @@
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+
+
+// Only strings ordered byte by byte are truncated
+static_assert(is_lexicographic<std::string, std::greater<std::string>>);
+static_assert(is_lexicographic<std::string, std::less<>>);
+static_assert(!is_lexicographic<std::int32_t, std::greater<std::int32_t>>);
+
+
+std::int32_t const INDEX_PAGE_CAPACITY = 8;
+std::int32_t const DATA_PAGE_CAPACITY = 16;
+
+
+// Strings over a small alphabet holding the smallest and the largest bytes, so that keys often share prefixes,
+// are prefixes of each other or differ only in their last byte
+auto random_string(std::size_t max_size, std::mt19937 &twister) -> std::string {
+    char const alphabet[] = { '\0', 'a', 'b', '\x7f', '\x80', '\xff' };
+    std::string value(twister() % (max_size + 1), 'a');
+    for (char &byte: value) {
+        byte = alphabet[twister() % std::size(alphabet)];
+    }
+    return value;
+}
+
+
+// The separator of two adjacent keys routes both of them to their own page, and is never longer than the left key
+template<typename Compare>
+void truncation_test(std::mt19937 &twister) {
+    Compare gt;
+    for (int i = 0; i < 20000; ++i) {
+        std::string left = random_string(6, twister);
+        std::string right = random_string(6, twister);
+        if (!gt(right, left)) {
+            std::swap(left, right);
+        }
+        if (!gt(right, left)) {
+            continue;
+        }
+
+        std::string const separator = SeparatorTruncation<std::string, Compare>::between(left, right);
+        assert(!gt(left, separator) && gt(right, separator));
+        assert(separator.size() <= left.size());
+    }
+
+    // keys telling apart early are cut right after the first differing byte
+    if constexpr (std::is_same_v<Compare, std::greater<std::string>>) {
+        assert((SeparatorTruncation<std::string, Compare>::between("customer/alice", "customer/bob")) == "customer/b");
+        assert((SeparatorTruncation<std::string, Compare>::between("abc", "abcd")) == "abc");
+    } else {
+        assert((SeparatorTruncation<std::string, Compare>::between("customer/bob", "customer/alice")) == "customer/b");
+    }
+}
+
+
+auto make_property(const std::string &file_name) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, false);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+template<typename Tree, typename Compare>
+void check_contents(Tree &tree, const std::multiset<std::string, Compare> &model,
+                    const std::vector<std::string> &names) {
+    std::vector<std::string> scanned;
+    for (std::string &name: tree.scan()) {
+        scanned.push_back(name);
+    }
+    assert(std::equal(scanned.begin(), scanned.end(), model.begin(), model.end()));
+
+    for (const std::string &name: names) {
+        assert(tree.search(name).size() == model.count(name));
+    }
+}
+
+
+// Trees of keys with long shared prefixes, routed by truncated separators through front-coded index pages,
+// keep finding every key through splits, borrows, merges, a reopen and a bulk load
+template<typename Compare>
+void separators_test(const int number_of_records, const std::string &name, std::mt19937 &twister) {
+    std::string const prefixes[] = { "", "a", "customer/", "customer/europe/", std::string(120, 'p'),
+                                     std::string(120, 'p') + "q" };
+    std::vector<std::string> names;
+    for (int i = 0; i < number_of_records; ++i) {
+        names.push_back(prefixes[twister() % std::size(prefixes)] + random_string(8, twister));
+    }
+
+    // the model holds the keys in the order of the leaves: ascending for std::greater, descending for std::less
+    auto const leaf_order = [](const std::string &a, const std::string &b) { return Compare()(b, a); };
+    std::multiset<std::string, decltype(leaf_order)> model(leaf_order);
+    auto const identity = [](std::string &value) { return value; };
+    Property const property = make_property("separators_by_name_" + name);
+    {
+        BPlusTree<std::string, std::string, Compare, decltype(identity)> tree(property, identity);
+        for (std::string &value: names) {
+            tree.insert(value);
+            model.insert(value);
+        }
+        check_contents(tree, model, names);
+
+        std::shuffle(names.begin(), names.end(), twister);
+        for (int i = 0; i < number_of_records / 2; ++i) {
+            tree.remove(names[i]);
+            model.erase(model.find(names[i]));
+        }
+        check_contents(tree, model, names);
+    }
+
+    BPlusTree<std::string, std::string, Compare, decltype(identity)> tree(property, identity);
+    check_contents(tree, model, names);
+
+    std::vector<std::string> sorted(model.begin(), model.end());
+    BPlusTree<std::string, std::string, Compare, decltype(identity)> loaded(
+            make_property("separators_by_name_loaded_" + name), identity);
+    loaded.bulk_load(sorted.begin(), sorted.end());
+    check_contents(loaded, model, names);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        truncation_test<std::greater<std::string>>(twister);
+        truncation_test<std::less<std::string>>(twister);
+        separators_test<std::greater<std::string>>(NUMBER_OF_RECORDS, "ascending", twister);
+        separators_test<std::less<std::string>>(NUMBER_OF_RECORDS, "descending", twister);
+        std::cout << "Separators test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+using RecordTree = BPlusTree<std::int32_t, Record>;
+
+std::int32_t const INDEX_PAGE_CAPACITY = 8;
+std::int32_t const DATA_PAGE_CAPACITY = 16;
+
+
+std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+    return record.id;
+};
+
+
+// Nearest-rank percentile of the sorted `values`
+auto exact_percentile(const std::vector<std::uint64_t> &values, double p) -> std::uint64_t {
+    auto const rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::max<std::size_t>(rank, 1) - 1];
+}
+
+
+// Percentiles are the upper limit of the bucket holding the exact one, at most a quarter above it
+void histogram_test(std::mt19937 &twister) {
+    LatencyHistogram const empty;
+    LatencySummary const none = empty.summary();
+    assert(none.count == 0 && none.total_nanoseconds == 0 && none.p50 == 0 && none.p999 == 0 && none.max == 0);
+
+    // latencies under a few nanoseconds have a bucket of their own
+    LatencyHistogram small;
+    for (std::uint64_t nanoseconds: { 0, 1, 2, 3 }) {
+        small.record(nanoseconds);
+    }
+    LatencySummary const exact = small.summary();
+    assert(exact.count == 4 && exact.total_nanoseconds == 6 && exact.p50 == 1 && exact.max == 3);
+
+    LatencyHistogram histogram;
+    std::vector<std::uint64_t> values(1 + twister() % 5000);
+    std::uint64_t total = 0;
+    for (std::uint64_t &value: values) {
+        value = static_cast<std::uint64_t>(std::exp2(std::uniform_real_distribution<double>(0.0, 40.0)(twister)));
+        histogram.record(value);
+        total += value;
+    }
+    std::sort(values.begin(), values.end());
+
+    LatencySummary const summary = histogram.summary();
+    assert(summary.count == values.size() && summary.total_nanoseconds == total);
+    std::pair<std::uint64_t, double> const reported[] = {
+        { summary.p50, 0.50 }, { summary.p90, 0.90 }, { summary.p99, 0.99 }, { summary.p999, 0.999 },
+        { summary.max, 1.0 }
+    };
+    for (auto [latency, p]: reported) {
+        std::uint64_t const expected = exact_percentile(values, p);
+        assert(expected <= latency && latency <= expected + expected / 4);
+    }
+    assert(summary.p50 <= summary.p90 && summary.p90 <= summary.p99 && summary.p99 <= summary.p999 &&
+           summary.p999 <= summary.max);
+}
+
+
+auto make_property(const std::string &file_name) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, true);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+// Counters only grow between two snapshots
+void check_monotone(const TreeStats &before, const TreeStats &after) {
+    assert(before.data_page_loads <= after.data_page_loads && before.data_page_saves <= after.data_page_saves);
+    assert(before.index_page_loads <= after.index_page_loads && before.index_page_saves <= after.index_page_saves);
+    assert(before.splits <= after.splits && before.merges <= after.merges && before.borrows <= after.borrows);
+    assert(before.root_changes <= after.root_changes);
+    for (std::size_t i = 0; i < TREE_OPERATIONS; ++i) {
+        assert(before.latencies[i].count <= after.latencies[i].count);
+    }
+}
+
+
+// The survey sees every record in the leaves, and agrees with the quick snapshot on the height
+void check_shape(RecordTree &tree, const int records) {
+    TreeStats const quick = tree.stats();
+    TreeStats const surveyed = tree.stats(true);
+    assert(quick.height == surveyed.height);
+    assert(quick.data_pages == 0 && quick.index_pages == 0);
+
+    if (records == 0) {
+        assert(surveyed.height <= 1);
+        return;
+    }
+    double const stored = surveyed.data_page_fill * static_cast<double>(surveyed.data_pages * DATA_PAGE_CAPACITY);
+    assert(std::abs(stored - records) < 0.5);
+    assert(surveyed.data_page_fill > 0 && surveyed.data_page_fill <= 1);
+
+    // every index level fans out to at most INDEX_PAGE_CAPACITY + 1 pages
+    if (surveyed.data_pages == 1) {
+        assert(surveyed.height == 1 && surveyed.index_pages == 0);
+    } else {
+        assert(surveyed.index_pages > 0 && surveyed.index_page_fill > 0 && surveyed.index_page_fill <= 1);
+        assert(std::pow(INDEX_PAGE_CAPACITY + 1, surveyed.height - 1) >= static_cast<double>(surveyed.data_pages));
+    }
+}
+
+
+void tree_stats_test(const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property("stats_by_id");
+    std::vector<std::int32_t> keys(number_of_records);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), twister);
+
+    RecordTree tree(property, get_indexed_field);
+    TreeStats const initial = tree.stats(true);
+    assert(initial.height == 0 && initial.data_pages == 0 && initial.splits == 0);
+    for (std::size_t i = 0; i < TREE_OPERATIONS; ++i) {
+        assert(initial.latencies[i].count == 0);
+    }
+
+    for (std::int32_t const key: keys) {
+        Record record(key, "stats", key % 100);
+        tree.insert(record);
+    }
+    TreeStats const inserted = tree.stats();
+    check_monotone(initial, inserted);
+    check_shape(tree, number_of_records);
+    // the pages reach the file once written back
+    tree.flush();
+    assert(number_of_records == 0 || tree.stats().file_size > 0);
+    assert(inserted.latencies[insertOperation].count == static_cast<std::uint64_t>(number_of_records));
+    assert(inserted.data_page_saves >= static_cast<std::uint64_t>(number_of_records));
+    assert(static_cast<std::int64_t>(inserted.root_changes) >= inserted.height - 1);
+    if (number_of_records > DATA_PAGE_CAPACITY) {
+        assert(inserted.splits > 0 && inserted.height > 1);
+    }
+
+    // a lookup is timed as a search only, a range search once however many records it returns
+    for (std::int32_t const key: keys) {
+        assert(tree.search(key).size() == 1);
+    }
+    assert(tree.above(-1).size() == keys.size());
+    TreeStats const searched = tree.stats();
+    check_monotone(inserted, searched);
+    assert(searched.latencies[searchOperation].count == static_cast<std::uint64_t>(number_of_records));
+    assert(searched.latencies[betweenOperation].count == 0 && searched.latencies[aboveOperation].count == 1);
+    assert(searched.splits == inserted.splits && searched.data_page_saves == inserted.data_page_saves);
+    if (number_of_records > 0) {
+        assert(searched.data_page_loads > inserted.data_page_loads);
+    }
+
+    // removing every record merges the leaves back into the root
+    for (int i = 0; i < number_of_records; ++i) {
+        tree.remove(keys[i]);
+        if (i == number_of_records / 2) {
+            check_shape(tree, number_of_records - i - 1);
+        }
+    }
+    TreeStats const removed = tree.stats();
+    check_monotone(searched, removed);
+    check_shape(tree, 0);
+    assert(removed.latencies[removeOperation].count == static_cast<std::uint64_t>(number_of_records));
+    if (number_of_records > 2 * DATA_PAGE_CAPACITY) {
+        assert(removed.merges > 0 && removed.root_changes > searched.root_changes);
+    }
+
+    std::ostringstream report;
+    report << removed;
+    // operations never run are left out of the report
+    assert((report.str().find("insert") != std::string::npos) == (number_of_records > 0));
+    assert(report.str().find("between") == std::string::npos);
+}
+
+
+// Periodic reports run next to the tree and stop with it
+void dump_stats_test() {
+    std::ostringstream stopped;
+    std::ostringstream destroyed;
+    {
+        RecordTree tree(make_property("stats_by_id_dump"), get_indexed_field);
+        tree.dump_stats(std::chrono::milliseconds(1), stopped);
+        for (std::int32_t key = 0; key < 200; ++key) {
+            Record record(key, "dump", key % 100);
+            tree.insert(record);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        tree.stop_stats_dump();
+        assert(stopped.str().find("height") != std::string::npos);
+
+        tree.dump_stats(std::chrono::milliseconds(1), destroyed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    assert(destroyed.str().find("height") != std::string::npos);
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        histogram_test(twister);
+        tree_stats_test(NUMBER_OF_RECORDS, twister);
+        dump_stats_test();
+        std::cout << "Stats test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "bplustree.hpp"
+#include "record.hpp"
+
+
+std::int64_t const PAGE_BYTES = 64;
+
+
+auto generate_random_vector(const int number_of_records) -> std::vector<std::int32_t> {
+    std::vector<std::int32_t> arr(number_of_records);
+    for (std::int32_t i = 0; i < number_of_records; ++i) {
+        arr[i] = i + 1;
+    }
+
+    std::random_device random_device;
+    std::mt19937 twister(random_device());
+    std::shuffle(arr.begin(), arr.end(), twister);
+    return arr;
+}
+
+
+auto backends() -> std::vector<StorageBackend> {
+    std::vector<StorageBackend> available = { streamStorage };
+#if defined(__unix__)
+    available.push_back(mmapStorage);
+#endif
+#if defined(B_PLUS_TREE_IO_URING)
+    available.push_back(uringStorage);
+#endif
+    return available;
+}
+
+
+auto create_empty_file(const std::string &path) -> void {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream(path, std::ios::trunc).close();
+}
+
+
+void read_write_test(const std::string &path, StorageBackend backend) {
+    create_empty_file(path);
+    std::unique_ptr<Storage> storage = make_storage(backend, path);
+
+    // an empty file holds nothing to read
+    char buffer[2 * PAGE_BYTES];
+    assert(storage->size() == 0);
+    assert(storage->read(0, buffer, PAGE_BYTES) == 0);
+
+    // writing past the end leaves a hole of zeroes behind
+    char page[PAGE_BYTES];
+    std::memset(page, 'a', PAGE_BYTES);
+    storage->write(0, page, PAGE_BYTES);
+    std::memset(page, 'd', PAGE_BYTES);
+    storage->write(3 * PAGE_BYTES, page, PAGE_BYTES);
+    assert(storage->size() == 4 * PAGE_BYTES);
+
+    assert(storage->read(0, buffer, PAGE_BYTES) == PAGE_BYTES);
+    assert(buffer[0] == 'a' && buffer[PAGE_BYTES - 1] == 'a');
+    assert(storage->read(2 * PAGE_BYTES, buffer, PAGE_BYTES) == PAGE_BYTES);
+    assert(std::all_of(buffer, buffer + PAGE_BYTES, [](char byte) { return byte == 0; }));
+
+    // a read crossing the end of the file stops there
+    assert(storage->read(3 * PAGE_BYTES, buffer, 2 * PAGE_BYTES) == PAGE_BYTES);
+    assert(buffer[0] == 'd');
+    assert(storage->read(5 * PAGE_BYTES, buffer, PAGE_BYTES) == 0);
+
+    // overwriting keeps the size
+    std::memset(page, 'b', PAGE_BYTES);
+    storage->write(PAGE_BYTES, page, PAGE_BYTES);
+    assert(storage->size() == 4 * PAGE_BYTES);
+
+    // the bytes and the size survive reopening the file, whatever backend reads it afterwards
+    storage.reset();
+    assert(static_cast<std::int64_t>(std::filesystem::file_size(path)) == 4 * PAGE_BYTES);
+    for (StorageBackend const reader: backends()) {
+        std::unique_ptr<Storage> reopened = make_storage(reader, path);
+        assert(reopened->size() == 4 * PAGE_BYTES);
+        assert(reopened->read(PAGE_BYTES, buffer, PAGE_BYTES) == PAGE_BYTES && buffer[0] == 'b');
+        assert(reopened->read(3 * PAGE_BYTES, buffer, PAGE_BYTES) == PAGE_BYTES && buffer[0] == 'd');
+    }
+}
+
+
+void view_test(const std::string &path, StorageBackend backend) {
+    create_empty_file(path);
+    std::unique_ptr<Storage> storage = make_storage(backend, path);
+
+    char *view = storage->view(0, PAGE_BYTES, true);
+    if (backend != mmapStorage) {
+        // streams and rings cannot hand out their bytes, callers fall back to read and write
+        assert(view == nullptr);
+        assert(storage->view(0, PAGE_BYTES, false) == nullptr);
+        return;
+    }
+
+    // a writable view extends the file and writes through it are visible to reads
+    assert(view != nullptr);
+    assert(storage->size() == PAGE_BYTES);
+    std::memset(view, 'v', PAGE_BYTES);
+    char buffer[PAGE_BYTES];
+    assert(storage->read(0, buffer, PAGE_BYTES) == PAGE_BYTES && buffer[PAGE_BYTES - 1] == 'v');
+
+    // a view beyond one growth chunk remaps the file
+    char *far_view = storage->view(MMAP_GROWTH_CHUNK, PAGE_BYTES, true);
+    assert(far_view != nullptr);
+    far_view[0] = 'w';
+    assert(storage->size() == MMAP_GROWTH_CHUNK + PAGE_BYTES);
+    assert(storage->view(0, PAGE_BYTES, false)[0] == 'v');
+
+    // a read-only view never extends the file
+    assert(storage->view(4 * MMAP_GROWTH_CHUNK, PAGE_BYTES, false) == nullptr);
+    assert(storage->size() == MMAP_GROWTH_CHUNK + PAGE_BYTES);
+
+    storage.reset();
+    assert(static_cast<std::int64_t>(std::filesystem::file_size(path)) == MMAP_GROWTH_CHUNK + PAGE_BYTES);
+}
+
+
+// Batches larger than a submission queue, with transfers out of order and past the end of the file
+void batch_test(const std::string &path, StorageBackend backend) {
+    create_empty_file(path);
+    std::unique_ptr<Storage> storage = make_storage(backend, path);
+
+    std::int64_t const pages = 3 * 64 + 5;
+    std::vector<char> written(pages * PAGE_BYTES);
+    std::vector<IORequest> requests;
+    for (std::int64_t page = pages - 1; page >= 0; page -= 2) {
+        std::memset(written.data() + page * PAGE_BYTES, static_cast<char>('a' + page % 26), PAGE_BYTES);
+        requests.push_back({ page * PAGE_BYTES, written.data() + page * PAGE_BYTES, PAGE_BYTES });
+    }
+    storage->write_batch(requests);
+    assert(storage->size() == pages * PAGE_BYTES);
+
+    // every page is read back in one batch, the ones never written and the ones past the end are zeroed
+    std::vector<char> read(2 * pages * PAGE_BYTES, 'x');
+    requests.clear();
+    for (std::int64_t page = 0; page < 2 * pages; ++page) {
+        requests.push_back({ page * PAGE_BYTES, read.data() + page * PAGE_BYTES, PAGE_BYTES });
+    }
+    storage->read_batch(requests);
+    for (std::int64_t page = 0; page < 2 * pages; ++page) {
+        char const expected = (page < pages && page % 2 == (pages - 1) % 2) ? static_cast<char>('a' + page % 26) : 0;
+        assert(std::all_of(read.begin() + page * PAGE_BYTES, read.begin() + (page + 1) * PAGE_BYTES,
+                           [expected](char byte) { return byte == expected; }));
+    }
+
+    // an empty batch is a no-op
+    storage->read_batch({});
+    storage->write_batch({});
+    assert(storage->size() == pages * PAGE_BYTES);
+}
+
+
+auto make_property(const std::string &file_name, StorageBackend backend) -> Property {
+    return Property(
+            "./index/record/",
+            "metadata_" + file_name,
+            file_name,
+            get_expected_index_page_capacity<std::int32_t>(),
+            get_expected_data_page_capacity<Record>(),
+            true,
+            DEFAULT_BUFFER_POOL_CAPACITY,
+            backend
+    );
+}
+
+
+void tree_test(const int number_of_records, const int test) {
+    std::function<std::int32_t(Record &)> const get_indexed_field = [](Record &record) {
+        return record.id;
+    };
+
+    for (StorageBackend const backend: backends()) {
+        std::string const file_name = "storage_by_id_" + std::to_string(backend) + "_" + std::to_string(test);
+        std::filesystem::remove("./index/record/metadata_" + file_name + ".meta");
+
+        {
+            BPlusTree<std::int32_t, Record> tree(make_property(file_name, backend), get_indexed_field);
+            for (std::int32_t const key: generate_random_vector(number_of_records)) {
+                Record record(key, "p", key % 97);
+                tree.insert(record);
+            }
+            for (std::int32_t key = 2; key <= number_of_records; key += 2) {
+                tree.remove(key);
+            }
+        }
+
+        // the pages are laid out the same way by every backend, so any of them reopens the tree
+        for (StorageBackend const reader: backends()) {
+            BPlusTree<std::int32_t, Record> tree(make_property(file_name, reader), get_indexed_field);
+            for (std::int32_t key = 1; key <= number_of_records; ++key) {
+                std::vector<Record> const recovered = tree.search(key);
+                if (key % 2 == 0) {
+                    assert(recovered.empty());
+                } else {
+                    assert(recovered.size() == 1 && recovered.front().age == key % 97);
+                }
+            }
+            std::vector<Record> const all = tree.between(1, number_of_records);
+            assert(static_cast<int>(all.size()) == (number_of_records + 1) / 2);
+        }
+    }
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+    std::string const path = "./index/record/storage_by_id.tree";
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        for (StorageBackend const backend: backends()) {
+            read_write_test(path, backend);
+            view_test(path, backend);
+            batch_test(path, backend);
+        }
+        tree_test(NUMBER_OF_RECORDS, TEST);
+        std::cout << "Storage test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
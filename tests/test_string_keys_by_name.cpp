@@ -0,0 +1,204 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <set>
+
+#include "bplustree.hpp"
+
+
+// Record of variable size keyed by a string, its pages are slotted
+struct Customer {
+    std::string name;
+    std::int32_t orders;
+    std::string address;
+};
+
+
+template<>
+struct Serializer<Customer> {
+    static constexpr bool fixed_size = false;
+
+    static auto size(const Customer &customer) -> std::size_t {
+        return 2 * sizeof(std::uint32_t) + sizeof(customer.orders) + customer.name.size() + customer.address.size();
+    }
+
+    static auto write(char *buffer, const Customer &customer) -> void {
+        auto const name_size = static_cast<std::uint32_t>(customer.name.size());
+        auto const address_size = static_cast<std::uint32_t>(customer.address.size());
+        std::memcpy(buffer, &name_size, sizeof(name_size));
+        std::memcpy(buffer + 4, &address_size, sizeof(address_size));
+        std::memcpy(buffer + 8, &customer.orders, sizeof(customer.orders));
+        std::memcpy(buffer + 12, customer.name.data(), name_size);
+        std::memcpy(buffer + 12 + name_size, customer.address.data(), address_size);
+    }
+
+    static auto read(const char *buffer, std::size_t, Customer &customer) -> void {
+        std::uint32_t name_size = 0;
+        std::uint32_t address_size = 0;
+        std::memcpy(&name_size, buffer, sizeof(name_size));
+        std::memcpy(&address_size, buffer + 4, sizeof(address_size));
+        std::memcpy(&customer.orders, buffer + 8, sizeof(customer.orders));
+        customer.name.assign(buffer + 12, name_size);
+        customer.address.assign(buffer + 12 + name_size, address_size);
+    }
+};
+
+
+using CustomerTree = BPlusTree<std::string, Customer, std::greater<std::string>, key_of<&Customer::name>>;
+
+// Leaves hold up to DATA_PAGE_CAPACITY records, so that they mostly split when their block is full. Index pages
+// split on their number of keys, for the tree to have several levels.
+std::int32_t const INDEX_PAGE_CAPACITY = 8;
+std::int32_t const DATA_PAGE_CAPACITY = 64;
+
+
+auto make_property(const std::string &file_name) -> Property {
+    Property const property("./index/record/", "metadata_" + file_name, file_name, INDEX_PAGE_CAPACITY,
+                            DATA_PAGE_CAPACITY, false);
+    std::filesystem::remove(property.METADATA_FULL_PATH);
+    std::filesystem::remove(property.INDEX_FULL_PATH);
+    return property;
+}
+
+
+auto make_customer(const std::string &name) -> Customer {
+    return Customer { name, static_cast<std::int32_t>(name.size()), std::string(name.size() % 80, 'a') };
+}
+
+
+// Names sharing long prefixes, of lengths from none to over a hundred bytes. Every third name is repeated.
+auto generate_names(int count, std::mt19937 &twister) -> std::vector<std::string> {
+    std::string const prefixes[] = { "", "c/", "customer/", "customer/europe/", "customer/europe/spain/",
+                                     std::string(80, 'p') + "/" };
+    std::vector<std::string> names = { "" };
+    for (int key = 1; key < count; ++key) {
+        std::string name = prefixes[key % std::size(prefixes)] + std::to_string(key);
+        if (key % 7 == 0) {
+            name += std::string(twister() % 40, 'x');
+        }
+        names.push_back(name);
+        if (key % 3 == 0) {
+            names.push_back(name);
+        }
+    }
+    std::shuffle(names.begin(), names.end(), twister);
+    return names;
+}
+
+
+// The records of every name, in the order of the leaves and through searches, match the model
+void check_contents(CustomerTree &tree, const std::multiset<std::string> &model,
+                    const std::vector<std::string> &names) {
+    std::vector<Customer> const ascending = tree.above("");
+    assert(ascending.size() == model.size());
+    assert(std::equal(ascending.begin(), ascending.end(), model.begin(), [](const Customer &customer,
+                                                                            const std::string &name) {
+        return customer.name == name;
+    }));
+
+    for (const std::string &name: names) {
+        std::vector<Customer> const located = tree.search(name);
+        assert(located.size() == model.count(name));
+        for (const Customer &customer: located) {
+            assert(customer.name == name);
+            assert(customer.orders == static_cast<std::int32_t>(name.size()));
+            assert(customer.address == std::string(name.size() % 80, 'a'));
+        }
+    }
+}
+
+
+template<typename Operation>
+auto throws_entry_too_large(Operation operation) -> bool {
+    try {
+        operation();
+    } catch (const EntryTooLarge &) {
+        return true;
+    }
+    return false;
+}
+
+
+void string_keys_test(const int number_of_records, std::mt19937 &twister) {
+    Property const property = make_property("string_keys_by_name");
+    std::vector<std::string> names = generate_names(number_of_records, twister);
+    std::multiset<std::string> model;
+
+    // keys and records too large for a page are refused before the tree changes, an empty tree included
+    Customer oversized_key = make_customer(std::string(4096, 'k'));
+    Customer oversized_record = make_customer("large");
+    oversized_record.address = std::string(4096, 'a');
+    {
+        CustomerTree tree(property, key_of<&Customer::name>{});
+        assert(throws_entry_too_large([&] { tree.insert(oversized_key); }));
+        assert(throws_entry_too_large([&] { tree.insert(oversized_record); }));
+        check_contents(tree, model, names);
+
+        for (const std::string &name: names) {
+            Customer customer = make_customer(name);
+            tree.insert(customer);
+            model.insert(name);
+        }
+        check_contents(tree, model, names);
+        assert(throws_entry_too_large([&] { tree.insert(oversized_key); }));
+
+        // a batch holding a single oversized record inserts none of them
+        std::vector<Customer> batch = { make_customer("batch/1"), oversized_record, make_customer("batch/2") };
+        assert(throws_entry_too_large([&] { tree.insert_many(batch.begin(), batch.end()); }));
+        check_contents(tree, model, names);
+
+        // separators change as leaves are merged, the remaining ones may grow
+        std::shuffle(names.begin(), names.end(), twister);
+        for (int i = 0; i < 2 * number_of_records / 3; ++i) {
+            tree.remove(names[i]);
+            model.erase(model.find(names[i]));
+        }
+        check_contents(tree, model, names);
+    }
+
+    // the slotted pages are read back from the file
+    CustomerTree tree(property, key_of<&Customer::name>{});
+    check_contents(tree, model, names);
+
+    std::vector<std::string> const rest(model.begin(), model.end());
+    tree.remove_many(rest.begin(), rest.end());
+    model.clear();
+    check_contents(tree, model, names);
+
+    // bulk loads fill the slotted leaves up to a byte target, and refuse oversized records as well
+    std::sort(names.begin(), names.end());
+    std::vector<Customer> customers;
+    for (const std::string &name: names) {
+        customers.push_back(make_customer(name));
+    }
+    Property const loaded_property = make_property("string_keys_by_name_loaded");
+    CustomerTree loaded(loaded_property, key_of<&Customer::name>{});
+    loaded.bulk_load(customers.begin(), customers.end());
+    check_contents(loaded, std::multiset<std::string>(names.begin(), names.end()), names);
+
+    CustomerTree refused(make_property("string_keys_by_name_refused"), key_of<&Customer::name>{});
+    std::vector<Customer> const with_oversized = { make_customer("a"), oversized_record };
+    assert(throws_entry_too_large([&] { refused.bulk_load(with_oversized.begin(), with_oversized.end()); }));
+}
+
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+
+    int const NUMBER_OF_TESTS = atoi(argv[1]);
+    int const NUMBER_OF_RECORDS = atoi(argv[2]);
+
+    for (int TEST = 1; TEST <= NUMBER_OF_TESTS; ++TEST) {
+        std::mt19937 twister(TEST);
+
+        string_keys_test(NUMBER_OF_RECORDS, twister);
+        std::cout << "String keys test passed for index #" << TEST << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <filesystem>
+
+#include "tree_analyzer.hpp"
+#include "record.hpp"
+
+
+// Verifies a tree of records searched by their id and reports its shape, the layout of its leaves in the file
+// and whether it should be compacted. Trees of other types are analyzed by instantiating TreeAnalyzer for them.
+//
+//  usage: analyze_tree <directory> [metadata file name] [index file name]
+auto main(int argc, char* argv[]) -> int {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <directory> [metadata file name] [index file name]\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string directory_path = argv[1];
+    if (directory_path.back() != '/') {
+        directory_path += '/';
+    }
+    const std::string metadata_file_name = (argc > 2) ? argv[2] : "metadata";
+    const std::string index_file_name = (argc > 3) ? argv[3] : "btree";
+
+    // opening a tree without metadata would create an empty one
+    const Property props(
+            directory_path,
+            metadata_file_name,
+            index_file_name,
+            get_expected_index_page_capacity<std::int32_t>(),
+            get_expected_data_page_capacity<Record>(),
+            true,
+            DEFAULT_BUFFER_POOL_CAPACITY,
+            positionalStorage
+    );
+    if (!std::filesystem::exists(props.METADATA_FULL_PATH) || !std::filesystem::exists(props.INDEX_FULL_PATH)) {
+        std::cerr << "no tree found at " << props.INDEX_FULL_PATH << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // the metadata holds the directory the tree was created in, which is where its files are opened
+    try {
+        BPlusTree btree(props, key_of<&Record::id>{});
+        TreeAnalyzer analyzer(&btree);
+        TreeReport report = analyzer.analyze();
+
+        std::cout << report;
+        return report.consistent() ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception &error) {
+        std::cerr << "cannot analyze " << props.INDEX_FULL_PATH << ": " << error.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -35,6 +35,42 @@ struct CreateFileError : public virtual std::runtime_error {
     CreateFileError(): std::runtime_error("Error creating file") {}
 };
 
+struct NotEmptyIndex : public virtual std::runtime_error {
+    NotEmptyIndex(): std::runtime_error("The index is not empty") {}
+};
+
+struct UnsortedInput : public virtual std::runtime_error {
+    UnsortedInput(): std::runtime_error("The input is not sorted by the search field") {}
+};
+
+struct OpenFileError : public virtual std::runtime_error {
+    OpenFileError(): std::runtime_error("Error opening file") {}
+};
+
+struct BufferPoolExhausted : public virtual std::runtime_error {
+    BufferPoolExhausted(): std::runtime_error("Every frame of the buffer pool is pinned") {}
+};
+
+struct FrameInUse : public virtual std::runtime_error {
+    FrameInUse(): std::runtime_error("The page is pinned with a different size") {}
+};
+
+struct BufferPoolTooSmall : public virtual std::runtime_error {
+    BufferPoolTooSmall(): std::runtime_error("The buffer pool cannot hold the pages of a logged operation") {}
+};
+
+struct EntryTooLarge : public virtual std::runtime_error {
+    EntryTooLarge(): std::runtime_error("The entry does not fit in a page") {}
+};
+
+struct IOError : public virtual std::runtime_error {
+    IOError(): std::runtime_error("Error reading or writing the index file") {}
+};
+
+struct UncountedTree : public virtual std::runtime_error {
+    UncountedTree(): std::runtime_error("The tree does not keep subtree counts") {}
+};
+
 
 
 #endif //B_PLUS_TREE_ERROR_HANDLER_HPP